@@ -0,0 +1,190 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <Utils.hpp>
+#include <Continent.hpp>
+#include <Propagator.hpp>
+#include <InteractionSink.hpp>
+
+namespace anita {
+
+    ///
+    /// \brief A sink that accumulates the acceptance against energy, flavor, current and depth.
+    ///
+    /// Rather than keeping every interaction, each interaction adds its weight to a histogram with
+    /// bins in the energy of the source neutrino, the flavor, the current, and the depth (km) of the
+    /// interaction below the surface of the ice, up to a maximum depth. Interactions deeper than the
+    /// maximum depth are not counted, and interactions above the surface (in the atmosphere) are
+    /// counted in the first depth bin. Every worker fills its own histogram, and the histograms are
+    /// only summed in finish(), so memory does not grow with the number of events.
+    ///
+    /// Each of the N source neutrinos consumed (with or without interactions) represents 1/N of
+    /// Propagator::getGenerationAcceptance, and the
+    /// generation weight of its energy (Propagator::getGenerationWeight) turns the sum of the
+    /// weights in an energy bin into the acceptance (km^2 sr) averaged over log10 E across that bin.
+    /// Multiplying by the interaction length in ice gives the effective volume times solid angle
+    /// (km^3 sr). When every neutrino has a fixed energy there is only a single energy bin.
+    ///
+    class Acceptance : public InteractionSink {
+
+    public:
+
+        ///
+        /// \brief Accumulate the acceptance of the neutrinos from `propagator`.
+        ///
+        /// The energy cuts of the propagator are split into `nenergy` bins, and depths up to `maxdepth` (km)
+        /// are split into `ndepth` bins.
+        ///
+        Acceptance(const Propagator& propagator, const Continent& continent,
+                   const std::size_t nenergy, const double maxdepth, const std::size_t ndepth);
+
+        ///
+        /// \brief Create a histogram for each worker.
+        ///
+        void begin(const unsigned int nworkers) override;
+
+        ///
+        /// \brief Add the weight of every interaction of `event`.
+        ///
+        void consume(const unsigned int worker, const int event, InteractionList& interactions) override;
+
+        ///
+        /// \brief Add the histograms of every worker to the total.
+        ///
+        /// A run can be continued by calling begin() again, and the next finish() adds to the same total.
+        ///
+        void finish() override;
+
+        ///
+        /// \brief Every worker has its own histogram, so events can be accumulated concurrently.
+        ///
+        bool isConcurrent() const override { return true; };
+
+        ///
+        /// \brief Get the number of energy bins.
+        ///
+        std::size_t getNumEnergyBins() const { return this->nenergy; };
+
+        ///
+        /// \brief Get the number of depth bins.
+        ///
+        std::size_t getNumDepthBins() const { return this->ndepth; };
+
+        ///
+        /// \brief Get the energy (log10 eV) at the center of an energy bin.
+        ///
+        double getEnergy(const std::size_t bin) const;
+
+        ///
+        /// \brief Get the depth (km) at the center of a depth bin.
+        ///
+        double getDepth(const std::size_t bin) const;
+
+        ///
+        /// \brief Get the acceptance (km^2 sr) of interactions in a single bin.
+        ///
+        double getAcceptance(const std::size_t energy, const Flavor flavor, const Current current, const std::size_t depth) const;
+
+        ///
+        /// \brief Get the statistical error on getAcceptance (km^2 sr).
+        ///
+        /// Every event is an independent sample, so an event with several interactions
+        /// in the same bin contributes the square of their summed weight.
+        ///
+        double getError(const std::size_t energy, const Flavor flavor, const Current current, const std::size_t depth) const;
+
+        ///
+        /// \brief Get the acceptance (km^2 sr) of interactions at every depth of a flavor and current in an energy bin.
+        ///
+        double getAcceptance(const std::size_t energy, const Flavor flavor, const Current current) const;
+
+        ///
+        /// \brief Get the acceptance (km^2 sr) of every interaction in an energy bin.
+        ///
+        double getAcceptance(const std::size_t energy) const;
+
+        ///
+        /// \brief Get the statistical error on the acceptance (km^2 sr) of every interaction in an energy bin.
+        ///
+        double getError(const std::size_t energy) const;
+
+        ///
+        /// \brief Get the effective volume times solid angle (km^3 sr) of a flavor and current in an energy bin.
+        ///
+        double getVolume(const std::size_t energy, const Flavor flavor, const Current current) const;
+
+        ///
+        /// \brief Get whether the relative error on the acceptance of every energy bin is at most `precision`.
+        ///
+        /// Energy bins without any interactions have not converged. The error is that of getError(energy),
+        /// which counts every event once however many interactions it has.
+        ///
+        bool isConverged(const double precision) const;
+
+        ///
+        /// \brief Get the number of neutrinos that have been accumulated.
+        ///
+        long getNumEvents() const { return this->total.nevents; };
+
+    private:
+
+        // the continent that depths are measured from
+        const Continent& continent;
+
+        // the generation acceptance, and the width of the energy bins that it is spread over
+        const double generation;
+        double width;
+
+        // the energy bins
+        const double min_energy;
+        const double max_energy;
+        const std::size_t nenergy;
+
+        // the depth bins
+        const double max_depth;
+        const std::size_t ndepth;
+
+        ///
+        /// \brief The number of events, and the sums of the weights, and of their squares, in every bin.
+        ///
+        /// The interactions of an event are not independent, so the squares are of the sum of the
+        /// weights of each event in a bin, and `energies` holds the squares of the sum of the weights
+        /// of each event in every energy bin. `event` is the sum of each bin touched by the current event.
+        ///
+        struct Histogram {
+            long nevents;
+            std::vector<double> weights;
+            std::vector<double> squares;
+            std::vector<double> energies;
+            std::vector<std::pair<std::size_t, double>> event;
+        };
+
+        ///
+        /// \brief A Histogram padded to a whole number of cache lines.
+        ///
+        /// begin() places these on cache-line aligned storage (utils::makeAligned) so
+        /// that workers counting their own events do not contend with each other.
+        ///
+        struct WorkerHistogram : Histogram {
+            char padding[utils::CACHE_LINE - sizeof(Histogram) % utils::CACHE_LINE];
+        };
+
+        // one histogram per worker, and the sum over all the workers
+        unsigned int nworkers;
+        utils::AlignedArray<WorkerHistogram> histograms;
+        Histogram total;
+
+        ///
+        /// \brief Get the index of a bin in a histogram.
+        ///
+        std::size_t getBin(const std::size_t energy, const Flavor flavor, const Current current, const std::size_t depth) const;
+
+        ///
+        /// \brief Get the acceptance of each neutrino accumulated so far.
+        ///
+        double getNormalization() const;
+
+    };
+
+} // END: namespace anita
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <vector>
+#include <Vector3.hpp>
+#include <readers/Earth.hpp>
+
+namespace anita {
+
+    ///
+    /// \brief The cumulative column depth (g/cm^2) along a straight chord through the Earth
+    ///
+    /// PREM is spherically layered and linear in radius between the radii in the PREM file,
+    /// so the chord is split analytically where it crosses each of those radii, and within
+    /// each piece the density a + b*r(s) integrates in closed form:
+    ///
+    /// \f$\int (a + b\sqrt{p^2 + t^2})\,dt = at + \frac{b}{2}\left(t\sqrt{p^2 + t^2} + p^2\sinh^{-1}(t/p)\right)\f$
+    ///
+    /// where p is the distance of closest approach to the center of the Earth and t is the
+    /// distance along the chord from that point. The column depth is therefore exact (for the
+    /// interpolated PREM of readers::Earth) and costs one binary search and a few transcendentals
+    /// to evaluate anywhere, and getDistance() inverts it with a couple of Newton steps, so an
+    /// interaction point can be sampled from a single random column depth rather than by stepping.
+    ///
+    /// Any range of the chord can be overwritten with a constant density (e.g. the ice, ocean and
+    /// air above the rock of Antarctica, see Continent::getColumnDepth). Beyond the outermost
+    /// radius of PREM the density is zero.
+    ///
+    /// Distances are in km from the start of the chord, density in g/cm^3.
+    ///
+    class ColumnDepth {
+
+    public:
+
+        ///
+        /// \brief Integrate PREM along the chord origin + s*direction for s in [0, length]
+        ///
+        /// `origin` is in km from the center of the Earth and `direction` must be a unit vector.
+        ///
+        ColumnDepth(const readers::Earth& earth, const Vector3<double>& origin,
+                    const Vector3<double>& direction, const double length);
+
+        ///
+        /// \brief Replace the density between `start` and `end` (km along the chord) with `density`
+        ///
+        void setDensity(const double start, const double end, const double density);
+
+        ///
+        /// \brief Get the density (g/cm^3) at a distance s (km) along the chord
+        ///
+        double getDensity(const double s) const;
+
+        ///
+        /// \brief Get the column depth (g/cm^2) between the start of the chord and s (km)
+        ///
+        double getColumnDepth(const double s) const;
+
+        ///
+        /// \brief Get the distance (km) along the chord at which the column depth reaches `depth` (g/cm^2)
+        ///
+        /// This is the inverse of getColumnDepth (the first such distance, if the chord passes
+        /// through a vacuum). It returns infinity if `depth` is more than getTotal().
+        ///
+        double getDistance(const double depth) const;
+
+        ///
+        /// \brief Get the column depth (g/cm^2) of the whole chord
+        ///
+        double getTotal() const { return this->total; };
+
+        ///
+        /// \brief Get the length of the chord (km)
+        ///
+        double getLength() const { return this->length; };
+
+        ///
+        /// \brief Get the number of pieces that the chord is split into
+        ///
+        std::size_t getNumPieces() const { return this->pieces.size(); };
+
+    private:
+
+        ///
+        /// \brief A range of the chord over which the density is a + b*r(s)
+        ///
+        struct Piece {
+            double start; ///< the distance along the chord (km) at which this piece starts
+            double depth; ///< the column depth (g/cm^2) at the start of this piece
+            double a; ///< the density (g/cm^3) at the center of the Earth
+            double b; ///< the gradient of the density (g/cm^3/km) with radius
+        };
+
+        // the length of the chord
+        const double length;
+
+        // the distance along the chord of its closest approach to the center of the
+        // Earth (which may be before the start, or after the end, of the chord)
+        double closest;
+
+        // the square of the distance of the closest approach
+        double impact2;
+
+        // the pieces of the chord in order, each ending where the next starts
+        std::vector<Piece> pieces;
+
+        // the column depth of the whole chord
+        double total;
+
+        ///
+        /// \brief Get the distance (km) from the center of the Earth at s
+        ///
+        double getRadius(const double s) const;
+
+        ///
+        /// \brief The antiderivative (g/cm^3 km) of the density of `piece` at s
+        ///
+        double integrate(const Piece& piece, const double s) const;
+
+        ///
+        /// \brief Get the index of the piece containing s
+        ///
+        std::size_t findPiece(const double s) const;
+
+        ///
+        /// \brief Recompute the column depth at the start of every piece
+        ///
+        void accumulate();
+
+    };
+
+} // END: namespace anita
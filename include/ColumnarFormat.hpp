@@ -0,0 +1,166 @@
+#pragma once
+
+#include <array>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+namespace anita {
+
+    ///
+    /// \brief The layout of the NuMC columnar interaction format
+    ///
+    /// A file is a fixed 64-byte FileHeader, followed by row groups, followed by a footer:
+    ///
+    ///     FileHeader
+    ///     row group 0: a chunk for every column, each starting on an 8-byte boundary
+    ///     row group 1: ...
+    ///     FooterHeader
+    ///     ColumnInfo  x ncolumns
+    ///     RowGroupInfo x ngroups
+    ///     ChunkInfo x (ngroups * ncolumns), by row group and then by column
+    ///     FooterTrailer (the offset of the FooterHeader and the magic again)
+    ///
+    /// A chunk is the values of one column for the rows of one row group. Unencoded chunks are the
+    /// raw little-endian values, so a reader that maps the file can use them in place. Integer
+    /// chunks can be delta encoded (the first value, then the difference of each value from the
+    /// one before), and any chunk can be deflated with zlib, which is only kept if it is smaller.
+    ///
+    /// Every row is one interaction, and the row groups record how many events (including events
+    /// without any interactions) each contains.
+    ///
+    namespace columnar {
+
+        constexpr char MAGIC[8] = "NUMCCOL";
+        constexpr std::uint32_t VERSION = 1;
+
+        ///
+        /// \brief The type of the values of a column
+        ///
+        enum class Type : std::uint32_t { Int32, UInt8, Float64 };
+
+        ///
+        /// \brief How a chunk is stored - a combination of these flags
+        ///
+        enum Encoding : std::uint32_t { Plain = 0, Delta = 1, Deflate = 2 };
+
+        ///
+        /// \brief The header at the start of every file
+        ///
+        struct FileHeader {
+            char magic[8];              ///< Always MAGIC
+            std::uint32_t version;      ///< The VERSION of the layout
+            std::uint32_t ncolumns;     ///< The number of columns
+            char commit[16];            ///< The GIT_COMMIT of the code that wrote this file
+            char hash[32];              ///< The SOURCE_HASH of the code that wrote this file
+        };
+        static_assert(sizeof(FileHeader) == 64, "Columnar file header must be 64 bytes.");
+
+        ///
+        /// \brief The start of the footer
+        ///
+        struct FooterHeader {
+            std::uint64_t nrows;        ///< The total number of rows (interactions)
+            std::uint64_t nevents;      ///< The total number of events
+            std::uint32_t ngroups;      ///< The number of row groups
+            std::uint32_t ncolumns;     ///< The number of columns
+        };
+        static_assert(sizeof(FooterHeader) == 24, "Columnar footer header must be 24 bytes.");
+
+        ///
+        /// \brief The name and type of a column
+        ///
+        struct ColumnInfo {
+            char name[24];              ///< The name of the column, padded with zeros
+            Type type;                  ///< The type of every value
+            std::uint32_t width;        ///< The size of every value in bytes
+        };
+        static_assert(sizeof(ColumnInfo) == 32, "Columnar column info must be 32 bytes.");
+
+        ///
+        /// \brief The size of a row group
+        ///
+        struct RowGroupInfo {
+            std::uint64_t nrows;        ///< The number of rows in this group
+            std::uint64_t nevents;      ///< The number of events in this group
+        };
+        static_assert(sizeof(RowGroupInfo) == 16, "Columnar row group info must be 16 bytes.");
+
+        ///
+        /// \brief Where a chunk is and how it is stored
+        ///
+        struct ChunkInfo {
+            std::uint64_t offset;       ///< The offset of the chunk from the start of the file
+            std::uint64_t size;         ///< The number of bytes stored
+            std::uint32_t encoding;     ///< The Encoding flags of the chunk
+            std::uint32_t padding;
+        };
+        static_assert(sizeof(ChunkInfo) == 24, "Columnar chunk info must be 24 bytes.");
+
+        ///
+        /// \brief The end of every file
+        ///
+        struct FooterTrailer {
+            std::uint64_t offset;       ///< The offset of the FooterHeader from the start of the file
+            char magic[8];              ///< Always MAGIC
+        };
+        static_assert(sizeof(FooterTrailer) == 16, "Columnar footer trailer must be 16 bytes.");
+
+        ///
+        /// \brief The number of columns written by writers::ColumnarWriter
+        ///
+        constexpr std::size_t NCOLUMNS = 14;
+
+        ///
+        /// \brief The name and type of every column written by writers::ColumnarWriter, in order
+        ///
+        constexpr std::array<std::pair<const char*, Type>, NCOLUMNS> COLUMNS = {{
+                { "event", Type::Int32 },
+                { "trials", Type::Int32 },
+                { "flavor", Type::UInt8 },
+                { "neutrino", Type::UInt8 },
+                { "energy", Type::Float64 },
+                { "theta", Type::Float64 },
+                { "phi", Type::Float64 },
+                { "r", Type::Float64 },
+                { "direction_theta", Type::Float64 },
+                { "direction_phi", Type::Float64 },
+                { "direction_r", Type::Float64 },
+                { "current", Type::UInt8 },
+                { "distance", Type::Float64 },
+                { "weight", Type::Float64 } }};
+
+        ///
+        /// \brief Get the size in bytes of a value of `type`
+        ///
+        inline std::uint32_t getWidth(const Type type) {
+            return type == Type::Float64 ? 8 : (type == Type::Int32 ? 4 : 1);
+        }
+
+        ///
+        /// \brief Get the Type of the C++ type T
+        ///
+        template <typename T> struct TypeOf;
+        template <> struct TypeOf<std::int32_t> { static constexpr Type value = Type::Int32; };
+        template <> struct TypeOf<std::uint8_t> { static constexpr Type value = Type::UInt8; };
+        template <> struct TypeOf<double> { static constexpr Type value = Type::Float64; };
+
+        ///
+        /// \brief A read-only view of the values of a column
+        ///
+        template <typename T>
+        struct Span {
+
+            const T* data; ///< The first value
+            std::size_t length; ///< The number of values
+
+            std::size_t size() const { return this->length; };
+            const T* begin() const { return this->data; };
+            const T* end() const { return this->data + this->length; };
+            const T& operator[](const std::size_t i) const { return this->data[i]; };
+
+        };
+
+    } // END: namespace columnar
+
+} // END: namespace anita
@@ -7,6 +7,7 @@ namespace anita {
     // mathematical and physics constants
     constexpr double PI = M_PI;
     constexpr double N_A = 6.0221415e23; // mol^-1
+    constexpr double CM_PER_KM = 1e5; // g/cm^3 times km in g/cm^2
 
     // some simple utilities
     constexpr double degToRad(double deg) { return (deg/180.)*PI; }
@@ -4,6 +4,7 @@
 #include <NuMC.hpp>
 #include <Random.hpp>
 #include <Vector3.hpp>
+#include <ColumnDepth.hpp>
 #include <readers/Earth.hpp>
 #include <readers/Bedmap.hpp>
 
@@ -14,6 +15,11 @@ namespace anita {
     ///
     enum class Material { Rock, Ice, Firn, Air, Ocean, FreshWater };
 
+    ///
+    /// \brief Get the nominal density (g/cm^3) of a material
+    ///
+    double getMaterialDensity(const Material material);
+
     ///
     /// \brief A class representing a spherical coordinate
     ///
@@ -32,8 +38,6 @@ namespace anita {
         /// \brief Construct a new SphericalCoordinate with the specified values
         ///
         SphericalCoordinate(const double t, const double p, const double R) : theta(t), phi(p), r(R) {};
-
-        ~SphericalCoordinate() {};
     };
 
     ///
@@ -61,6 +65,14 @@ namespace anita {
         ///
         double getSurfaceElevation(const double theta, const double phi) const;
 
+        ///
+        /// \brief Get the distance (in km) from the center of the Earth to the surface at a theta/phi (radians)
+        ///
+        /// This is the radius of the WGS84 ellipsoid plus the BEDMAP2 surface elevation where there is
+        /// ice or rock, and the ellipsoid itself over the ocean.
+        ///
+        double getSurfaceRadius(const double theta, const double phi) const;
+
         ///
         /// \brief Get the thickness of the ice (in km) at a given theta/phi (radians)
         ///
@@ -103,10 +115,56 @@ namespace anita {
             return Vector3<double>(0, 0, 0); };
 
         ///
-        /// \brief Get a random point on the surface of the Earth below -60d latitude
+        /// \brief Get a random point on the ice of Antarctica, uniform in surface area
+        ///
+        /// Points are drawn from an alias table over the ice cells of BEDMAP2 (see SurfaceSampler),
+        /// so no samples fall on the ocean. Anything normalized to the area of the cap below -60d
+        /// latitude must be multiplied by getSurfaceAcceptance().
         ///
         SphericalCoordinate getRandomSurfacePoint() const;
 
+        ///
+        /// \brief Get the fraction of the cap below -60d latitude that getRandomSurfacePoint samples from
+        ///
+        double getSurfaceAcceptance() const;
+
+        ///
+        /// \brief Get the area (km^2) of the ice that getRandomSurfacePoint samples from
+        ///
+        double getIceArea() const;
+
+        ///
+        /// \brief Find the first distance (km) in (0, maxdistance] at which a ray crosses the surface
+        ///
+        /// The ray starts at `origin` (km from the center of the Earth) along the unit vector `direction`.
+        /// The surface is the top of the ice, or sea level where there is no ice. This uses an
+        /// ElevationPyramid so it costs a handful of BEDMAP2 lookups rather than marching along the ray.
+        /// Returns false if the ray does not cross the surface within `maxdistance`.
+        ///
+        bool getSurfaceIntersection(const Vector3<double>& origin, const Vector3<double>& direction,
+                                    const double maxdistance, double& distance) const;
+
+        ///
+        /// \brief Find the first distance (km) in (0, maxdistance] at which a ray crosses the rock bed
+        ///
+        /// See getSurfaceIntersection.
+        ///
+        bool getBedIntersection(const Vector3<double>& origin, const Vector3<double>& direction,
+                                const double maxdistance, double& distance) const;
+
+        ///
+        /// \brief Get the cumulative column depth along the chord origin + s*direction for s in [0, length]
+        ///
+        /// The chord is integrated analytically through PREM (see ColumnDepth), and then every range
+        /// between consecutive crossings of the surface and the bed (found with the ElevationPyramid)
+        /// is overwritten with its material: nothing above the surface, ice (or ocean where BEDMAP2
+        /// has no ice) between the surface and the bed, and PREM below the bed. Below the bed but
+        /// outside the outermost radius of PREM (where the ellipsoid bulges past 6371 km), the
+        /// outermost density of PREM is used. Cavities under the ice shelves are counted as ice.
+        ///
+        ColumnDepth getColumnDepth(const Vector3<double>& origin, const Vector3<double>& direction,
+                                   const double length) const;
+
         ///
         /// \brief Get a random unit vector direction in spherical coordinates
         ///
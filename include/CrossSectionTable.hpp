@@ -0,0 +1,115 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <Particle.hpp>
+#include <Continent.hpp>
+#include <CrossSections.hpp>
+
+namespace anita {
+
+    ///
+    /// \brief A table of the CC and NC cross sections of one model, uniform in log10(eV)
+    ///
+    /// The parametrizations in CrossSections.cpp cost several pow() calls (behind a switch
+    /// on the model) every time they are evaluated. This tabulates both currents, and the
+    /// combined interaction depth 1/(N_A (sigma_CC + sigma_NC)), at evenly spaced log10(eV)
+    /// energies so that every lookup is a linear interpolation with no transcendentals.
+    ///
+    /// Every table is checked against the parametrizations at the midpoint of each interval
+    /// when it is built (where the interpolation is worst), and a table that does not match
+    /// to within TOLERANCE is rejected. Energies outside the table use the parametrizations.
+    ///
+    class CrossSectionTable {
+
+    public:
+
+        ///
+        /// \brief The largest relative error of a table against the parametrizations
+        ///
+        static constexpr double TOLERANCE = 1e-4;
+
+        ///
+        /// \brief Tabulate `model` at `npoints` energies between minE and maxE (log10(eV))
+        ///
+        CrossSectionTable(const CrossSectionModel model, const double minE = 6., const double maxE = 24.,
+                          const std::size_t npoints = 3601);
+
+        ///
+        /// \brief Get the shared table of `model`, which is built on first use
+        ///
+        static const CrossSectionTable& getTable(const CrossSectionModel model);
+
+        ///
+        /// \brief Get the cross section (cm^2) for `current` at an energy E in log10(eV)
+        ///
+        double getCrossSection(const Current current, const double E) const;
+
+        ///
+        /// \brief Get the cross sections (cm^2) for `current` at `n` energies in log10(eV)
+        ///
+        void getCrossSections(const Current current, const double* energies, double* xsections,
+                              const std::size_t n) const;
+
+        ///
+        /// \brief Get the mean column depth (g/cm^2) before a CC or NC interaction at an energy E in log10(eV)
+        ///
+        double getInteractionDepth(const double E) const;
+
+        ///
+        /// \brief Get the mean distance (km) before a CC or NC interaction in `material` at an energy E in log10(eV)
+        ///
+        double getInteractionLength(const double E, const Material material) const;
+
+        ///
+        /// \brief Get the mean distance (km) before a CC or NC interaction in `material` at `n` energies in log10(eV)
+        ///
+        void getInteractionLengths(const Material material, const double* energies, double* lengths,
+                                   const std::size_t n) const;
+
+        ///
+        /// \brief Get the largest relative error of this table against the parametrizations
+        ///
+        double getMaxError() const { return this->max_error; };
+
+        ///
+        /// \brief Get the model that this table is for
+        ///
+        CrossSectionModel getModel() const { return this->model; };
+
+    private:
+
+        // the model that is tabulated
+        const CrossSectionModel model;
+
+        // the energy range of the table, and the inverse of its spacing
+        const double min_energy;
+        const double max_energy;
+        const double inverse_step;
+
+        // the CC and NC cross sections, and the interaction depth, at every energy
+        std::vector<double> charged;
+        std::vector<double> neutral;
+        std::vector<double> depth;
+
+        // the largest relative error found when checking the table
+        double max_error;
+
+        ///
+        /// \brief Get the analytic interaction depth (g/cm^2) at an energy E in log10(eV)
+        ///
+        double getExactDepth(const double E) const;
+
+        ///
+        /// \brief Interpolate `values` at an energy E in log10(eV), which must be within the table
+        ///
+        inline double interpolate(const std::vector<double>& values, const double E) const;
+
+        ///
+        /// \brief Get whether an energy E in log10(eV) is within the table
+        ///
+        bool contains(const double E) const { return (E >= this->min_energy) && (E <= this->max_energy); };
+
+    };
+
+} // END: namespace anita
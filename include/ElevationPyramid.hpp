@@ -0,0 +1,168 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <Vector3.hpp>
+#include <readers/Bedmap.hpp>
+
+namespace anita {
+
+    ///
+    /// \brief The two surfaces that a ray can be intersected with
+    ///
+    /// `Surface` is the top of the ice, or sea level (the geoid) where there is no ice.
+    /// `Bed` is the top of the rock. Elevations are relative to the WGS84 ellipsoid; outside
+    /// of the Bedmap2 grid both horizons are the ellipsoid itself.
+    ///
+    enum class Horizon { Surface = 0, Bed = 1 };
+
+    ///
+    /// \brief A min/max elevation pyramid over the Bedmap2 surface and bed for ray intersection
+    ///
+    /// Level 0 stores the minimum and maximum elevation (in whole meters, rounded outwards) that
+    /// bilinear interpolation can produce anywhere within each 2x2 block of Bedmap2 cells, and
+    /// each level above halves the resolution until a single node covers the whole grid.
+    ///
+    /// intersect() walks a ray through the pyramid: wherever the height of the ray above the
+    /// ellipsoid is provably above (or below) every elevation within a node over some distance,
+    /// that whole distance is skipped at once, and the traversal only descends to the full
+    /// resolution of the grid close to the horizon, where the crossing is found by root finding.
+    /// Parts of the ray that are well above or below all of the topography, or outside of the
+    /// Bedmap2 grid, are handled analytically.
+    ///
+    /// The pyramid takes a few seconds and ~120 MB to build for both horizons.
+    ///
+    class ElevationPyramid {
+
+    public:
+
+        ///
+        /// \brief Build the pyramid for both horizons of `bedmap`
+        ///
+        ElevationPyramid(const readers::Bedmap& bedmap);
+
+        ///
+        /// \brief Find the first crossing of `horizon` by the ray origin + s*direction for s in (smin, smax]
+        ///
+        /// `origin` is in km from the center of the Earth and `direction` must be a unit vector,
+        /// so `s` is the distance (km) along the ray. Returns false if the ray does not cross the
+        /// horizon in this range. Crossings are found to within ~1 mm; pairs of crossings within
+        /// a few hundred meters of each other (i.e. a ray grazing a single bump) may be missed.
+        /// A crossing is never returned at smin itself, so every crossing along a ray can be found
+        /// by starting each search from the crossing before it.
+        ///
+        bool intersect(const Horizon horizon, const Vector3<double>& origin, const Vector3<double>& direction,
+                       const double smin, const double smax, double& s) const;
+
+        ///
+        /// \brief Get the elevation (m) of `horizon` at (x, y) (km) in Bedmap coordinates
+        ///
+        /// This is the surface that intersect() finds crossings of. It is NaN outside of the grid.
+        ///
+        double getElevationAtPoint(const Horizon horizon, const double x, const double y) const;
+
+        ///
+        /// \brief Get the height (km) of `point` (km from the center of the Earth) above `horizon`
+        ///
+        /// This is negative below the horizon, and changes sign at every crossing found by intersect().
+        ///
+        double getHeight(const Horizon horizon, const Vector3<double>& point) const;
+
+        ///
+        /// \brief Get the (min, max) elevation (m) of `horizon` within node (col, row) of `level`
+        ///
+        std::pair<double, double> getBounds(const Horizon horizon, const int level, const int col, const int row) const;
+
+        ///
+        /// \brief Get the number of levels in the pyramid
+        ///
+        int getNumLevels() const { return static_cast<int>(this->sizes.size()); };
+
+        ///
+        /// \brief Get the number of nodes along each side of `level`
+        ///
+        int getLevelSize(const int level) const { return this->sizes[static_cast<std::size_t>(level)]; };
+
+    private:
+
+        ///
+        /// \brief The (min, max) elevation of a node, in meters
+        ///
+        struct Bounds {
+            std::int16_t min;
+            std::int16_t max;
+        };
+
+        ///
+        /// \brief The state of the ray at the current step
+        ///
+        struct Ray;
+
+        // a copy of the Bedmap (which shares its rasters) to evaluate the horizons
+        const readers::Bedmap bedmap;
+
+        // the number of columns and rows of the grid
+        const int ncols;
+        const int nrows;
+
+        // half of the width (km) of the grid, which is centered on the pole
+        const double halfwidth;
+
+        // the number of nodes along each side of every level
+        std::vector<int> sizes;
+
+        // the bounds of every node of every level, for each horizon
+        std::vector<std::vector<Bounds>> levels[2];
+
+        // the radius of the cap around the south pole (km on the map) that contains the grid
+        // with some room to spare, and the polar angle (from the south pole) of its edge
+        double cap_radius;
+        double cap_angle;
+
+        // an upper bound on the speed (km on the map per km along the ray) of any
+        // ray within the shell of topography and the cap
+        double map_speed;
+
+        ///
+        /// \brief Compute level 0 of the pyramid from the rasters of the Bedmap
+        ///
+        void buildBaseLevel();
+
+        ///
+        /// \brief Compute each level above level 0 from the level below
+        ///
+        void buildLevels();
+
+        ///
+        /// \brief Get the bounds of the node containing the cell (col, row) at `level`
+        ///
+        inline const Bounds& getNode(const Horizon horizon, const int level, const int col, const int row) const;
+
+        ///
+        /// \brief Get the radii (km) of the spherical shell that contains `horizon` everywhere
+        ///
+        std::pair<double, double> getShell(const Horizon horizon) const;
+
+        ///
+        /// \brief Find the first crossing within [sa, sb] of a ray that stays within the shell of topography
+        ///
+        bool traverse(const Horizon horizon, const Ray& ray, const double sa, const double sb, double& s) const;
+
+        ///
+        /// \brief Get the height (km) of the ray above `horizon` at s; this changes sign at every crossing
+        ///
+        double getClearance(const Horizon horizon, const Ray& ray, const double s) const;
+
+        ///
+        /// \brief Find the root of getClearance between a and b, which must have opposite signs
+        ///
+        /// This returns a point within 1 mm beyond the root (where the clearance has the sign
+        /// of gb), or the root itself if the clearance there is exactly zero, so that a search that
+        /// starts from the returned point does not find the same crossing again.
+        ///
+        double findCrossing(const Horizon horizon, const Ray& ray, double a, double ga, double b, double gb) const;
+
+    };
+
+} // END: namespace anita
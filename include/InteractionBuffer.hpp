@@ -0,0 +1,109 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <Propagator.hpp>
+
+namespace anita {
+
+    ///
+    /// \brief The interactions of many events stored as flat columns
+    ///
+    /// Every field of Interaction is stored in its own contiguous column (structure of arrays), and
+    /// the interactions of each event are a contiguous range of rows given by per-event offsets (as in
+    /// compressed sparse row storage): the interactions of the i'th event appended are the rows
+    /// [offsets[i], offsets[i + 1]). Events without any interactions are kept as empty ranges so the
+    /// number of events that were propagated is always known.
+    ///
+    /// A million events is therefore a handful of large allocations that can be handed directly to a
+    /// writer, rather than a million separate InteractionLists.
+    ///
+    class InteractionBuffer {
+
+    public:
+
+        ///
+        /// \brief The columns of the buffer
+        ///
+        struct Columns {
+
+            std::vector<int> events; ///< The event index of each event.
+            std::vector<std::size_t> offsets; ///< The first row of each event, and one past the last row.
+
+            std::vector<int> trials; ///< The number of trials of each interaction.
+            std::vector<std::uint8_t> flavor; ///< The Flavor of the particle at each interaction.
+            std::vector<std::uint8_t> neutrino; ///< Whether the particle was a neutrino at each interaction.
+            std::vector<double> energy; ///< The energy (log10 eV) of the particle at each interaction.
+            std::vector<double> theta; ///< The location of each interaction.
+            std::vector<double> phi;
+            std::vector<double> r;
+            std::vector<double> direction_theta; ///< The direction of the particle at each interaction.
+            std::vector<double> direction_phi;
+            std::vector<double> direction_r;
+            std::vector<std::uint8_t> current; ///< The Current of each interaction.
+            std::vector<double> distance; ///< The distance travelled at each interaction.
+            std::vector<double> weight; ///< The generation weight of each interaction.
+
+        };
+
+        ///
+        /// \brief Create an empty buffer
+        ///
+        InteractionBuffer() { this->columns.offsets.push_back(0); };
+
+        ///
+        /// \brief Add the interactions of `event` to the end of the buffer
+        ///
+        void append(const int event, const InteractionList& interactions);
+
+        ///
+        /// \brief Reserve space for `nevents` events with a total of `ninteractions` interactions
+        ///
+        void reserve(const std::size_t nevents, const std::size_t ninteractions);
+
+        ///
+        /// \brief Remove every event from the buffer, keeping its memory
+        ///
+        void clear();
+
+        ///
+        /// \brief Get the number of events in the buffer
+        ///
+        std::size_t getNumEvents() const { return this->columns.events.size(); };
+
+        ///
+        /// \brief Get the total number of interactions in the buffer
+        ///
+        std::size_t getNumInteractions() const { return this->columns.energy.size(); };
+
+        ///
+        /// \brief Get the number of interactions of the i'th event in the buffer
+        ///
+        std::size_t getNumInteractions(const std::size_t i) const {
+            return this->columns.offsets.at(i + 1) - this->columns.offsets.at(i);
+        };
+
+        ///
+        /// \brief Gather the interaction in `row` back into an Interaction
+        ///
+        Interaction getInteraction(const std::size_t row) const;
+
+        ///
+        /// \brief Gather the interactions of the i'th event in the buffer back into an InteractionList
+        ///
+        InteractionList getEvent(const std::size_t i) const;
+
+        ///
+        /// \brief Get the columns of the buffer
+        ///
+        const Columns& getColumns() const { return this->columns; };
+
+    private:
+
+        // the columns of every event and interaction
+        Columns columns;
+
+    };
+
+} // END: namespace anita
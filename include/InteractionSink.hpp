@@ -0,0 +1,137 @@
+#pragma once
+
+#include <map>
+#include <Propagator.hpp>
+#include <InteractionBuffer.hpp>
+
+namespace anita {
+
+    ///
+    /// \brief An abstract receiver for the interactions of each propagated neutrino.
+    ///
+    /// Propagator::propagateParticles hands the InteractionList of every neutrino to a sink as soon as
+    /// that neutrino has finished propagating, so interactions can be written, histogrammed or
+    /// discarded immediately instead of accumulating in memory for the whole run.
+    ///
+    /// Unless isConcurrent() returns true, the propagator never calls consume() from two threads at
+    /// once. Events may arrive in any order when propagating with more than one thread.
+    ///
+    class InteractionSink {
+
+    public:
+
+        ///
+        /// \brief Called once before the first event with the number of workers that will call consume().
+        ///
+        virtual void begin(const unsigned int nworkers) {};
+
+        ///
+        /// \brief Receive the interactions of `event`, which was propagated by `worker`.
+        ///
+        /// The sink may take ownership of `interactions`; the propagator does not use it afterwards.
+        ///
+        virtual void consume(const unsigned int worker, const int event, InteractionList& interactions) = 0;
+
+        ///
+        /// \brief Called once after the last event has been consumed.
+        ///
+        virtual void finish() {};
+
+        ///
+        /// \brief Whether consume() can be called from several workers at once.
+        ///
+        /// Sinks that keep separate state per worker can return true to avoid the propagator's lock.
+        ///
+        virtual bool isConcurrent() const { return false; };
+
+        // virtual destructor since this class is abstract
+        virtual ~InteractionSink() {};
+
+    };
+
+
+    ///
+    /// \brief A sink that stores the interactions of every event in a map keyed by event index.
+    ///
+    /// This reproduces the behaviour of the map-returning Propagator::propagateParticles, and
+    /// therefore holds every event in memory until the end of the run.
+    ///
+    class MapSink : public InteractionSink {
+
+    public:
+
+        ///
+        /// \brief Store the interactions of `event`.
+        ///
+        void consume(const unsigned int worker, const int event, InteractionList& interactions) override {
+            this->events.emplace(event, std::move(interactions));
+        };
+
+        ///
+        /// \brief Move the map of all the events received so far out of the sink.
+        ///
+        std::map<int, InteractionList> release() { return std::move(this->events); };
+
+    private:
+
+        // the interactions of every event so far
+        std::map<int, InteractionList> events;
+
+    };
+
+
+    ///
+    /// \brief A sink that stores the interactions of every event in the columns of an InteractionBuffer.
+    ///
+    /// This holds every event in memory like MapSink, but in a few contiguous columns rather than
+    /// a map of separately allocated InteractionLists.
+    ///
+    class BufferSink : public InteractionSink {
+
+    public:
+
+        ///
+        /// \brief Append the interactions of `event` to the buffer.
+        ///
+        void consume(const unsigned int worker, const int event, InteractionList& interactions) override {
+            this->buffer.append(event, interactions);
+        };
+
+        ///
+        /// \brief Get the buffer of all the events received so far.
+        ///
+        const InteractionBuffer& getBuffer() const { return this->buffer; };
+
+        ///
+        /// \brief Move the buffer of all the events received so far out of the sink.
+        ///
+        InteractionBuffer release() { return std::move(this->buffer); };
+
+    private:
+
+        // the interactions of every event so far
+        InteractionBuffer buffer;
+
+    };
+
+
+    ///
+    /// \brief A sink that immediately discards every event.
+    ///
+    class NullSink : public InteractionSink {
+
+    public:
+
+        ///
+        /// \brief Throw away the interactions of `event`.
+        ///
+        void consume(const unsigned int worker, const int event, InteractionList& interactions) override {};
+
+        ///
+        /// \brief Discarding is stateless so can be done from every worker at once.
+        ///
+        bool isConcurrent() const override { return true; };
+
+    };
+
+} // END: namespace anita
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <ParticleArena.hpp>
 
 #include <Particle.hpp>
 
@@ -24,6 +25,11 @@ namespace anita {
         ///
         Lepton(double E, Flavor flv) : Particle(E, false), flavor(flv) {};
 
+        ///
+        /// \brief Get the flavor of the lepton
+        ///
+        Flavor getFlavor() const { return this->flavor; };
+
         ///
         /// \brief Compute the interaction length at a density in g/cm^3 and return the interaction type
         ///
@@ -32,7 +38,7 @@ namespace anita {
         ///
         /// \brief Return the primary particle from a lepton interaction
         ///
-        virtual std::unique_ptr<Particle> getInteractionProducts(const InteractionType interaction) const = 0;
+        virtual ParticlePtr<Particle> getInteractionProducts(const InteractionType interaction) const = 0;
 
     private:
 
@@ -64,7 +70,7 @@ namespace anita {
         ///
         /// \brief Return the primary particle from a lepton interaction
         ///
-        std::unique_ptr<Particle> getInteractionProducts(const InteractionType interaction) const override;
+        ParticlePtr<Particle> getInteractionProducts(const InteractionType interaction) const override;
     private:
 
     };
@@ -95,7 +101,7 @@ namespace anita {
         ///
         /// \brief Return the primary particle from a lepton interaction
         ///
-        std::unique_ptr<Particle> getInteractionProducts(const InteractionType interaction) const override;
+        ParticlePtr<Particle> getInteractionProducts(const InteractionType interaction) const override;
 
     private:
 
@@ -128,13 +134,14 @@ namespace anita {
         ///
         /// \brief Return the primary particle from a lepton interaction
         ///
-        std::unique_ptr<Particle> getInteractionProducts(const InteractionType interaction) const override;
+        ParticlePtr<Particle> getInteractionProducts(const InteractionType interaction) const override;
 
     private:
 
-        // tau decay products data table
-        static const readers::YTable decayTable() {
-            return readers::YTable(std::string(DATA_DIR)+std::string("/tau_decay_tauola.data"));
+        // tau decay products data table - loaded once per process by the TableRegistry
+        static const readers::YTable& decayTable() {
+            static const readers::YTable& table = readers::TableRegistry::getYTable("tau_decay_tauola.data");
+            return table;
         };
 
     };
@@ -1,12 +1,16 @@
 #pragma once
 
 #include <memory>
+#include <ParticleArena.hpp>
 #include <Particle.hpp>
 #include <CrossSections.hpp>
 #include <readers/Table.hpp>
 
 namespace anita {
 
+    // see ParticleState.hpp
+    struct ParticleState;
+
     ///
     /// \brief Abstract class representing a neutrino
     ///
@@ -42,18 +46,38 @@ namespace anita {
         ///
         static void setCrossSectionModel(const CrossSectionModel model) { cross_section_model = model; };
 
+        ///
+        /// \brief Get the cross section model of ALL neutrinos
+        ///
+        static CrossSectionModel getCrossSectionModel() { return cross_section_model; };
+
+        ///
+        /// \brief Get the energy loss model of ALL neutrinos
+        ///
+        static EnergyLossModel getEnergyLossModel() { return energy_loss_model; };
+
         ///
         /// \brief Generate a random neutrino flavor with a given energy in log10(eV) units
         ///
-        /// This generates a pointer to a neutrino of a random flavor.
+        /// This generates a pointer to a neutrino of a random flavor in the ParticleArena of the calling thread.
         ///
-        static std::unique_ptr<Neutrino> generateRandomNeutrino(const double E);
+        static ParticlePtr<Neutrino> generateRandomNeutrino(const double E);
 
         ///
-        /// \brief Compute the interaction length at a density in g/cm^3 and return the interaction type
+        /// \brief Compute the interaction length (km) at a density in g/cm^3 and return the interaction type
         ///
         std::pair<double, InteractionType> getInteractionLength(const double density) const override;
 
+        ///
+        /// \brief Get the mean column depth (g/cm^2) before a CC or NC interaction at the current energy
+        ///
+        double getInteractionDepth() const;
+
+        ///
+        /// \brief Pick the current of an interaction with probability proportional to its cross section
+        ///
+        Current getRandomCurrent() const;
+
         ///
         /// \brief Return the primary particle from a neutrino interaction
         ///
@@ -61,7 +85,7 @@ namespace anita {
         /// an appropriately sampled energy. For a neutral current interaction,
         /// this returns a neutrino with the appropriately sampled energy.
         ///
-        virtual std::unique_ptr<Particle> getInteractionProducts(const Current current) const = 0;
+        virtual ParticlePtr<Particle> getInteractionProducts(const Current current) const = 0;
 
         ///
         /// \brief Construct a Neutrino with a given energy (in log10(eV) units) and flavor
@@ -79,8 +103,8 @@ namespace anita {
     protected:
 
         // we load the CTEQ5 CC and NC data files for neutrino interactions
-        // these utilize C++11 "initialize by first call" so are only loaded
-        // on the first instantiation of a particle
+        // these are loaded once per process by the TableRegistry, and the reference
+        // to each is cached with C++11 "initialize by first call" so repeated calls are free
         // access tables with particle->chargedTable(); // note the exta parenthesis
 
         // the cross section to use for this particle when sampling cross section
@@ -90,15 +114,20 @@ namespace anita {
         static EnergyLossModel energy_loss_model;
 
         // Charged current final state files
-        static const readers::YTable chargedTable() {
-            return readers::YTable(std::string(DATA_DIR)+std::string("/final_cteq5_cc_nu.data"));
+        static const readers::YTable& chargedTable() {
+            static const readers::YTable& table = readers::TableRegistry::getYTable("final_cteq5_cc_nu.data");
+            return table;
         };
 
         // neutral current final state files
-        static const readers::YTable neutralTable() {
-            return readers::YTable(std::string(DATA_DIR)+std::string("/final_cteq5_nc_nu.data"));
+        static const readers::YTable& neutralTable() {
+            static const readers::YTable& table = readers::TableRegistry::getYTable("final_cteq5_nc_nu.data");
+            return table;
         };
 
+        // the y-factor of a ParticleState is sampled from the same tables
+        friend double getYFactor(const ParticleState& state, const Current current);
+
     };
 
 
@@ -126,7 +155,7 @@ namespace anita {
         /// an appropriately sampled energy. For a neutral current interaction,
         /// this returns a neutrino with the appropriately sampled energy.
         ///
-        std::unique_ptr<Particle> getInteractionProducts(const Current current) const override;
+        ParticlePtr<Particle> getInteractionProducts(const Current current) const override;
 
     private:
 
@@ -157,7 +186,7 @@ namespace anita {
         /// an appropriately sampled energy. For a neutral current interaction,
         /// this returns a neutrino with the appropriately sampled energy.
         ///
-        std::unique_ptr<Particle> getInteractionProducts(const Current current) const override;
+        ParticlePtr<Particle> getInteractionProducts(const Current current) const override;
 
     private:
 
@@ -188,7 +217,7 @@ namespace anita {
         /// an appropriately sampled energy. For a neutral current interaction,
         /// this returns a neutrino with the appropriately sampled energy.
         ///
-        std::unique_ptr<Particle> getInteractionProducts(const Current current) const override;
+        ParticlePtr<Particle> getInteractionProducts(const Current current) const override;
 
     private:
 
@@ -58,12 +58,12 @@ namespace anita {
         ///
         /// \brief Flag indicating whether particle is neutrino
         ///
-        bool isNeutrino() { return this->neutrino; };
+        bool isNeutrino() const { return this->neutrino; };
 
         ///
         /// \brief Flag indicating whether particle is neutrino
         ///
-        bool isLepton() { return !this->neutrino; };
+        bool isLepton() const { return !this->neutrino; };
 
         ///
         /// \brief Get the energy loss, dE/dX of the particle in GeV cm^2/g
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <new>
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <utility>
+
+namespace anita {
+
+    // forward declaration - see Particle.hpp
+    class Particle;
+    class ParticleArena;
+
+    ///
+    /// \brief Destroy a particle, returning its memory to the arena that it was created in
+    ///
+    /// Particles without an arena were allocated with new, and are deleted.
+    ///
+    struct ParticleDeleter {
+
+        ParticleArena* arena; ///< The arena that owns the memory of the particle, if any.
+
+        ParticleDeleter(ParticleArena* a = nullptr) : arena(a) {};
+
+        void operator()(Particle* particle) const;
+    };
+
+    ///
+    /// \brief An owning pointer to a particle, which is usually in a ParticleArena
+    ///
+    template <typename T>
+    using ParticlePtr = std::unique_ptr<T, ParticleDeleter>;
+
+    ///
+    /// \brief A per-thread arena that owns every particle created while propagating a neutrino
+    ///
+    /// Particles are created with placement new in large blocks of memory that are never given back,
+    /// so creating a particle is a bump of a pointer and destroying one only calls its destructor. The
+    /// arena is rewound to the start of its first block whenever its last live particle is destroyed,
+    /// which happens at the end of every event in the propagator, so once the arena has grown to the
+    /// longest regeneration chain no more memory is allocated.
+    ///
+    /// Each thread has its own arena (see local()), so there is no locking. A particle must be
+    /// destroyed on the thread that created it.
+    ///
+    class ParticleArena {
+
+    public:
+
+        ///
+        /// \brief The size (in bytes) of each block of memory in the arena
+        ///
+        static constexpr std::size_t BLOCK_SIZE = 4096;
+
+        ///
+        /// \brief Get the arena of the calling thread
+        ///
+        static ParticleArena& local();
+
+        ///
+        /// \brief Create a new particle of type T in the arena
+        ///
+        template <typename T, typename... Args>
+        ParticlePtr<T> create(Args&&... args) {
+
+            // the particle is constructed in place - if its constructor throws, we release
+            // the memory again (which rewinds the arena if nothing else is alive)
+            void* memory = this->allocate(sizeof(T), alignof(T));
+            this->live++;
+            try {
+                return ParticlePtr<T>(new (memory) T(std::forward<Args>(args)...), ParticleDeleter(this));
+            }
+            catch (...) {
+                this->release();
+                throw;
+            }
+        }
+
+        ///
+        /// \brief Get the number of particles in the arena that have not been destroyed
+        ///
+        std::size_t getNumLive() const { return this->live; };
+
+        ///
+        /// \brief Get the number of blocks of memory that the arena has allocated
+        ///
+        std::size_t getNumBlocks() const { return this->blocks.size(); };
+
+        ///
+        /// \brief Called by ParticleDeleter once the destructor of one of our particles has run
+        ///
+        void release();
+
+    private:
+
+        // every block of memory, which are kept for the lifetime of the arena
+        std::vector<std::unique_ptr<unsigned char[]>> blocks;
+
+        // the block that we are currently allocating from, and the offset in it
+        std::size_t block = 0;
+        std::size_t offset = 0;
+
+        // the number of live particles
+        std::size_t live = 0;
+
+        ///
+        /// \brief Get `size` bytes aligned to `alignment` from the current block, moving to the next if needed
+        ///
+        void* allocate(const std::size_t size, const std::size_t alignment);
+
+    };
+
+    ///
+    /// \brief Create a new particle of type T in the arena of the calling thread
+    ///
+    template <typename T, typename... Args>
+    ParticlePtr<T> makeParticle(Args&&... args) {
+        return ParticleArena::local().create<T>(std::forward<Args>(args)...);
+    }
+
+} // END: namespace anita
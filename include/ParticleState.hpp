@@ -0,0 +1,72 @@
+#pragma once
+
+#include <utility>
+#include <type_traits>
+#include <Particle.hpp>
+#include <ParticleArena.hpp>
+
+namespace anita {
+
+    ///
+    /// \brief A compact, trivially copyable record of a particle
+    ///
+    /// The Particle class hierarchy needs a virtual call (and a dynamic_cast to get at the
+    /// Neutrino or Lepton interface) for every query. Propagation instead carries a ParticleState
+    /// by value and calls the free functions below, which dispatch on the flavor with a switch
+    /// rather than through a vtable and do not allocate. They are defined out of line, so each
+    /// is still a (direct) function call. The classes remain as a facade over these functions,
+    /// and getState/createParticle convert between the two.
+    ///
+    struct ParticleState {
+
+        Flavor flavor; ///< The flavor of the particle - Electron, Muon or Tau.
+
+        bool neutrino; ///< Whether the particle is a neutrino or a charged lepton.
+
+        double energy; ///< The energy of the particle in log10(eV) units.
+
+    };
+
+    static_assert(std::is_trivially_copyable<ParticleState>::value, "ParticleState must be trivially copyable.");
+
+    ///
+    /// \brief Get the state of a particle
+    ///
+    ParticleState getState(const Particle& particle);
+
+    ///
+    /// \brief Create the particle of a state in the ParticleArena of the calling thread
+    ///
+    ParticlePtr<Particle> createParticle(const ParticleState& state);
+
+    ///
+    /// \brief Get the energy loss, dE/dX, in GeV cm^2/g
+    ///
+    double getEnergyLoss(const ParticleState& state);
+
+    ///
+    /// \brief Get the cross section, in cm^2, of a neutrino for a given current (NC/CC)
+    ///
+    double getCrossSection(const ParticleState& state, const Current current);
+
+    ///
+    /// \brief Get the mean column depth (g/cm^2) before a neutrino undergoes a CC or NC interaction
+    ///
+    double getInteractionDepth(const ParticleState& state);
+
+    ///
+    /// \brief Compute the interaction length (km) at a density in g/cm^3 and return the interaction type
+    ///
+    std::pair<double, InteractionType> getInteractionLength(const ParticleState& state, const double density);
+
+    ///
+    /// \brief Pick the current of a neutrino interaction with probability proportional to its cross section
+    ///
+    Current getRandomCurrent(const ParticleState& state);
+
+    ///
+    /// \brief Sample and return a Bjorken y-factor of a neutrino interaction at the current energy
+    ///
+    double getYFactor(const ParticleState& state, const Current current);
+
+} // END: namespace anita
@@ -1,51 +1,107 @@
 #pragma once
 
 #include <map>
+#include <limits>
 #include <vector>
+#include <type_traits>
 #include <NuMC.hpp>
 #include <Particle.hpp>
 #include <Neutrino.hpp>
+#include <ParticleState.hpp>
 #include <Continent.hpp>
+#include <ColumnDepth.hpp>
 #include <readers/Table.hpp>
 #include <readers/Flux.hpp>
 
 namespace anita {
 
     ///
-    /// \brief A class representing the interaction or decay of a particle at some location.
+    /// \brief A record of the interaction or decay of a particle at some location.
     ///
-    /// This class contains all the information about a neutrino or lepton interaction
-    /// that occurs during propagation in rock, ice, air or water.
+    /// This contains all the information about a neutrino or lepton interaction
+    /// that occurs during propagation in rock, ice, air or water. It holds no references
+    /// and is trivially copyable, so it can be stored, copied and written freely
+    /// (see InteractionBuffer).
     ///
     struct Interaction {
 
-        int trials; ///< The number of random neutrino trials before one successfully made it through the Earth.
+        int event; ///< The index of the source neutrino that this interaction belongs to.
 
-        Particle& particle; ///< The particle that interacted at this interaction vertex.
+        int trials; ///< The number of random neutrino trials before one successfully made it through the Earth. Always 1 until charged leptons are propagated (see Propagator::propagate).
 
-        SphericalCoordinate& location; ///< The location of particle interaction w.r.t the center of the Earth.
+        ParticleState particle; ///< The flavor, type and energy of the particle at this interaction vertex.
 
-        SphericalCoordinate& direction; ///< The direction of propagation of the particle at the interaction vertex.
+        SphericalCoordinate location; ///< The location of particle interaction w.r.t the center of the Earth.
+
+        SphericalCoordinate direction; ///< The direction of propagation of the particle at the interaction vertex.
 
         Current current; ///< The interaction type - NeutralCurrent, Charged, Decay??
 
         double distance; ///< Total distance travelled so far in propagating this particle.
 
+        double weight; ///< The generation weight of the source neutrino (see Propagator::getGenerationWeight).
+
+        ///
+        /// \brief Construct an empty interaction.
+        ///
+        Interaction() = default;
+
         ///
-        /// \brief Construct an interaction from pre-initialized member objects.
+        /// \brief Construct an interaction of a particle that is not yet assigned to an event.
         ///
-        Interaction(int n, Particle& p, SphericalCoordinate& loc, SphericalCoordinate& vec,
-                    Current c, double L) : trials(n), particle(p), location(loc),
+        Interaction(int n, const ParticleState& p, const SphericalCoordinate& loc, const SphericalCoordinate& vec,
+                    Current c, double L) : event(-1), trials(n), particle(p), location(loc),
                                            direction(vec), current(c),
-                                           distance(L) {};
+                                           distance(L), weight(1.) {};
     };
 
+    static_assert(std::is_trivially_copyable<Interaction>::value, "Interaction must be trivially copyable.");
+
 
     ///
     /// \brief A vector of Interactions. This is used to store all the interactions that occured for a single source neutrino.
     ///
     using InteractionList = typename std::vector<Interaction>;
 
+    // forward declarations - see InteractionSink.hpp and Acceptance.hpp
+    class InteractionSink;
+    class Acceptance;
+
+    ///
+    /// \brief When Propagator::propagateUntilConverged stops propagating
+    ///
+    struct StoppingCriteria {
+
+        double precision = 0.1; ///< The relative error on the acceptance that every energy bin must reach.
+        double max_time = 0; ///< The maximum wall time (seconds) of the run, or unlimited if 0.
+        int max_events = std::numeric_limits<int>::max(); ///< The maximum number of neutrinos to propagate.
+        int batch_size = 10000; ///< The number of neutrinos propagated between checks.
+
+    };
+
+    ///
+    /// \brief How the distance to the next interaction along a chord is found
+    ///
+    /// Stepping tests for an interaction every PROPAGATION_STEP km along the chord, so its cost grows with the
+    /// distance travelled. Inversion draws an exponential column depth and inverts the cumulative column depth
+    /// of the chord (see ColumnDepth) to find the interaction point directly, at a constant cost per interaction.
+    /// Both sample the same distribution, up to the resolution of the steps.
+    ///
+    enum class PropagationMode { Stepping, Inversion };
+
+    ///
+    /// \brief The length (km) of each step in PropagationMode::Stepping
+    ///
+    constexpr double PROPAGATION_STEP = 1.;
+
+    ///
+    /// \brief Sample the distance (km) along `column` of the next interaction after `start` (km)
+    ///
+    /// `depth` is the mean column depth (g/cm^2) between interactions, e.g. Neutrino::getInteractionDepth().
+    /// Returns infinity if the particle leaves the chord before interacting.
+    ///
+    double sampleInteractionDistance(const ColumnDepth& column, const double start, const double depth,
+                                     const PropagationMode mode = PropagationMode::Inversion);
 
     ///
     /// \brief A class to handle the propagation of source neutrinos through the Earth
@@ -66,20 +122,99 @@ namespace anita {
         /// neutrino flavors and energies from the source model. For each generated neutrino, it calls this->propagate()
         /// to simulate the interactions of that neutrino. The keys of each map correspond to each source neutrino
         ///
+        /// If `nthreads` is larger than one, neutrinos are distributed across a work-stealing pool of threads
+        /// (see Scheduler). The results of every thread are merged by event index so the returned map is
+        /// identical in structure to a serial run.
+        ///
+        /// This keeps every event in memory; long runs should stream events to an InteractionSink instead.
+        ///
         /// @param particlesToSimulate The number of neutrinos to propagate through the Earth.
+        /// @param nthreads The number of threads to propagate with. If 0, use all available cores.
         ///
-        std::map<int, InteractionList> propagateParticles(const int particlesToSimulate) const;
+        std::map<int, InteractionList> propagateParticles(const int particlesToSimulate,
+                                                          const unsigned int nthreads = 1) const;
+
+        ///
+        /// \brief Propagate a fixed number of particles through the Earth, streaming each event to `sink`.
+        ///
+        /// Identical to the map-returning propagateParticles except that the InteractionList of every
+        /// neutrino is handed to `sink` as soon as it has finished propagating, so memory use does not
+        /// grow with the number of events.
+        ///
+        /// @param particlesToSimulate The number of neutrinos to propagate through the Earth.
+        /// @param sink The sink to receive the interactions of every event.
+        /// @param nthreads The number of threads to propagate with. If 0, use all available cores.
+        /// @param first The event number of the first neutrino, so that runs can be continued.
+        ///
+        void propagateParticles(const int particlesToSimulate, InteractionSink& sink,
+                                const unsigned int nthreads = 1, const int first = 0) const;
+
+        ///
+        /// \brief Propagate particles into `acceptance` until it reaches the precision of `criteria`.
+        ///
+        /// Neutrinos are propagated in batches of `criteria.batch_size`, and after each batch the run
+        /// stops if the relative error on the acceptance of every energy bin (see Acceptance::isConverged)
+        /// is at most `criteria.precision`, or if the wall time or number of events is exhausted.
+        /// Returns the number of neutrinos that were propagated.
+        ///
+        /// @param acceptance The acceptance to accumulate.
+        /// @param criteria When to stop propagating.
+        /// @param nthreads The number of threads to propagate with. If 0, use all available cores.
+        ///
+        int propagateUntilConverged(Acceptance& acceptance, const StoppingCriteria& criteria,
+                                    const unsigned int nthreads = 1) const;
 
         /// \brief Propagate a single particle through the Earth recording all interactions.
         ///
-        /// For each input neutrino, we pick a random exit location and random exit direction and back-calculate
-        /// the source location and direction. The source neutrino is then propagated through the Earth, returning
-        /// a vector of all the interactions it undergoes (NC and CC) during its propagation.
+        /// For each input neutrino, we pick a random exit location and random exit direction (see getGenerationAcceptance)
+        /// and back-calculate the source location and direction. The source neutrino is then propagated through the Earth,
+        /// returning a vector of all the interactions it undergoes (NC and CC) during its propagation.
+        ///
+        /// Charged leptons are not propagated yet: the neutrino is followed through any number of NC
+        /// interactions and stops at its first CC interaction, which is the last one recorded. As no
+        /// neutrino is ever retried, the `trials` of every interaction is 1.
         ///
         /// @param particle The Neutrino to propagate through the Earth.
         ///
         InteractionList propagate(Neutrino& particle) const;
 
+        ///
+        /// \brief Get the generation weight of a source neutrino with an energy in log10(eV).
+        ///
+        /// This is the inverse of the probability density (per log10 eV) with which energies are
+        /// generated between the min/max energy cuts, i.e. of the slope of the piecewise linear
+        /// CDF that they are sampled from (readers::Flux::getCDFSlope), and is zero for energies
+        /// that are never generated. Multiplying it by readers::Flux::getDensity of
+        /// any flux model, and dividing by the number of neutrinos generated, reweights an event to
+        /// that model. This is what lets events generated with readers::REFERENCE_FLUX be reweighted
+        /// to every flux model (see Reweighter). It is one when all neutrinos have a fixed energy.
+        ///
+        double getGenerationWeight(const double energy) const;
+
+        ///
+        /// \brief Get the area times solid angle (km^2 sr) over which source neutrinos are generated.
+        ///
+        /// Every neutrino leaves through a point on the ice, uniform in area, in a direction weighted
+        /// by the cosine from the vertical, i.e. as an isotropic flux crosses the surface. Each of N
+        /// generated neutrinos therefore represents 1/N of pi times the area of the ice.
+        ///
+        double getGenerationAcceptance() const;
+
+        ///
+        /// \brief Get the minimum energy cut (log10 eV).
+        ///
+        double getMinEnergy() const { return this->min_energy; };
+
+        ///
+        /// \brief Get the maximum energy cut (log10 eV).
+        ///
+        double getMaxEnergy() const { return this->max_energy; };
+
+        ///
+        /// \brief Get the energy (log10 eV) of every neutrino, or 0 if energies are drawn from the flux.
+        ///
+        double getFixedEnergy() const { return this->fixed_energy; };
+
         ///
         /// \brief Construct a new propagator.
         ///
@@ -89,13 +224,18 @@ namespace anita {
         /// @param con An initialized Continent object
         /// @param fluxname A string corresponding to a filename in data/flux which contains the desired source neutrino model
         /// @param fixedE If `fluxname`=='fixed', then `fixedE` will contain the energy used for all neutrinos (in log10(eV) units)
-        /// @param maxE The maximum energy above which particles are not generated
         /// @param minE The minimum energy below which particles are not generated, or propagated
+        /// @param maxE The maximum energy above which particles are not generated
+        /// @param mode How the distance to each interaction is sampled
         ///
         Propagator(const Continent& con, const std::string fluxname, const double fixedE,
-                   const double maxE, const double minE) : continent(con), flux_model(fluxname),
-                                                           flux(fluxname), fixed_energy(fixedE),
-                                                           min_energy(minE), max_energy(maxE) {};
+                   const double minE, const double maxE,
+                   const PropagationMode mode = PropagationMode::Inversion) : continent(con), flux_model(fluxname),
+                                                                              flux(fluxname), fixed_energy(fixedE),
+                                                                              min_energy(minE), max_energy(maxE),
+                                                                              min_fraction(flux.getCDF(minE)),
+                                                                              max_fraction(flux.getCDF(maxE)),
+                                                                              propagation_mode(mode) {};
     private:
 
         ///
@@ -133,6 +273,21 @@ namespace anita {
         ///
         const double max_energy;
 
+        ///
+        /// \brief The fraction of the flux below the minimum energy.
+        ///
+        const double min_fraction;
+
+        ///
+        /// \brief The fraction of the flux below the maximum energy.
+        ///
+        const double max_fraction;
+
+        ///
+        /// \brief How the distance to each interaction is sampled.
+        ///
+        const PropagationMode propagation_mode;
+
     };
 
 }
@@ -1,12 +1,123 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <functional>
-#include <boost/random/mersenne_twister.hpp>
 
-// define global RNG
-extern boost::mt19937 gen;
+namespace anita {
 
-// Returns a uniform random variable between min and max, inclusive
+    ///
+    /// \brief The Philox4x32-10 counter-based random number generator
+    ///
+    /// Philox maps a 128-bit counter and a 64-bit key to 128 random bits using ten rounds
+    /// of a keyed bijection (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3", SC11).
+    /// It has no internal state - every (counter, key) pair is an independent block of random bits,
+    /// so any block can be generated on any thread, in any order.
+    ///
+    class Philox {
+
+    public:
+
+        using Counter = std::array<std::uint32_t, 4>;
+        using Key = std::array<std::uint32_t, 2>;
+
+        ///
+        /// \brief Return the 128 random bits for `counter` under `key`
+        ///
+        static Counter generate(Counter counter, Key key);
+
+    };
+
+    ///
+    /// \brief A reproducible stream of random numbers for a single event
+    ///
+    /// The key of the stream is the run seed, and the upper 64 bits of the counter are the
+    /// event index; the lower 64 bits count the blocks drawn so far. The numbers drawn for an
+    /// event therefore depend only on (seed, event), and not on which thread, shard or order
+    /// the events were simulated in.
+    ///
+    /// The distributions are implemented directly on the stream so no distribution
+    /// objects are constructed per draw.
+    ///
+    class RandomStream {
+
+    public:
+
+        ///
+        /// \brief Construct the stream for `event` of the run with `seed`
+        ///
+        RandomStream(const std::uint64_t seed = 0, const std::uint64_t event = 0) { this->reset(seed, event); };
+
+        ///
+        /// \brief Restart this stream at the first draw of `event` of the run with `seed`
+        ///
+        void reset(const std::uint64_t seed, const std::uint64_t event);
+
+        ///
+        /// \brief Return the next 32 random bits
+        ///
+        std::uint32_t next() {
+            if (this->index == 4) {
+                this->refill();
+            }
+            return this->block[this->index++];
+        };
+
+        ///
+        /// \brief Returns a uniform random variable in [min, max) with 53 bits of precision
+        ///
+        double uniform(const double min = 0, const double max = 1);
+
+        ///
+        /// \brief Returns a uniform random integer between min and max, inclusive
+        ///
+        int uniformInt(const int min, const int max);
+
+        ///
+        /// \brief Returns a poisson-distributed random variable with 'mean'
+        ///
+        int poisson(const double mean);
+
+        ///
+        /// \brief Returns a gaussian with mean 'mean' and standard deviation 'stdev'
+        ///
+        double gaussian(const double mean = 0, const double stdev = 1);
+
+    private:
+
+        // the key (the run seed) and the counter of the next block
+        Philox::Key key;
+        Philox::Counter counter;
+
+        // the current block of random bits and the next unused word in it
+        Philox::Counter block;
+        unsigned int index;
+
+        // the second normal variate from the last Box-Muller transform
+        double spare;
+        bool has_spare;
+
+        // generate the next block and advance the counter
+        void refill();
+
+    };
+
+} // END: namespace anita
+
+// Set the seed of the run. This must be called before any events are started.
+void setSeed(std::uint64_t seed);
+
+// Get the seed of the run
+std::uint64_t getSeed();
+
+// Restart the calling thread's random stream at the first draw of `event`
+// Every draw made on this thread until the next call is reproducible from (seed, event)
+void beginEvent(std::uint64_t event);
+
+// Get the random stream of the calling thread
+anita::RandomStream& getRandomStream();
+
+// Returns a uniform random variable between min and max
 double uniform(double min=0, double max=1);
 
 // Returns a uniform random integer between min and max, inclusive
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <InteractionSink.hpp>
+#include <readers/Flux.hpp>
+
+namespace anita {
+
+    ///
+    /// \brief A sink that reweights every event to many flux models in a single pass.
+    ///
+    /// Rather than rerunning the simulation for every flux model, neutrinos can be generated once
+    /// from readers::REFERENCE_FLUX (or any other flux) and every event reweighted afterwards. The
+    /// weight of an event for a flux model is
+    ///
+    /// \f$w = \frac{1}{N} \Phi(E) \, W(E)\f$
+    ///
+    /// where N is the number of neutrinos generated, \f$\Phi(E)\f$ is the number of neutrinos per
+    /// unit log10 eV in the model (readers::Flux::getDensity) at the energy E of the source neutrino,
+    /// and W(E) is the generation weight recorded by the propagator (Propagator::getGenerationWeight).
+    /// The sum of the weights of the events is then an estimate of the number of neutrinos of that
+    /// model (in cm^-2 s^-1 sr^-1) that produce such events.
+    ///
+    /// Every event with at least one interaction is counted. A neutrino only changes energy when it
+    /// interacts, so the energy of its first interaction is the energy it was generated with.
+    ///
+    class Reweighter : public InteractionSink {
+
+    public:
+
+        ///
+        /// \brief Reweight `ngenerated` neutrinos to each of `models` in data/fluxes.
+        ///
+        Reweighter(const std::vector<std::string> models, const int ngenerated);
+
+        ///
+        /// \brief Reweight `ngenerated` neutrinos to every flux model in data/fluxes.
+        ///
+        explicit Reweighter(const int N) : Reweighter(readers::Flux::getModels(), N) {};
+
+        ///
+        /// \brief Create an accumulator for each worker.
+        ///
+        void begin(const unsigned int nworkers) override;
+
+        ///
+        /// \brief Add the weight of `event` for every model.
+        ///
+        void consume(const unsigned int worker, const int event, InteractionList& interactions) override;
+
+        ///
+        /// \brief Combine the accumulators of every worker.
+        ///
+        void finish() override;
+
+        ///
+        /// \brief Every worker has its own accumulator, so events can be reweighted concurrently.
+        ///
+        bool isConcurrent() const override { return true; };
+
+        ///
+        /// \brief Get the weight of a source neutrino of `energy` (log10 eV) and generation `weight` for `model`.
+        ///
+        double getWeight(const std::size_t model, const double energy, const double weight) const;
+
+        ///
+        /// \brief Get the names of the flux models.
+        ///
+        const std::vector<std::string>& getModels() const { return this->names; };
+
+        ///
+        /// \brief Get the sum of the weights of every event for `model`.
+        ///
+        double getRate(const std::size_t model) const { return this->rates.at(model); };
+
+        ///
+        /// \brief Get the statistical error on getRate for `model`.
+        ///
+        double getError(const std::size_t model) const;
+
+    private:
+
+        // the names of the flux models, and each model
+        const std::vector<std::string> names;
+        std::vector<std::unique_ptr<const readers::Flux>> models;
+
+        // the number of neutrinos that were generated
+        const int ngenerated;
+
+        ///
+        /// \brief The sums of the weights, and of their squares, for each model.
+        ///
+        struct Accumulator {
+            std::vector<double> weights;
+            std::vector<double> squares;
+        };
+
+        // one accumulator per worker
+        std::vector<Accumulator> accumulators;
+
+        // the combined sums over all the workers
+        std::vector<double> rates;
+        std::vector<double> squares;
+
+    };
+
+} // END: namespace anita
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <mutex>
+#include <cstddef>
+#include <memory>
+#include <functional>
+#include <Utils.hpp>
+
+namespace anita {
+
+    ///
+    /// \brief A work-stealing scheduler that distributes event indices over a pool of threads
+    ///
+    /// The event range [0, nevents) is initially split into one contiguous block per worker.
+    /// Each worker consumes its own block from the front; once it runs dry, it steals the
+    /// back half of the largest block still owned by another worker. This keeps every thread
+    /// busy even though the cost per event is very uneven (i.e. the `ntrials` retry loop
+    /// in Propagator::propagate).
+    ///
+    /// Worker 0 always runs on the calling thread, so a Scheduler with a single thread
+    /// executes every event serially, in order, without spawning any threads.
+    ///
+    class Scheduler {
+
+    public:
+
+        ///
+        /// \brief The signature of the function called once for every event.
+        ///
+        using Task = std::function<void(const unsigned int worker, const int event)>;
+
+        ///
+        /// \brief The signature of the function called once by every worker before its first event.
+        ///
+        using Setup = std::function<void(const unsigned int worker)>;
+
+        ///
+        /// \brief Construct a scheduler with `nthreads` workers. If `nthreads` is 0, use all available cores.
+        ///
+        Scheduler(const unsigned int nthreads);
+        ~Scheduler() {};
+
+        ///
+        /// \brief Call `task` exactly once for every event in [0, nevents) and return once all have finished.
+        ///
+        /// If any task throws, the remaining workers stop taking new events and the first
+        /// exception is rethrown on the calling thread once all workers have joined.
+        ///
+        void run(const int nevents, const Task& task, const Setup& setup = nullptr) const;
+
+        ///
+        /// \brief Get the number of workers used by this scheduler.
+        ///
+        unsigned int getNumThreads() const { return this->nthreads; };
+
+    private:
+
+        ///
+        /// \brief The half-open range of events still owned by a single worker.
+        ///
+        struct Range {
+            std::mutex lock;
+            int begin = 0;
+            int end = 0;
+        };
+
+        ///
+        /// \brief A Range padded to a whole number of cache lines.
+        ///
+        /// Scheduler::run places these on cache-line aligned storage (utils::makeAligned)
+        /// so that workers popping from their own range do not contend with each other.
+        ///
+        struct WorkRange : Range {
+            char padding[utils::CACHE_LINE - sizeof(Range) % utils::CACHE_LINE];
+        };
+
+        ///
+        /// \brief Pop the next event from the front of `worker`'s range, returning -1 if empty.
+        ///
+        static int pop(WorkRange& range);
+
+        ///
+        /// \brief Steal the back half of the largest range owned by another worker into `worker`'s range.
+        ///
+        /// Returns false if every other worker's range was empty.
+        ///
+        bool steal(WorkRange* ranges, const unsigned int worker) const;
+
+        // the number of workers in the pool
+        const unsigned int nthreads;
+
+    };
+
+} // END: namespace anita
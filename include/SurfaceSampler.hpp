@@ -0,0 +1,116 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <readers/Bedmap.hpp>
+
+namespace anita {
+
+    ///
+    /// \brief Walker's alias method for drawing from a discrete distribution in O(1)
+    ///
+    /// The table is built in O(n) using Vose's algorithm from a vector of (unnormalized)
+    /// non-negative weights, and every draw costs one uniform random number.
+    ///
+    class AliasTable {
+
+    public:
+
+        ///
+        /// \brief Build the alias table for `weights`
+        ///
+        AliasTable(const std::vector<double>& weights);
+
+        ///
+        /// \brief Draw an index with probability proportional to its weight
+        ///
+        std::size_t sample() const;
+
+        ///
+        /// \brief Get the number of entries in the table
+        ///
+        std::size_t size() const { return this->probability.size(); };
+
+    private:
+
+        // the probability of keeping each entry rather than taking its alias
+        std::vector<float> probability;
+
+        // the entry to take instead of each entry
+        std::vector<std::uint32_t> alias;
+
+    };
+
+    ///
+    /// \brief Draws points uniformly (by true surface area) on the ice of Antarctica
+    ///
+    /// Every cell of the Bedmap2 grid whose icemask is grounded ice or ice shelf is weighted by
+    /// its area on the WGS84 ellipsoid (1 km^2 / k^2, where k is the scale factor of the projection)
+    /// and stored in an AliasTable. Each draw picks a cell in O(1), a uniform position within that
+    /// cell on the map, and converts it back to (theta, phi).
+    ///
+    /// Compared to drawing uniformly on the spherical cap below -60 degrees, no samples are wasted
+    /// on open ocean. The acceptance, the ice area over the area of that cap, must multiply any
+    /// effective volume (or area) that is normalized to the cap.
+    ///
+    /// The variation of the scale factor within a single 1 km cell is below 1e-3, so positions
+    /// within a cell are drawn uniformly on the map.
+    ///
+    class SurfaceSampler {
+
+    public:
+
+        ///
+        /// \brief Build the sampler from the ice mask of `bedmap`
+        ///
+        SurfaceSampler(const readers::Bedmap& bedmap);
+
+        ///
+        /// \brief Draw a random (theta, phi) in radians on the ice
+        ///
+        std::pair<double, double> sample() const;
+
+        ///
+        /// \brief Get the total area (km^2) of the ice cells on the WGS84 ellipsoid
+        ///
+        double getIceArea() const { return this->ice_area; };
+
+        ///
+        /// \brief Get the area (km^2) of the WGS84 ellipsoid below -60 degrees latitude
+        ///
+        double getCapArea() const { return this->cap_area; };
+
+        ///
+        /// \brief Get the fraction of the cap below -60 degrees that is covered by the ice cells
+        ///
+        double getAcceptance() const { return this->ice_area/this->cap_area; };
+
+        ///
+        /// \brief Get the number of ice cells
+        ///
+        std::size_t getNumCells() const { return this->cells.size(); };
+
+    private:
+
+        // a copy of the Bedmap (which shares its rasters) for the grid and inverse projection
+        const readers::Bedmap bedmap;
+
+        // the area of the ice cells and of the cap below -60 degrees
+        double ice_area;
+        double cap_area;
+
+        // the index (row*ncols + col) of every ice cell
+        std::vector<std::uint32_t> cells;
+
+        // the alias table over the ice cells, weighted by area
+        const AliasTable table;
+
+        ///
+        /// \brief Find the ice cells and fill `cells` and `ice_area`, returning the area of each cell
+        ///
+        std::vector<double> findIceCells();
+
+    };
+
+} // END: namespace anita
@@ -1,10 +1,54 @@
 #pragma once
 
 #include <tuple>
+#include <memory>
 #include <vector>
+#include <cstddef>
 
 namespace anita { namespace utils {
 
+        ///
+        /// \brief The size of a cache line, in bytes.
+        ///
+        constexpr std::size_t CACHE_LINE = 64;
+
+        ///
+        /// \brief Destroys and frees an array placed by makeAligned
+        ///
+        template <typename T>
+        struct AlignedDeleter {
+            std::size_t n;
+            void* storage;
+            void operator()(T* array) const {
+                for (std::size_t i = 0; i < n; i++) array[i].~T();
+                ::operator delete(storage);
+            }
+        };
+
+        ///
+        /// \brief An array allocated by makeAligned
+        ///
+        template <typename T>
+        using AlignedArray = std::unique_ptr<T[], AlignedDeleter<T>>;
+
+        ///
+        /// \brief Allocate `n` default-constructed T's, the first starting on an `alignment` boundary
+        ///
+        /// C++14 operator new does not honour alignas(CACHE_LINE), so per-thread state that
+        /// is padded to a whole number of cache lines is placed on storage aligned by hand.
+        ///
+        template <typename T>
+        AlignedArray<T> makeAligned(const std::size_t n, const std::size_t alignment = CACHE_LINE) {
+            std::size_t space = n*sizeof(T) + alignment;
+            void* storage = ::operator new(space);
+            void* aligned = storage;
+            std::align(alignment, n*sizeof(T), aligned, space);
+
+            T* array = static_cast<T*>(aligned);
+            for (std::size_t i = 0; i < n; i++) new (array + i) T();
+            return AlignedArray<T>(array, AlignedDeleter<T>{n, storage});
+        }
+
         ///
         /// \brief Clamp a std::vector to a range inplace
         ///
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <math.h>
+
 namespace anita {
 
   template <typename T>
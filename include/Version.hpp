@@ -0,0 +1,19 @@
+#pragma once
+
+namespace anita {
+
+    ///
+    /// \brief The md5 hash of the source files that this binary was built from.
+    ///
+    /// This, and GIT_COMMIT, are saved into every output file to record the code that produced
+    /// it. They are defined in a source file that the Makefile generates (obj/Version.cc) and
+    /// only rewrites when they change, so that a new hash or commit rebuilds just that file.
+    ///
+    extern const char* const SOURCE_HASH;
+
+    ///
+    /// \brief The first 8 characters of the git commit that this binary was built from.
+    ///
+    extern const char* const GIT_COMMIT;
+
+} // END: namespace anita
@@ -1,7 +1,11 @@
 #pragma once
 
-#include <string>
 #include <tuple>
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <string>
 #include <Constants.hpp>
 
 namespace anita { namespace readers {
@@ -31,6 +35,139 @@ namespace anita { namespace readers {
         ///
         enum class IceMask { Grounded = 0, IceShelf = 1, Ocean = 127 };
 
+        ///
+        /// \brief Every Bedmap2 field interpolated at a single point
+        ///
+        /// Returned by Bedmap::query(). Elevations are relative to the WGS84 ellipsoid, and are NaN
+        /// wherever the underlying Bedmap2 data is NaN.
+        ///
+        struct BedmapPoint {
+
+            double x; ///< x in polar stereographic coordinates (km)
+            double y; ///< y in polar stereographic coordinates (km)
+            double surface; ///< elevation of the ice surface (m)
+            double bed; ///< elevation of the rock bed (m)
+            double thickness; ///< thickness of the ice (m)
+            double geoid; ///< offset (m) from the EIGEN-GL04C geoid to WGS84
+            IceMask mask; ///< the (conservative) ice mask
+
+        };
+
+        ///
+        /// \brief The Bedmap2 surface, bed and ice thickness at a point along a path
+        ///
+        /// Elevations are relative to the WGS84 ellipsoid, exactly as in BedmapPoint.
+        ///
+        struct BedmapProfile {
+
+            double surface; ///< elevation of the ice surface (m)
+            double bed; ///< elevation of the rock bed (m)
+            double thickness; ///< thickness of the ice (m)
+
+        };
+
+        ///
+        /// \brief The part of a straight path on the map that lies within a single Bedmap2 cell
+        ///
+        /// Within a cell every field is bilinear, so along the segment each is a quadratic in the
+        /// distance and `mean` (from Simpson's rule) is its exact average over the segment.
+        ///
+        struct BedmapSegment {
+
+            double start; ///< the distance (km on the map) along the path where the segment starts
+            double end; ///< the distance (km on the map) along the path where the segment ends
+            int col; ///< the column of the first corner of the cell; -1 in the half cell on the left edge
+            int row; ///< the row of the first corner of the cell; -1 in the half cell on the top edge
+            BedmapProfile entry; ///< the fields where the path enters the cell
+            BedmapProfile exit; ///< the fields where the path leaves the cell
+            BedmapProfile mean; ///< the average of each field along the segment
+
+        };
+
+        ///
+        /// \brief How Bedmap2 rasters are stored in memory
+        ///
+        /// `Heap` reads each raw Bedmap2 file into private memory and replaces NODATA with NaN
+        /// every time a Bedmap is constructed.
+        ///
+        /// `MemoryMap` maps a preprocessed copy of each file, with the NaN's already in place,
+        /// read-only into memory. The pages are shared through the page cache by every process on a
+        /// node and are only read from disk when first touched, so construction is nearly instant.
+        /// The preprocessed copies are written next to the raw files the first time they are needed
+        /// (and whenever a raw file changes); if they cannot be written, we fall back to `Heap`.
+        ///
+        enum class BedmapStorage { Heap, MemoryMap };
+
+        ///
+        /// \brief How the Bedmap2 fields are laid out for lookups
+        ///
+        /// `Planar` interpolates directly from the five row-major rasters, so a lookup of every
+        /// field touches two rows of each raster (ten cache lines up to 900 MB apart).
+        ///
+        /// `Tiled` copies the rasters into 32x32 cell tiles with the five fields of each cell
+        /// interleaved and a one-cell halo on the far edges of each tile, so every bilinear
+        /// lookup of every field reads from a single ~20 kB tile. This costs another ~950 MB
+        /// of (shared) heap and a few seconds at construction, but is much friendlier to the
+        /// caches and TLB for random lookups and ray stepping.
+        ///
+        enum class BedmapLayout { Planar, Tiled };
+
+        ///
+        /// \brief A read-only ncols*nrows block of Bedmap2 floats with NODATA replaced by NaN
+        ///
+        /// The values are either owned on the heap or memory-mapped from a preprocessed
+        /// copy of the raw Bedmap2 file; see BedmapStorage. Copies of a raster share
+        /// the same values, which are freed (or unmapped) with the last copy.
+        ///
+        class BedmapRaster {
+
+        public:
+            ///
+            /// \brief Load the raw Bedmap2 file `filename` (in data/bedmap2_bin) using `storage`
+            ///
+            BedmapRaster(const std::string filename, const int ncols, const int nrows, const BedmapStorage storage);
+
+            ~BedmapRaster() {};
+
+            ///
+            /// \brief Get the ncols*nrows block of contiguous values
+            ///
+            const float* data() const { return this->values.get(); };
+
+            ///
+            /// \brief Whether this raster is memory-mapped from a preprocessed file
+            ///
+            bool isMapped() const { return this->mapped; };
+
+        private:
+
+            // the values of the raster. The deleter frees or unmaps the storage
+            std::shared_ptr<const float> values;
+
+            // whether the values are memory-mapped
+            bool mapped;
+
+            ///
+            /// \brief Read the raw Bedmap2 file at `path` into a heap-allocated array, replacing NODATA with NaN
+            ///
+            float* readRawData(const std::string path, const int ncols, const int nrows) const;
+
+            ///
+            /// \brief Map the preprocessed raster at `path` if it exists and matches `source`
+            ///
+            bool mapPreprocessed(const std::string path, const std::string source, const int ncols, const int nrows);
+
+            ///
+            /// \brief Atomically write `data` as a preprocessed raster for `source` at `path`
+            ///
+            bool writePreprocessed(const std::string path, const std::string source,
+                                   const float* data, const int ncols, const int nrows) const;
+
+        };
+
+        // forward declaration - see below
+        class BedmapWalker;
+
         ///
         /// \brief A class providing read utilities for accessing Bedmap2 data
         ///
@@ -43,16 +180,23 @@ namespace anita { namespace readers {
             ///
             /// \brief Initialize a new Bedmap class and load all required data files
             ///
-            Bedmap() : surface(readBedmapData(surface_file)),
-                       bed(readBedmapData(bed_file)),
-                       icemask(readBedmapData(icemask_file)),
-                       thickness(readBedmapData(thickness_file)),
-                       gl04c_to_wgs(readBedmapData(gl04c_to_wgs_file)) {};
+            /// By default, the rasters are memory-mapped from preprocessed copies of the Bedmap2
+            /// files (see BedmapStorage) so that they are shared by all processes on a node, and
+            /// are read in their original layout (see BedmapLayout).
+            ///
+            Bedmap(const BedmapStorage storage = BedmapStorage::MemoryMap,
+                   const BedmapLayout layout = BedmapLayout::Planar)
+                : surface(surface_file, ncols, nrows, storage),
+                  bed(bed_file, ncols, nrows, storage),
+                  icemask(icemask_file, ncols, nrows, storage),
+                  thickness(thickness_file, ncols, nrows, storage),
+                  gl04c_to_wgs(gl04c_to_wgs_file, ncols, nrows, storage),
+                  tiles(layout == BedmapLayout::Tiled ? this->buildTiles() : nullptr) {};
 
             ///
-            /// \brief Delete the memory allocated for Bedmap2 arrays
+            /// \brief The Bedmap2 rasters free themselves
             ///
-            ~Bedmap();
+            ~Bedmap() {};
 
             ///
             /// \brief Get the surface elevation of ice (in m) relative to the WGS84 ellipsoid at a given (theta, phi)
@@ -137,8 +281,128 @@ namespace anita { namespace readers {
             ///
             IceMask getIceMaskAtPoint(const double x, const double y) const;
 
+            ///
+            /// \brief Query every Bedmap2 field at a given (theta, phi) in radians
+            ///
+            /// This projects (theta, phi) and finds the four surrounding grid cells once, and then
+            /// interpolates every raster at those cells. This is much cheaper than calling each of
+            /// the individual getters when more than one field is needed at a point, and the values
+            /// are identical to the individual getters.
+            ///
+            BedmapPoint query(const double theta, const double phi) const;
+
+            ///
+            /// \brief Query every Bedmap2 field at (x, y) (km) in Bedmap coordinates
+            ///
+            BedmapPoint queryAtPoint(const double x, const double y) const;
+
+            ///
+            /// \brief Get the value of every Bedmap2 field at the cell (col, row) of the grid
+            ///
+            /// Unlike queryAtPoint at the center of the cell, this is never affected by NaN's in the
+            /// neighbouring cells. Rows are counted from the top of the map.
+            ///
+            BedmapPoint queryAtCell(const int col, const int row) const;
+
+            ///
+            /// \brief Get the value of every Bedmap2 field at every cell of `row` of the grid
+            ///
+            /// This is queryAtCell for (0, row) ... (ncols - 1, row); `points` must have room for ncols points.
+            ///
+            void queryRow(const int row, BedmapPoint* points) const;
+
+            ///
+            /// \brief Query every Bedmap2 field at `n` (theta, phi) points (radians) at once
+            ///
+            /// This projects and interpolates whole blocks of points with the vectorized kernels in
+            /// Stereographic.hpp and Bilinear.hpp, and gives the same values as query(). Points
+            /// outside of the Bedmap2 grid are returned with NaN fields and IceMask::Ocean.
+            ///
+            void query(const std::size_t n, const double* theta, const double* phi, BedmapPoint* points) const;
+
+            ///
+            /// \brief Query every Bedmap2 field at `n` (x, y) (km) points in Bedmap coordinates at once
+            ///
+            void queryAtPoints(const std::size_t n, const double* x, const double* y, BedmapPoint* points) const;
+
+            ///
+            /// \brief Walk `length` km along a straight path on the map, filling `segments` with every cell it crosses
+            ///
+            /// The path starts at (x, y) (km) in Bedmap coordinates, which must be on the grid, and heads
+            /// along (dx, dy); it stops early at the edge of the grid. See BedmapWalker. Returns the
+            /// number of segments.
+            ///
+            std::size_t walk(const double x, const double y, const double dx, const double dy, const double length,
+                             std::vector<BedmapSegment>& segments) const;
+
+            ///
+            /// \brief Convert (x, y) (km) in Bedmap coordinates to (theta, phi) in radians
+            ///
+            /// This is the inverse of the polar stereographic projection used by every other
+            /// method (Snyder, Pg. 161, Eq. 21-39, 7-13 and 3-5), with phi in (-pi, pi].
+            ///
+            std::pair<double, double> BEDMAPLocationToCoord(const double x, const double y) const;
+
+            ///
+            /// \brief Get the scale factor of the projection at (x, y) (km) in Bedmap coordinates
+            ///
+            /// A small area A on the map corresponds to an area A/k^2 on the WGS84 ellipsoid
+            /// (Snyder, Pg. 161, Eq. 21-32 and 21-35 at the pole).
+            ///
+            double getScaleFactor(const double x, const double y) const;
+
+            ///
+            /// \brief Get the number of columns of the Bedmap2 grid
+            ///
+            int getNumColumns() const { return this->ncols; };
+
+            ///
+            /// \brief Get the number of rows of the Bedmap2 grid
+            ///
+            int getNumRows() const { return this->nrows; };
+
+            ///
+            /// \brief Get the (x, y) (km) of the center of the cell at (col, row) of the Bedmap2 grid
+            ///
+            /// Rows are counted from the top of the map; every Bedmap2 field evaluated at the
+            /// center of a cell is exactly the value of that cell (unless a neighbour is NaN).
+            ///
+            std::pair<double, double> getCellCenter(const int col, const int row) const {
+                return std::make_pair(this->xllcorner + (static_cast<double>(col) + 0.5)*this->cellsize,
+                                      -this->yllcorner - (static_cast<double>(row) + 0.5)*this->cellsize); };
+
+            ///
+            /// \brief Project `n` (theta, phi) points (radians) to (x, y) (km) in Bedmap coordinates
+            ///
+            /// This is the batch version of coordToBEDMAPLocation (see projectStereographic), for
+            /// evaluating whole rays or sets of chord samples in one pass. Instead of throwing,
+            /// points outside of the Bedmap2 grid have `inrange[i]` set to 0 and (x, y) set to NaN.
+            /// Returns the number of points inside the grid.
+            ///
+            std::size_t coordsToBEDMAPLocations(const std::size_t n, const double* theta, const double* phi,
+                                                double* x, double* y, std::uint8_t* inrange) const;
+
         private:
 
+            // the walker reads the rasters directly
+            friend class BedmapWalker;
+
+            ///
+            /// \brief The four grid cells surrounding a point and the position within them
+            ///
+            /// The indices are into the rasters for BedmapLayout::Planar, or into the
+            /// cells of the tiles for BedmapLayout::Tiled.
+            ///
+            struct Cell {
+                int i00, i10, i01, i11; ///< indices of (0, 0), (1, 0), (0, 1), (1, 1)
+                std::pair<double, double> pos; ///< position in the unit square
+            };
+
+            ///
+            /// \brief The Bedmap2 fields, in the order they are interleaved in the tiles
+            ///
+            enum Field { Surface = 0, Bed = 1, Thickness = 2, Geoid = 3, Mask = 4, NFields = 5 };
+
             // filenames for respective BEDMAP files
             const std::string surface_file = "bedmap2_surface.flt";
             const std::string bed_file = "bedmap2_bed.flt";
@@ -157,23 +421,44 @@ namespace anita { namespace readers {
 
             // BEDMAP2 data of surface elevation
             // ncols*nrows block of contiguous values
-            const float *surface;
+            const BedmapRaster surface;
 
             // BEDMAP2 data of surface elevation
             // ncols*nrows block of contiguous values
-            const float *bed;
+            const BedmapRaster bed;
 
             // BEDMAP2 data of icemask showing where there are ice measurements
             // ncols*nrows block of contiguous values
-            const float *icemask;
+            const BedmapRaster icemask;
 
             // BEDMAP2 data of ice thickness
             // ncols*nrows block of contiguous values
-            const float *thickness;
+            const BedmapRaster thickness;
 
             // BEDMAP2 data to convert from EIGEN-GL04C to WGS84
             // add this value to convert from EIGEN-GL04C
-            const float *gl04c_to_wgs;
+            const BedmapRaster gl04c_to_wgs;
+
+            // the side of each tile (in cells) and the side including the halo
+            static constexpr int tilesize = 32;
+            static constexpr int tilestride = tilesize + 1;
+
+            // the number of tiles along each side of the grid
+            const int ntiles = (this->ncols + tilesize - 1)/tilesize;
+
+            // ntiles*ntiles tiles of tilestride*tilestride cells of NFields interleaved values
+            // this is null unless we are using BedmapLayout::Tiled
+            const std::shared_ptr<const float> tiles;
+
+            ///
+            /// \brief Copy the rasters into the tiled, interleaved layout
+            ///
+            std::shared_ptr<const float> buildTiles() const;
+
+            ///
+            /// \brief Get the index of the cell at (col, row) of the grid within the tiles
+            ///
+            inline int tileIndex(const int col, const int row) const;
 
             ///
             /// \brief Convert (theta, phi) in radians to indices into BEDMAP2 data
@@ -185,13 +470,33 @@ namespace anita { namespace readers {
             inline std::pair<double, double> coordToBEDMAPLocation(const double theta, const double phi) const __attribute__((hot));
 
             ///
-            /// \brief Access value in `data` at x,y locations (in km) using bilinear interpolation
+            /// \brief Access value of `field` at x,y locations (in km) using bilinear interpolation
             ///
             /// Given two locations in BEDMAP coordinates (x,y in km), use bilinear interpolation on
-            /// the values of `data` and return the interpolated data value. Only valid on datasets
+            /// the values of `field` and return the interpolated data value. Only valid on datasets
             /// that are the full size of BEDMAP (i.e. not Vostok or uncertainty data products)
             ///
-            inline double interpData(const float *data, const double x, const double y) const;
+            inline double interpData(const Field field, const double x, const double y) const;
+
+            ///
+            /// \brief Find the four grid cells surrounding x,y (in km) in BEDMAP coordinates
+            ///
+            inline Cell locateCell(const double x, const double y) const __attribute__((hot));
+
+            ///
+            /// \brief Bilinearly interpolate `field` in a cell found by locateCell
+            ///
+            inline double interpCell(const Field field, const Cell& cell) const __attribute__((hot));
+
+            ///
+            /// \brief Interpolate every field in a cell found by locateCell for the point (x, y)
+            ///
+            inline BedmapPoint queryCell(const double x, const double y, const Cell& cell) const;
+
+            ///
+            /// \brief Convert an interpolated icemask value to an IceMask
+            ///
+            inline IceMask toIceMask(const double mask) const;
 
             ///
             /// \brief Interpolate a function f evaluated on the unit square
@@ -206,10 +511,80 @@ namespace anita { namespace readers {
             inline double interpIndex2D(const std::tuple<double, double, double, double> f,
                                         const std::pair<double, double> pos) const __attribute__((hot));
 
+        };
+
+        ///
+        /// \brief Walks a straight path across the Bedmap2 grid one cell at a time
+        ///
+        /// This is a DDA (digital differential analyzer) traversal: each call to next() returns the
+        /// segment of the path within the next cell that it crosses, in order, from the
+        /// distances to the next row and column boundaries alone. The four corners of each cell are
+        /// read once, and the two corners shared with the previous cell are reused rather than read
+        /// again, so a path costs two raster reads per field per cell and no projections at all.
+        ///
+        /// The profile at any point along a segment matches Bedmap::queryAtPoint at that point
+        /// (up to rounding). Distances are on the map; divide by the scale factor of the projection
+        /// (Bedmap::getScaleFactor) for distances on the ellipsoid.
+        ///
+        class BedmapWalker {
+
+        public:
+            ///
+            /// \brief Start a walk of `length` km from (x, y) (km) along (dx, dy) in Bedmap coordinates
+            ///
+            /// (x, y) must be on the grid, and (dx, dy) must be non-zero, but need not be normalized.
+            ///
+            BedmapWalker(const Bedmap& bedmap, const double x, const double y,
+                         const double dx, const double dy, const double length);
+
+            ///
+            /// \brief Fill in the next segment of the path, returning false once the path has ended
+            ///
+            bool next(BedmapSegment& segment);
+
+        private:
+
+            // the Bedmap that we are walking across
+            const Bedmap& bedmap;
+
+            // the start of the path and its unit direction in (fractional) columns and rows
+            const double xi;
+            const double yi;
+            double ux;
+            double uy;
+
+            // the total length of the path, and the distance to the start of the current cell
+            const double length;
+            double distance;
+
+            // the first corner of the current cell
+            int col;
+            int row;
+
+            // whether we have reached the end of the path
+            bool finished;
+
+            // the profile where the path enters the current cell
+            BedmapProfile entry;
+
+            // the values at the corners (0, 0), (1, 0), (0, 1), (1, 1) of the current cell
+            // for the surface, bed, thickness and geoid (in the order of Bedmap::Field)
+            double corners[4][4];
+
+            ///
+            /// \brief Read the values at `corner` of the current cell from the rasters
+            ///
+            void readCorner(const int corner);
+
+            ///
+            /// \brief Move to the neighbouring cell along columns (`dcol`) or rows (`drow`)
+            ///
+            void step(const int dcol, const int drow);
+
             ///
-            /// \brief Read a binary bedmap file located at `filename` and return a heap-allocated array
+            /// \brief Interpolate the profile at `s` km along the path within the current cell
             ///
-            float* readBedmapData(std::string filename) const;
+            BedmapProfile evaluate(const double s) const;
 
         };
 
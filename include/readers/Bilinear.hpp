@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+
+namespace anita { namespace readers {
+
+        ///
+        /// \brief The geometry of a square-celled raster in the Bedmap2 layout
+        ///
+        /// Rows are stored from the top of the map (y = -yllcorner) downwards and
+        /// the cells are 1 km on a side, as for every Bedmap2 raster.
+        ///
+        struct BilinearGrid {
+
+            int ncols; ///< the number of columns in the raster
+            int nrows; ///< the number of rows in the raster
+            double xllcorner; ///< x of the lower-left corner (km)
+            double yllcorner; ///< y of the lower-left corner (km)
+
+        };
+
+        ///
+        /// \brief Bilinearly interpolate `nrasters` rasters at `n` points (x, y) in km
+        ///
+        /// `out[r][i]` is set to the value of `rasters[r]` at (x[i], y[i]), using exactly the same
+        /// indexing and arithmetic as Bedmap::interpData so that the values are identical. The
+        /// cell indices are computed once per point and shared by every raster.
+        ///
+        /// This uses AVX-512 or AVX2 gathers when the CPU supports them, and a scalar
+        /// kernel otherwise. Every kernel gives bit-identical results.
+        ///
+        void interpolateBilinear(const BilinearGrid& grid, const std::size_t n, const double* x, const double* y,
+                                 const std::size_t nrasters, const float* const* rasters, double* const* out);
+
+        ///
+        /// \brief The portable (scalar) kernel used by interpolateBilinear without AVX2
+        ///
+        void interpolateBilinearScalar(const BilinearGrid& grid, const std::size_t n, const double* x, const double* y,
+                                       const std::size_t nrasters, const float* const* rasters, double* const* out);
+
+        ///
+        /// \brief The AVX2 kernel used by interpolateBilinear; the CPU must support AVX2
+        ///
+        void interpolateBilinearAVX2(const BilinearGrid& grid, const std::size_t n, const double* x, const double* y,
+                                     const std::size_t nrasters, const float* const* rasters, double* const* out);
+
+        ///
+        /// \brief The AVX-512 kernel used by interpolateBilinear; the CPU must support AVX-512F
+        ///
+        void interpolateBilinearAVX512(const BilinearGrid& grid, const std::size_t n, const double* x, const double* y,
+                                       const std::size_t nrasters, const float* const* rasters, double* const* out);
+
+    } // END: namespace readers
+} // END: namespace anita
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <utility>
+#include <ColumnarFormat.hpp>
+
+namespace anita { namespace readers {
+
+        ///
+        /// \brief Read the columns of a NuMC columnar file (see ColumnarFormat.hpp) in place
+        ///
+        /// The file is mapped into memory rather than read, so opening a file only reads its
+        /// header and footer. Chunks that were stored without any encoding are returned as spans
+        /// straight into the mapping, without a copy. Encoded chunks are decoded the first time
+        /// they are requested and kept for the lifetime of the reader.
+        ///
+        /// Spans remain valid for as long as the reader exists. Columns can be requested from
+        /// several threads at once.
+        ///
+        class ColumnarReader {
+
+        public:
+
+            ///
+            /// \brief Map the columnar file at `filename` and read its footer
+            ///
+            ColumnarReader(const std::string filename);
+
+            ///
+            /// \brief Unmap the file
+            ///
+            ~ColumnarReader();
+
+            // the mapping can't be shared between readers
+            ColumnarReader(const ColumnarReader&) = delete;
+            ColumnarReader& operator=(const ColumnarReader&) = delete;
+
+            ///
+            /// \brief Get the total number of rows (interactions) in the file
+            ///
+            std::size_t getNumRows() const { return static_cast<std::size_t>(this->footer.nrows); };
+
+            ///
+            /// \brief Get the total number of events in the file, including those without any interactions
+            ///
+            std::size_t getNumEvents() const { return static_cast<std::size_t>(this->footer.nevents); };
+
+            ///
+            /// \brief Get the number of row groups in the file
+            ///
+            std::size_t getNumRowGroups() const { return this->groups.size(); };
+
+            ///
+            /// \brief Get the number of rows in row group `group`
+            ///
+            std::size_t getNumRows(const std::size_t group) const;
+
+            ///
+            /// \brief Get the names of every column in the file
+            ///
+            std::vector<std::string> getColumns() const;
+
+            ///
+            /// \brief Get the git commit of the code that wrote the file
+            ///
+            std::string getCommit() const;
+
+            ///
+            /// \brief Get the hash of the source of the code that wrote the file
+            ///
+            std::string getHash() const;
+
+            ///
+            /// \brief Get whether the chunk of `column` in row group `group` can be used without decoding
+            ///
+            bool isMapped(const std::string column, const std::size_t group) const;
+
+            ///
+            /// \brief Get the values of `column` in row group `group`
+            ///
+            /// T must be the type that the column was written with (std::int32_t, std::uint8_t or double).
+            ///
+            template <typename T>
+            columnar::Span<T> getColumn(const std::string column, const std::size_t group) const {
+                const std::pair<const unsigned char*, std::size_t> chunk = this->getChunk(column, group, columnar::TypeOf<T>::value);
+                return columnar::Span<T>{ reinterpret_cast<const T*>(chunk.first), chunk.second };
+            }
+
+        private:
+
+            // the mapped file and its size
+            const unsigned char* data;
+            std::size_t size;
+
+            // the header and footer of the file
+            columnar::FileHeader header;
+            columnar::FooterHeader footer;
+            std::vector<columnar::ColumnInfo> columns;
+            std::vector<columnar::RowGroupInfo> groups;
+            std::vector<columnar::ChunkInfo> chunks;
+
+            // the decoded chunks, by column and row group
+            mutable std::mutex lock;
+            mutable std::map<std::pair<std::size_t, std::size_t>, std::vector<unsigned char>> decoded;
+
+            ///
+            /// \brief Get the index of `column`
+            ///
+            std::size_t findColumn(const std::string column) const;
+
+            ///
+            /// \brief Get the (decoded) values and the number of values of a chunk
+            ///
+            std::pair<const unsigned char*, std::size_t> getChunk(const std::string column, const std::size_t group,
+                                                                  const columnar::Type type) const;
+
+            ///
+            /// \brief Read `count` structures of T from the file at `offset`, checking that they are in the file
+            ///
+            template <typename T>
+            void read(T* values, const std::uint64_t offset, const std::size_t count) const;
+
+        };
+
+    } // END: namespace readers
+} // END: namespace anita
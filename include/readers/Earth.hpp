@@ -1,6 +1,8 @@
 #pragma once
 
 #include <map>
+#include <vector>
+#include <string>
 #include <Math/Interpolator.h>
 
 namespace anita { namespace readers {
@@ -30,6 +32,19 @@ namespace anita { namespace readers {
             ///
             double getDensity(const double r) const;
 
+            ///
+            /// \brief Get the radii (in km) of the PREM file in increasing order
+            ///
+            /// The density is linear in radius between consecutive radii. Discontinuities
+            /// in density appear as a radius that is repeated with both densities.
+            ///
+            const std::vector<double>& getRadii() const { return this->data.first; };
+
+            ///
+            /// \brief Get the density (in g/cm^3) at each radius of getRadii()
+            ///
+            const std::vector<double>& getDensities() const { return this->data.second; };
+
             ///
             /// \brief The maximum radius (in km) that this model is valid
             ///
@@ -1,12 +1,19 @@
 #pragma once
 
 #include <map>
+#include <string>
+#include <vector>
+#include <math.h>
 #include <boost/range.hpp>
 #include <Math/Interpolator.h>
 
 
 namespace anita { namespace readers {
 
+        // the name of a reference E^-1 flux that is flat in log10 eV. Events generated
+        // from it can be reweighted to any other flux model (see Reweighter)
+        const std::string REFERENCE_FLUX = "reference";
+
         class Flux {
 
         public:
@@ -16,7 +23,9 @@ namespace anita { namespace readers {
             // the first line contains the number of energy entries
             // the first column is log10 eV, the second column
             // is E^2 dNdE in eV cm^-2 s^-1 sr^-1
-            // this enables sharing of flux files with IceMC
+            // this enables sharing of flux files with IceMC.
+            // if filename is REFERENCE_FLUX, no file is read and the flux
+            // is flat in log10 eV over the whole range of Particle energies
             Flux(const std::string filename);
             ~Flux() { delete this->spline; };
 
@@ -28,11 +37,43 @@ namespace anita { namespace readers {
             double min_flux;
             double max_flux;
 
-            // returns the flux at a given energy
+            // returns the flux at a given energy. The ROOT spline caches the last interval
+            // that it looked up, so this must not be called from many threads at once
             double getFlux(const double energy) const {
                 return this->spline->Eval(energy);
             };
 
+            // returns the fraction of the neutrinos in the flux below a given energy.
+            // the flux is log10(E dN/dE) so neutrinos are distributed in log10 eV
+            // in proportion to 10^getFlux(E)
+            double getCDF(const double energy) const;
+
+            // returns the energy below which a given fraction of the neutrinos in the flux lie.
+            // this is the exact inverse of getCDF (a binary search of the same table and the
+            // same linear interpolation) so that a uniform fraction samples an energy from the
+            // flux without any rejection
+            double getInverseCDF(const double fraction) const;
+
+            // returns the derivative of getCDF (per log10 eV) at a given energy. getCDF is
+            // piecewise linear, so this is the slope of the interval containing the energy
+            // and is zero outside of the flux file
+            double getCDFSlope(const double energy) const;
+
+            // returns the number of neutrinos per unit log10 eV at a given energy
+            // i.e. ln(10) E dN/dE in cm^-2 s^-1 sr^-1, and zero outside of the flux file.
+            // this interpolates the flux tabulated with the CDF rather than the spline,
+            // so that it can be called from many threads at once
+            double getDensity(const double energy) const;
+
+            // returns the number of neutrinos between two energies in cm^-2 s^-1 sr^-1
+            // i.e. the integral of getDensity over log10 eV
+            double getIntegral(const double minE, const double maxE) const {
+                return this->integral*(this->getCDF(maxE) - this->getCDF(minE));
+            };
+
+            // returns the names of all the flux models in data/fluxes
+            static std::vector<std::string> getModels();
+
 
         private:
             // map from energy to flux
@@ -42,6 +83,21 @@ namespace anita { namespace readers {
             // cubic spline from energy to flux
             ROOT::Math::Interpolator* spline;
 
+            // the cumulative fraction of neutrinos at evenly spaced energies
+            std::vector<double> cdf;
+
+            // the flux at the same energies as the CDF
+            std::vector<double> values;
+
+            // the number of neutrinos over the whole flux file
+            double integral;
+
+            // read the energies and fluxes from a file in data/fluxes
+            void readFile(const std::string filename);
+
+            // build the tables of the flux and the CDF from the spline
+            void buildCDF();
+
         };
 
     } // END: namespace readers
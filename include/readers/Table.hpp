@@ -1,6 +1,11 @@
 #pragma once
 
+#include <map>
+#include <mutex>
+#include <memory>
 #include <string>
+#include <vector>
+#include <future>
 #include <fstream>
 
 #include <NuMC.hpp>
@@ -56,10 +61,19 @@ namespace anita { namespace readers {
         // the only thing we need to do is free the table data
         ~YTable() { delete[] this->data; };
 
+        // YTables own their data and are large, so they should be shared
+        // through the TableRegistry rather than copied
+        YTable(const YTable&) = delete;
+        YTable& operator=(const YTable&) = delete;
+
         // evaluate the YTable data at a given energy
         // energy in log10 eV
         std::vector<double> evaluate(const double energy) const;
 
+        // evaluate a single dimension of the YTable data at a given energy
+        // without allocating. This draws the same random final state as evaluate
+        double evaluate(const double energy, const int dim) const;
+
     private:
         int       imax;      // number of steps in energy
         int       nfinal;    // number of final states per energy
@@ -71,7 +85,38 @@ namespace anita { namespace readers {
         // read the data table from the file and initialize the table parameters
         void readYTableFromFile(std::string filename);
 
+        // pick a random final state at a given energy and return a pointer to its ndim values
+        const double* sample(const double energy) const;
+
     }; // END: class YTable
 
+
+    // This class is a process-wide cache of immutable YTables. Each data file
+    // is parsed at most once per process, and every caller (on any thread) shares
+    // a const reference to the same table. Tables live until the process exits.
+    class TableRegistry {
+
+    public:
+        // Get the YTable stored in `filename` (relative to DATA_DIR), loading it
+        // if this is the first request. Concurrent requests for the same file
+        // wait for a single load.
+        static const YTable& getYTable(const std::string& filename);
+
+        // Start loading each of `filenames` (relative to DATA_DIR) on its own thread
+        // and return immediately. Later calls to getYTable wait for these loads.
+        static void preload(const std::vector<std::string>& filenames);
+
+        // Start loading all of the final state and decay tables used during propagation.
+        static void preload();
+
+    private:
+        // a handle to a table that is loaded, or being loaded
+        using Entry = std::shared_future<std::shared_ptr<const YTable>>;
+
+        // find the entry for `filename`, creating it with `policy` if it doesn't exist
+        static Entry getEntry(const std::string& filename, const std::launch policy);
+
+    }; // END: class TableRegistry
+
     } // END: namespace readers
 } // END: namespace anita
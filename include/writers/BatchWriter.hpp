@@ -0,0 +1,126 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <condition_variable>
+#include <InteractionSink.hpp>
+#include <InteractionBuffer.hpp>
+
+namespace anita { namespace writers {
+
+        ///
+        /// \brief A sink that hands batches of events to a background I/O thread
+        ///
+        /// Every worker collects its events into its own InteractionBuffer, and once a buffer holds
+        /// `batch_size` events it is pushed onto a bounded queue. A dedicated I/O thread pops batches
+        /// from the queue and passes them to write(), so the propagating threads never wait on
+        /// compression or the disk - only on the queue, if the writer falls more than `queue_size`
+        /// batches behind.
+        ///
+        /// Batches are written in the order that they arrive, which is not the order of the event
+        /// indices when propagating with more than one thread.
+        ///
+        /// Derived classes must call stop() in their destructor, before anything that write() uses
+        /// is destroyed.
+        ///
+        class BatchWriter : public InteractionSink {
+
+        public:
+
+            ///
+            /// \brief Hand events to the I/O thread in batches of `batch_size` with at most `queue_size` batches waiting
+            ///
+            BatchWriter(const std::size_t batch_size, const std::size_t queue_size);
+
+            ///
+            /// \brief Create a buffer for each worker and start the I/O thread
+            ///
+            void begin(const unsigned int nworkers) override;
+
+            ///
+            /// \brief Add the interactions of `event` to the buffer of `worker`
+            ///
+            void consume(const unsigned int worker, const int event, InteractionList& interactions) override;
+
+            ///
+            /// \brief Write the remaining batches, wait for the I/O thread, and close the output
+            ///
+            void finish() override;
+
+            ///
+            /// \brief Every worker has its own buffer, so events can be consumed concurrently
+            ///
+            bool isConcurrent() const override { return true; };
+
+            ///
+            /// \brief Get the number of events written so far
+            ///
+            long getNumEvents() const;
+
+            ///
+            /// \brief Stop the I/O thread
+            ///
+            virtual ~BatchWriter();
+
+        protected:
+
+            ///
+            /// \brief Write every event in `batch`, returning whether it succeeded
+            ///
+            /// This is only ever called from the I/O thread.
+            ///
+            virtual bool write(const InteractionBuffer& batch) = 0;
+
+            ///
+            /// \brief Close the output once every batch of the `total` events has been written
+            ///
+            /// This is called from finish(), after the I/O thread has stopped.
+            ///
+            virtual void close(const long total) = 0;
+
+            ///
+            /// \brief Close the queue and wait for the I/O thread to write the batches already on it
+            ///
+            void stop();
+
+        private:
+
+            // the number of events per batch, and the maximum number of batches waiting
+            const std::size_t batch_size;
+            const std::size_t queue_size;
+
+            // the buffer that each worker is collecting events into
+            std::vector<InteractionBuffer> buffers;
+
+            // the batches waiting to be written, and the number of events written so far
+            std::deque<InteractionBuffer> queue;
+            bool closed;
+            long nevents;
+
+            // whether any batch failed to be written
+            bool failed;
+
+            // protects the queue - workers wait on `space` and the I/O thread waits on `ready`
+            mutable std::mutex lock;
+            std::condition_variable space;
+            std::condition_variable ready;
+
+            // the I/O thread
+            std::thread thread;
+
+            ///
+            /// \brief Push a full batch onto the queue, waiting for space if necessary
+            ///
+            void push(InteractionBuffer& batch);
+
+            ///
+            /// \brief Pop batches from the queue and write them until the queue is closed
+            ///
+            void run();
+
+        };
+
+    } // END: namespace writers
+} // END: namespace anita
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <ColumnarFormat.hpp>
+#include <writers/BatchWriter.hpp>
+
+namespace anita { namespace writers {
+
+        ///
+        /// \brief The options for writing interactions to a columnar file
+        ///
+        struct ColumnarOptions {
+
+            bool delta = true; ///< Whether to delta encode the integer columns
+            int compression_level = 1; ///< The zlib compression level of every chunk from 0 (no compression) to 9
+            std::size_t batch_size = 65536; ///< The number of events in every row group
+            std::size_t queue_size = 4; ///< The maximum number of row groups waiting to be written
+
+        };
+
+        ///
+        /// \brief A sink that writes the interactions of every event to a NuMC columnar file
+        ///
+        /// Every batch of BatchWriter is written as one row group of the format described in
+        /// ColumnarFormat.hpp, on the I/O thread. Chunks are only deflated if that makes them
+        /// smaller, so columns that don't compress (i.e. most of the doubles) can still be used in
+        /// place by readers::ColumnarReader.
+        ///
+        /// The file is written under a temporary name and only renamed to `filename` once its footer
+        /// is complete, so a reader never sees a partially written file.
+        ///
+        class ColumnarWriter : public BatchWriter {
+
+        public:
+
+            ///
+            /// \brief Create a new columnar file at `filename` to write interactions to
+            ///
+            ColumnarWriter(const std::string filename, const ColumnarOptions options = ColumnarOptions());
+
+            ///
+            /// \brief Stop the I/O thread and remove the unfinished file if finish() was never called
+            ///
+            ~ColumnarWriter();
+
+        protected:
+
+            ///
+            /// \brief Write every interaction in `batch` as a row group
+            ///
+            bool write(const InteractionBuffer& batch) override;
+
+            ///
+            /// \brief Write the footer and move the file into place
+            ///
+            void close(const long total) override;
+
+        private:
+
+            // the options of this writer
+            const ColumnarOptions options;
+
+            // the final and temporary names of the file
+            const std::string filename;
+            const std::string temporary;
+
+            // the file being written, and the number of bytes written to it
+            FILE* file;
+            std::uint64_t position;
+
+            // the size of every row group and the location of every chunk so far
+            std::vector<columnar::RowGroupInfo> groups;
+            std::vector<columnar::ChunkInfo> chunks;
+
+            // scratch space for the event of every row, and for encoding chunks
+            std::vector<std::int32_t> rows;
+            std::vector<unsigned char> raw;
+            std::vector<unsigned char> compressed;
+
+            ///
+            /// \brief Encode and write one chunk of `nrows` values of `type` at `values`
+            ///
+            bool writeChunk(const void* values, const std::size_t nrows, const columnar::Type type);
+
+            ///
+            /// \brief Write `size` bytes, returning whether it succeeded
+            ///
+            bool writeBytes(const void* bytes, const std::size_t size);
+
+        };
+
+    } // END: namespace writers
+} // END: namespace anita
@@ -1,16 +1,91 @@
 #pragma once
 
+#include <memory>
+#include <string>
+#include <writers/BatchWriter.hpp>
+
+// forward declarations so that ROOT stays out of this header
+class TFile;
+class TTree;
+
 namespace anita { namespace writers {
 
         ///
-        /// \brief A class that wraps writing InteractionLists, and maps of InteractionsLists to a ROOT TFile
+        /// \brief The options for writing interactions to a ROOT file
+        ///
+        struct WriterOptions {
+
+            int compression_algorithm = 4; ///< The ROOT compression algorithm (ROOT::ECompressionAlgorithm, 4 is LZ4)
+            int compression_level = 4; ///< The compression level from 0 (none) to 9
+            int basket_size = 64000; ///< The size (bytes) of the basket of every branch
+            std::size_t batch_size = 1024; ///< The number of events each worker collects before handing them to the writer
+            std::size_t queue_size = 16; ///< The maximum number of batches waiting to be written
+
+        };
+
+        ///
+        /// \brief A sink that writes the interactions of every event to a TTree in a ROOT file
+        ///
+        /// The tree is filled on the I/O thread of BatchWriter, so the propagating threads never wait
+        /// on ROOT's compression. It has one entry per interaction, with a branch for every column of
+        /// InteractionBuffer. The number of events (including those without any interactions), and
+        /// the SOURCE_HASH and GIT_COMMIT of the code that produced the file (see Version.hpp), are saved alongside the tree.
         ///
-        class InteractionWriter {
+        class InteractionWriter : public BatchWriter {
 
         public:
 
+            ///
+            /// \brief Create a new ROOT file at `filename` to write interactions to
+            ///
+            InteractionWriter(const std::string filename, const WriterOptions options = WriterOptions());
+
+            ///
+            /// \brief Stop the I/O thread and close the file if finish() was never called
+            ///
+            /// The batches already on the queue are written, but events still in the buffers of the
+            /// workers (i.e. if propagation was interrupted) are lost.
+            ///
+            ~InteractionWriter();
+
+        protected:
+
+            ///
+            /// \brief Fill the tree with every interaction in `batch`
+            ///
+            bool write(const InteractionBuffer& batch) override;
+
+            ///
+            /// \brief Write the tree and the metadata and close the file
+            ///
+            void close(const long total) override;
+
         private:
 
-        }
-    }
-}
+            // the output file and the tree of interactions in it
+            std::unique_ptr<TFile> file;
+            TTree* tree;
+
+            // the values of every branch for the current entry
+            struct Entry {
+                int event;
+                int trials;
+                unsigned char flavor;
+                unsigned char neutrino;
+                double energy;
+                double theta;
+                double phi;
+                double r;
+                double direction_theta;
+                double direction_phi;
+                double direction_r;
+                unsigned char current;
+                double distance;
+                double weight;
+            };
+            Entry entry;
+
+        };
+
+    } // END: namespace writers
+} // END: namespace anita
@@ -0,0 +1,228 @@
+#include <math.h>
+#include <iostream>
+#include <algorithm>
+#include <Constants.hpp>
+#include <Acceptance.hpp>
+#include <ParticleState.hpp>
+
+using namespace anita;
+
+// the number of flavors and currents
+static constexpr std::size_t NFLAVORS = 3;
+static constexpr std::size_t NCURRENTS = 2;
+
+// BEDMAP2 covers everything below -60 degrees latitude (the cap of SurfaceSampler)
+static constexpr double BEDMAP_THETA = 5*PI/6;
+
+
+Acceptance::Acceptance(const Propagator& propagator, const Continent& con,
+                       const std::size_t nenergies, const double maxdepth, const std::size_t ndepths)
+    : continent(con), generation(propagator.getGenerationAcceptance()), width(1.),
+      min_energy(propagator.getFixedEnergy() > 0 ? propagator.getFixedEnergy() : propagator.getMinEnergy()),
+      max_energy(propagator.getFixedEnergy() > 0 ? propagator.getFixedEnergy() : propagator.getMaxEnergy()),
+      nenergy(propagator.getFixedEnergy() > 0 ? 1 : nenergies), max_depth(maxdepth), ndepth(ndepths), nworkers(0) {
+
+    // we need at least one bin in each dimension
+    if ((nenergies == 0) || (ndepths == 0) || !(maxdepth > 0)) {
+        std::cerr << "The acceptance needs at least one energy and depth bin. Quitting..." << std::endl;
+        throw std::exception();
+    }
+
+    // the generation weights are the inverse of a density in log10 E, so the
+    // sum in each energy bin is divided by its width - unless the energy is fixed
+    if (this->max_energy > this->min_energy)
+        this->width = (this->max_energy - this->min_energy)/static_cast<double>(this->nenergy);
+
+    const std::size_t nbins = this->nenergy*NFLAVORS*NCURRENTS*this->ndepth;
+    this->total.nevents = 0;
+    this->total.weights.assign(nbins, 0.);
+    this->total.squares.assign(nbins, 0.);
+    this->total.energies.assign(this->nenergy, 0.);
+}
+
+
+std::size_t Acceptance::getBin(const std::size_t energy, const Flavor flavor, const Current current, const std::size_t depth) const {
+
+    if ((energy >= this->nenergy) || (depth >= this->ndepth)) {
+        std::cerr << "There is no acceptance bin (" << energy << ", " << depth << "). Quitting..." << std::endl;
+        throw std::exception();
+    }
+
+    return ((energy*NFLAVORS + static_cast<std::size_t>(flavor))*NCURRENTS + static_cast<std::size_t>(current))*this->ndepth + depth;
+}
+
+
+void Acceptance::begin(const unsigned int workers) {
+
+    // a fresh histogram for every worker, each on its own cache line(s)
+    this->nworkers = workers;
+    this->histograms = utils::makeAligned<WorkerHistogram>(workers);
+    for (unsigned int i = 0; i < workers; i++) {
+        Histogram& histogram = this->histograms[i];
+        histogram.nevents = 0;
+        histogram.weights.assign(this->total.weights.size(), 0.);
+        histogram.squares.assign(this->total.squares.size(), 0.);
+        histogram.energies.assign(this->total.energies.size(), 0.);
+    }
+
+}
+
+
+void Acceptance::consume(const unsigned int worker, const int event, InteractionList& interactions) {
+
+    // every neutrino shares the generation acceptance
+    if (worker >= this->nworkers) {
+        std::cerr << "There is no acceptance histogram for worker " << worker << ". Quitting..." << std::endl;
+        throw std::exception();
+    }
+    Histogram& histogram = this->histograms[worker];
+    histogram.nevents++;
+
+    // but events without any interactions don't contribute
+    if (interactions.empty()) return;
+
+    // the first interaction is at the energy the neutrino was generated with
+    const double energy = interactions.front().particle.energy;
+    const double fraction = this->max_energy > this->min_energy ?
+        (energy - this->min_energy)/(this->max_energy - this->min_energy) : 0.;
+    if ((fraction < 0) || (fraction > 1)) return;
+    const std::size_t ebin = std::min(static_cast<std::size_t>(fraction*static_cast<double>(this->nenergy)), this->nenergy - 1);
+
+    // the sum of the weights of this event in each bin it touches, and in its energy bin
+    histogram.event.clear();
+    double sum = 0;
+
+    // and we only touch the histogram of this worker
+    for (const Interaction& interaction : interactions) {
+
+        // the surface above the interaction, which is sea level outside of BEDMAP2
+        const SphericalCoordinate& location = interaction.location;
+        const double surface = location.theta > BEDMAP_THETA ? this->continent.getSurfaceRadius(location.theta, location.phi)
+                                                             : this->continent.getEarthRadius(location.theta);
+
+        // and the depth below it, where the atmosphere counts as the surface
+        const double depth = std::max(surface - location.r, 0.);
+        if (depth >= this->max_depth) continue;
+        const std::size_t dbin = static_cast<std::size_t>(depth/this->max_depth*static_cast<double>(this->ndepth));
+
+        const std::size_t bin = this->getBin(ebin, interaction.particle.flavor, interaction.current, std::min(dbin, this->ndepth - 1));
+        histogram.weights[bin] += interaction.weight;
+        sum += interaction.weight;
+
+        // an event only has a few interactions, so we search them directly
+        auto same = [bin](const std::pair<std::size_t, double>& entry) { return entry.first == bin; };
+        const auto entry = std::find_if(histogram.event.begin(), histogram.event.end(), same);
+        if (entry != histogram.event.end())
+            entry->second += interaction.weight;
+        else
+            histogram.event.emplace_back(bin, interaction.weight);
+    }
+
+    // the event is a single sample, so we add the square of its total in every bin
+    for (const std::pair<std::size_t, double>& entry : histogram.event)
+        histogram.squares[entry.first] += entry.second*entry.second;
+    histogram.energies[ebin] += sum*sum;
+
+}
+
+
+void Acceptance::finish() {
+
+    // every worker has finished, so there is nothing left to lock
+    for (unsigned int worker = 0; worker < this->nworkers; worker++) {
+        const Histogram& histogram = this->histograms[worker];
+        this->total.nevents += histogram.nevents;
+        for (std::size_t i = 0; i < this->total.weights.size(); i++) {
+            this->total.weights[i] += histogram.weights[i];
+            this->total.squares[i] += histogram.squares[i];
+        }
+        for (std::size_t i = 0; i < this->total.energies.size(); i++)
+            this->total.energies[i] += histogram.energies[i];
+    }
+    this->histograms.reset();
+    this->nworkers = 0;
+
+}
+
+
+double Acceptance::getEnergy(const std::size_t bin) const {
+    return this->min_energy + (static_cast<double>(bin) + 0.5)*(this->max_energy - this->min_energy)/static_cast<double>(this->nenergy);
+}
+
+
+double Acceptance::getDepth(const std::size_t bin) const {
+    return (static_cast<double>(bin) + 0.5)*this->max_depth/static_cast<double>(this->ndepth);
+}
+
+
+double Acceptance::getNormalization() const {
+    return this->total.nevents > 0 ? this->generation/(static_cast<double>(this->total.nevents)*this->width) : 0.;
+}
+
+
+double Acceptance::getAcceptance(const std::size_t energy, const Flavor flavor, const Current current, const std::size_t depth) const {
+    return this->getNormalization()*this->total.weights[this->getBin(energy, flavor, current, depth)];
+}
+
+
+double Acceptance::getError(const std::size_t energy, const Flavor flavor, const Current current, const std::size_t depth) const {
+    return this->getNormalization()*sqrt(this->total.squares[this->getBin(energy, flavor, current, depth)]);
+}
+
+
+double Acceptance::getAcceptance(const std::size_t energy, const Flavor flavor, const Current current) const {
+
+    double acceptance = 0;
+    for (std::size_t depth = 0; depth < this->ndepth; depth++)
+        acceptance += this->getAcceptance(energy, flavor, current, depth);
+
+    return acceptance;
+}
+
+
+// the sums over every flavor, current and depth
+double Acceptance::getAcceptance(const std::size_t energy) const {
+
+    const std::size_t first = this->getBin(energy, Flavor::Electron, Current::Charged, 0);
+    const std::size_t nbins = NFLAVORS*NCURRENTS*this->ndepth;
+
+    double weights = 0;
+    for (std::size_t i = first; i < first + nbins; i++)
+        weights += this->total.weights[i];
+
+    return this->getNormalization()*weights;
+}
+
+
+// the interactions of an event in different bins are correlated, so we use the squares of each event's total
+double Acceptance::getError(const std::size_t energy) const {
+
+    if (energy >= this->nenergy) {
+        std::cerr << "There is no acceptance energy bin " << energy << ". Quitting..." << std::endl;
+        throw std::exception();
+    }
+
+    return this->getNormalization()*sqrt(this->total.energies[energy]);
+}
+
+
+bool Acceptance::isConverged(const double precision) const {
+
+    for (std::size_t energy = 0; energy < this->nenergy; energy++) {
+        const double acceptance = this->getAcceptance(energy);
+        if (!(acceptance > 0) || (this->getError(energy) > precision*acceptance))
+            return false;
+    }
+
+    return true;
+}
+
+
+double Acceptance::getVolume(const std::size_t energy, const Flavor flavor, const Current current) const {
+
+    // the interaction length in ice of a neutrino at the center of the bin
+    const ParticleState neutrino{flavor, true, this->getEnergy(energy)};
+    const double length = getInteractionLength(neutrino, getMaterialDensity(Material::Ice)).first;
+
+    return this->getAcceptance(energy, flavor, current)*length;
+}
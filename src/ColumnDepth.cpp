@@ -0,0 +1,212 @@
+#include <math.h>
+#include <limits>
+#include <iostream>
+#include <algorithm>
+#include <Constants.hpp>
+#include <ColumnDepth.hpp>
+
+using namespace anita;
+
+// the precision (km) to which getDistance inverts the column depth
+static constexpr double TOLERANCE = 1e-9;
+
+
+// split the chord at every PREM radius and integrate along it
+ColumnDepth::ColumnDepth(const readers::Earth& earth, const Vector3<double>& origin,
+                         const Vector3<double>& direction, const double len)
+    : length(len), closest(-(origin*direction)), impact2(0), total(0) {
+
+    // we need a chord to integrate along
+    if (!(len > 0)) {
+        std::cerr << "Cannot integrate along a chord of length " << len << " km. Quitting..." << std::endl;
+        throw std::exception();
+    }
+
+    // this can be very slightly negative from rounding for chords through the center
+    this->impact2 = std::max(0., origin.sqrMag() - this->closest*this->closest);
+
+    // the radii of PREM in increasing order, and the density at each
+    const std::vector<double>& radii = earth.getRadii();
+    const std::vector<double>& densities = earth.getDensities();
+
+    // the chord crosses each radius (at most) twice, symmetrically about the closest approach
+    std::vector<double> boundaries = { 0., this->length };
+    for (const double r : radii) {
+        const double half2 = r*r - this->impact2;
+        if (half2 <= 0) continue;
+        for (const double s : { this->closest - sqrt(half2), this->closest + sqrt(half2) }) {
+            if ((s > 0) && (s < this->length)) boundaries.push_back(s);
+        }
+    }
+    std::sort(boundaries.begin(), boundaries.end());
+    boundaries.erase(std::unique(boundaries.begin(), boundaries.end()), boundaries.end());
+
+    // the density is linear in radius between each pair of radii, and discontinuities
+    // are repeated radii, so we use the interval that contains the middle of each piece
+    this->pieces.reserve(boundaries.size() - 1);
+    for (std::size_t i = 0; i + 1 < boundaries.size(); i++) {
+
+        Piece piece;
+        piece.start = boundaries[i];
+        piece.depth = 0;
+        piece.a = 0;
+        piece.b = 0;
+
+        // outside of the outermost radius there is nothing
+        const double r = this->getRadius(0.5*(boundaries[i] + boundaries[i + 1]));
+        const std::size_t upper = static_cast<std::size_t>(std::upper_bound(radii.begin(), radii.end(), r) - radii.begin());
+        if ((upper > 0) && (upper < radii.size())) {
+            const std::size_t lower = upper - 1;
+            piece.b = (densities[upper] - densities[lower])/(radii[upper] - radii[lower]);
+            piece.a = densities[lower] - piece.b*radii[lower];
+        }
+
+        this->pieces.push_back(piece);
+    }
+
+    // and sum up the column depth
+    this->accumulate();
+}
+
+
+// get the radius at s
+double ColumnDepth::getRadius(const double s) const {
+    const double t = s - this->closest;
+    return sqrt(this->impact2 + t*t);
+}
+
+
+// the antiderivative of a + b*r(s) with respect to s
+double ColumnDepth::integrate(const Piece& piece, const double s) const {
+
+    const double t = s - this->closest;
+
+    // p^2 asinh(t/p) vanishes as p goes to zero
+    const double arc = this->impact2 > 0 ? this->impact2*asinh(t/sqrt(this->impact2)) : 0.;
+
+    return piece.a*t + 0.5*piece.b*(t*this->getRadius(s) + arc);
+}
+
+
+// find the piece that contains s
+std::size_t ColumnDepth::findPiece(const double s) const {
+
+    // the first piece that starts after s
+    const std::size_t after = static_cast<std::size_t>(
+        std::upper_bound(this->pieces.begin(), this->pieces.end(), s,
+                         [](const double value, const Piece& piece) { return value < piece.start; })
+        - this->pieces.begin());
+
+    return after > 0 ? after - 1 : 0;
+}
+
+
+// recompute the column depth at the start of every piece
+void ColumnDepth::accumulate() {
+
+    double depth = 0;
+    for (std::size_t i = 0; i < this->pieces.size(); i++) {
+        Piece& piece = this->pieces[i];
+        const double end = i + 1 < this->pieces.size() ? this->pieces[i + 1].start : this->length;
+
+        piece.depth = depth;
+        depth += CM_PER_KM*(this->integrate(piece, end) - this->integrate(piece, piece.start));
+    }
+
+    this->total = depth;
+}
+
+
+// overwrite the density along part of the chord
+void ColumnDepth::setDensity(const double start, const double end, const double density) {
+
+    const double a = std::max(start, 0.);
+    const double b = std::min(end, this->length);
+    if (!(b > a))
+        return;
+
+    // make sure that pieces start at both a and b
+    for (const double s : { a, b }) {
+        if (s >= this->length) continue;
+        const std::size_t i = this->findPiece(s);
+        if (this->pieces[i].start == s) continue;
+        Piece piece = this->pieces[i];
+        piece.start = s;
+        this->pieces.insert(this->pieces.begin() + static_cast<std::ptrdiff_t>(i + 1), piece);
+    }
+
+    // so that the pieces from a up to b can be replaced by a single piece
+    const std::size_t first = this->findPiece(a);
+    const std::size_t last = b < this->length ? this->findPiece(b) : this->pieces.size();
+    this->pieces.erase(this->pieces.begin() + static_cast<std::ptrdiff_t>(first + 1),
+                       this->pieces.begin() + static_cast<std::ptrdiff_t>(last));
+    this->pieces[first].a = density;
+    this->pieces[first].b = 0;
+
+    this->accumulate();
+}
+
+
+// the density at s
+double ColumnDepth::getDensity(const double s) const {
+
+    const Piece& piece = this->pieces[this->findPiece(s)];
+    return piece.a + piece.b*this->getRadius(s);
+}
+
+
+// the column depth from the start of the chord to s
+double ColumnDepth::getColumnDepth(const double s) const {
+
+    const double distance = std::min(std::max(s, 0.), this->length);
+    const Piece& piece = this->pieces[this->findPiece(distance)];
+
+    return piece.depth + CM_PER_KM*(this->integrate(piece, distance) - this->integrate(piece, piece.start));
+}
+
+
+// the distance at which the column depth reaches `depth`
+double ColumnDepth::getDistance(const double depth) const {
+
+    if (depth > this->total)
+        return std::numeric_limits<double>::infinity();
+    if (depth <= 0)
+        return 0;
+
+    // the piece whose column depth at the start is below `depth` and at the end is at least `depth`
+    const std::size_t after = static_cast<std::size_t>(
+        std::lower_bound(this->pieces.begin(), this->pieces.end(), depth,
+                         [](const Piece& piece, const double value) { return piece.depth < value; })
+        - this->pieces.begin());
+    const std::size_t i = after - 1;
+    const Piece& piece = this->pieces[i];
+    const double end = after < this->pieces.size() ? this->pieces[after].start : this->length;
+    const double enddepth = after < this->pieces.size() ? this->pieces[after].depth : this->total;
+
+    // we need the antiderivative to reach this value
+    const double target = this->integrate(piece, piece.start) + (depth - piece.depth)/CM_PER_KM;
+
+    // the density barely changes along a piece, so interpolating linearly is already
+    // very close, and Newton's method (kept within the piece) converges in a few steps
+    double lower = piece.start;
+    double upper = end;
+    double s = piece.start + (end - piece.start)*(depth - piece.depth)/(enddepth - piece.depth);
+    for (int iteration = 0; iteration < 50; iteration++) {
+
+        const double g = this->integrate(piece, s) - target;
+        if (g > 0) upper = s;
+        else lower = s;
+
+        // fall back to bisection if Newton's method leaves the bracket
+        double next = s - g/(piece.a + piece.b*this->getRadius(s));
+        if (!((next > lower) && (next < upper)))
+            next = 0.5*(lower + upper);
+
+        const bool converged = fabs(next - s) < TOLERANCE;
+        s = next;
+        if (converged)
+            break;
+    }
+
+    return s;
+}
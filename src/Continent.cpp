@@ -1,19 +1,122 @@
 #include <math.h>
+#include <vector>
+#include <iostream>
+#include <algorithm>
 #include <Continent.hpp>
+#include <SurfaceSampler.hpp>
+#include <ElevationPyramid.hpp>
 #include <readers/Bedmap.hpp>
 
 using namespace anita;
 
+// the ice sampler takes a few seconds to build, so every Continent
+// shares a single sampler that is built on first use
+static const SurfaceSampler& getSurfaceSampler(const readers::Bedmap& bedmap) {
+    static const SurfaceSampler sampler(bedmap);
+    return sampler;
+}
+
+// likewise for the elevation pyramid used to intersect rays with the surface and bed
+static const ElevationPyramid& getElevationPyramid(const readers::Bedmap& bedmap) {
+    static const ElevationPyramid pyramid(bedmap);
+    return pyramid;
+}
+
 SphericalCoordinate Continent::getRandomSurfacePoint() const {
 
-    // we start with the randomly picked surface point above 60 degrees w.r.t south pole
-    // 3D sphere point picking:  http://mathworld.wolfram.com/SpherePointPicking.html
-    // we only want values between -60 and -90
-    double theta = acos(-uniform(sqrt(3.)/2., 1));
-    double phi = 2*PI*uniform(0, 1);
-    double r = this->getSurfaceElevation(theta, phi);
-    return SphericalCoordinate(theta, phi, 0);
+    // we pick a random point on the ice, uniform in area
+    const std::pair<double, double> point = getSurfaceSampler(this->bedmap).sample();
+    return SphericalCoordinate(point.first, point.second, 0);
+
+}
+
+double Continent::getSurfaceAcceptance() const {
+    return getSurfaceSampler(this->bedmap).getAcceptance();
+}
+
+double Continent::getIceArea() const {
+    return getSurfaceSampler(this->bedmap).getIceArea();
+}
+
+bool Continent::getSurfaceIntersection(const Vector3<double>& origin, const Vector3<double>& direction,
+                                       const double maxdistance, double& distance) const {
+    return getElevationPyramid(this->bedmap).intersect(Horizon::Surface, origin, direction, 0, maxdistance, distance);
+}
+
+bool Continent::getBedIntersection(const Vector3<double>& origin, const Vector3<double>& direction,
+                                   const double maxdistance, double& distance) const {
+    return getElevationPyramid(this->bedmap).intersect(Horizon::Bed, origin, direction, 0, maxdistance, distance);
+}
+
+// the nominal density of each material
+double anita::getMaterialDensity(const Material material) {
+
+    switch (material) {
+    case Material::Rock: return 2.6; // the upper crust of PREM
+    case Material::Ice: return 0.917;
+    case Material::Firn: return 0.6;
+    case Material::Air: return 1.225e-3; // at sea level
+    case Material::Ocean: return 1.02;
+    case Material::FreshWater: return 1.;
+    }
+
+    std::cerr << "Unknown material. Quitting..." << std::endl;
+    throw std::exception();
+}
+
+// the densities (g/cm^3) of the ice and of the ocean
+static const double ICE_DENSITY = getMaterialDensity(Material::Ice);
+static const double OCEAN_DENSITY = getMaterialDensity(Material::Ocean);
+
+ColumnDepth Continent::getColumnDepth(const Vector3<double>& origin, const Vector3<double>& direction,
+                                      const double length) const {
+
+    // start from PREM along the whole chord
+    ColumnDepth column(this->earth, origin, direction, length);
+
+    const ElevationPyramid& pyramid = getElevationPyramid(this->bedmap);
+
+    // every crossing of the surface and of the bed along the chord
+    std::vector<double> crossings = { 0., length };
+    for (const Horizon horizon : { Horizon::Surface, Horizon::Bed }) {
+        double s = 0;
+        while (pyramid.intersect(horizon, origin, direction, s, length, s))
+            crossings.push_back(s);
+    }
+    std::sort(crossings.begin(), crossings.end());
+
+    // the part of the chord that is outside of the outermost radius of PREM
+    const double closest = -(origin*direction);
+    const double half2 = pow(this->earth.getRadii().back(), 2) - (origin.sqrMag() - closest*closest);
+    const double inside = half2 > 0 ? sqrt(half2) : 0;
+    const double top = this->earth.getDensities().back();
+
+    // the material only changes at a crossing, so we look at the middle of each range
+    for (std::size_t i = 0; i + 1 < crossings.size(); i++) {
+        const double start = crossings[i];
+        const double end = crossings[i + 1];
+        const Vector3<double> middle = origin + direction*(0.5*(start + end));
+
+        // above the surface there is nothing
+        if (pyramid.getHeight(Horizon::Surface, middle) > 0) {
+            column.setDensity(start, end, 0);
+            continue;
+        }
+
+        // between the surface and the bed there is ice, or the ocean
+        if (pyramid.getHeight(Horizon::Bed, middle) > 0) {
+            const double r = middle.mag();
+            const double thickness = this->bedmap.query(acos(middle.z/r), atan2(middle.y, middle.x)).thickness;
+            column.setDensity(start, end, thickness > 0 ? ICE_DENSITY : OCEAN_DENSITY);
+            continue;
+        }
 
+        // and below the bed we keep PREM, extended out to the ellipsoid
+        column.setDensity(start, std::min(end, closest - inside), top);
+        column.setDensity(std::max(start, closest + inside), end, top);
+    }
+
+    return column;
 }
 
 // we generate a random spherical unit vector
@@ -28,10 +131,13 @@ SphericalCoordinate Continent::getRandomSurfaceDirection() const {
 // return the elevation of the surface at a given (theta, phi)
 double Continent::getSurfaceElevation(const double theta, const double phi) const {
 
+    // query the BEDMAP2 ice mask and elevation in a single lookup
+    const readers::BedmapPoint point = this->bedmap.query(theta, phi);
+
     // we check the BEDMAP2 ice mask to see if there is ice at our location
-    if (this->bedmap.getIceMask(theta, phi) != readers::IceMask::Ocean) {
+    if (point.mask != readers::IceMask::Ocean) {
         // we have ice, so return surface elevation of ice
-        return this->bedmap.getSurfaceElevation(theta, phi);
+        return point.surface;
     }
     else {
         // there is no ice. Just ocean, so we return the WGS84 ellipsoid
@@ -39,6 +145,20 @@ double Continent::getSurfaceElevation(const double theta, const double phi) cons
     }
 }
 
+double Continent::getSurfaceRadius(const double theta, const double phi) const {
+
+    // the radius of the ellipsoid below this point
+    const double ellipsoid = this->getEarthRadius(theta);
+
+    // and the BEDMAP2 elevation (in m) above it, unless this is the ocean
+    const readers::BedmapPoint point = this->bedmap.query(theta, phi);
+    if ((point.mask == readers::IceMask::Ocean) || std::isnan(point.surface)) {
+        return ellipsoid;
+    }
+
+    return ellipsoid + point.surface/1000.;
+}
+
 std::pair<double, Material> Continent::getDensityAndMaterial(const SphericalCoordinate coord) const {
 
     return getDensityAndMaterial(coord.theta, coord.phi, coord.r);
@@ -0,0 +1,534 @@
+#include <math.h>
+#include <limits>
+#include <iostream>
+#include <algorithm>
+#include <Constants.hpp>
+#include <ElevationPyramid.hpp>
+#include <readers/Stereographic.hpp>
+
+using namespace anita;
+
+// the distance (km) that we advance along the ray while searching
+// for a crossing at the full resolution of the grid
+static constexpr double LEAF_STEP = 0.25;
+
+// the distance (km) to which crossings are found
+static constexpr double TOLERANCE = 1e-6;
+
+// the smallest distance (km) that a step may advance by, so that
+// rays on the edge of a node always make progress
+static constexpr double MIN_STEP = 1e-6;
+
+// an extra margin (km) around every bound on the height of the ray
+static constexpr double MARGIN = 1e-3;
+
+// the bounds of a node that contains no elevations at all (NaN's everywhere)
+static constexpr std::int16_t EMPTY_MIN = std::numeric_limits<std::int16_t>::max();
+static constexpr std::int16_t EMPTY_MAX = std::numeric_limits<std::int16_t>::min();
+
+// everything that we need to know about the ray
+struct ElevationPyramid::Ray {
+    double ox, oy, oz; ///< the origin (km)
+    double dx, dy, dz; ///< the unit direction
+    double closest; ///< the distance along the ray of the closest approach to the center of the Earth
+    double smin; ///< crossings must be strictly after this distance
+    double inner; ///< the radius (km) below which there is no topography
+};
+
+// the radius (km) of the WGS84 ellipsoid at a polar angle with the given sin and cos
+static inline double ellipsoidRadius(const double sintheta, const double costheta) {
+    return (EARTH_A*EARTH_B)/sqrt(pow(EARTH_B*sintheta, 2) + pow(EARTH_A*costheta, 2));
+}
+
+// the distance (km) of the ray from the center of the Earth at s
+static inline double radiusAt(const double ox, const double oy, const double oz,
+                              const double dx, const double dy, const double dz, const double s) {
+    return sqrt(pow(ox + s*dx, 2) + pow(oy + s*dy, 2) + pow(oz + s*dz, 2));
+}
+
+// round a bound outwards onto the meters stored in the pyramid
+static inline std::int16_t roundDown(const double value) {
+    return static_cast<std::int16_t>(std::max(floor(value) - 1., -32767.));
+}
+static inline std::int16_t roundUp(const double value) {
+    return static_cast<std::int16_t>(std::min(ceil(value) + 1., 32766.));
+}
+
+
+// build the pyramid for both horizons
+ElevationPyramid::ElevationPyramid(const readers::Bedmap& bm)
+    : bedmap(bm), ncols(bm.getNumColumns()), nrows(bm.getNumRows()),
+      halfwidth(0.5*static_cast<double>(bm.getNumColumns())),
+      cap_radius(0), cap_angle(0), map_speed(0) {
+
+    // fill in the finest level from the rasters and then every coarser level
+    this->buildBaseLevel();
+    this->buildLevels();
+
+    // the radius of a cap around the south pole that contains the whole grid. This is 10% larger
+    // than the corners of the grid, so that a ray that leaves the cap must travel a long
+    // way (on the map) before it can re-enter the grid
+    this->cap_radius = 1.1*sqrt(2.)*this->halfwidth;
+    this->cap_angle = PI - this->bedmap.BEDMAPLocationToCoord(0, this->cap_radius).first;
+
+    // within the shell of topography the direction to a point on the ray turns by at most 1/r
+    // radians per km, which moves it at most k*a^2/b km on the map (the radius of curvature of
+    // the ellipsoid is largest at the pole, and k is largest at the edge of the cap)
+    const double inner = std::min(this->getShell(Horizon::Surface).first, this->getShell(Horizon::Bed).first);
+    this->map_speed = 1.01*this->bedmap.getScaleFactor(0, this->cap_radius)*(EARTH_A*EARTH_A/EARTH_B)/inner;
+
+}
+
+
+// compute level 0 from the rasters
+void ElevationPyramid::buildBaseLevel() {
+
+    // every level is square and nodes beyond the edge of the grid are empty
+    const int size = (std::max(this->ncols, this->nrows) + 1)/2;
+    this->sizes.push_back(size);
+    for (int h = 0; h < 2; h++) {
+        this->levels[h].push_back(std::vector<Bounds>(static_cast<std::size_t>(size*size),
+                                                      Bounds{EMPTY_MIN, EMPTY_MAX}));
+    }
+
+    // the three rows of cells that bilinear interpolation within a row of blocks can reach.
+    // Row r is kept in rows[r % 3], so the last row of each block is reused by the next
+    std::vector<readers::BedmapPoint> rows[3];
+    int loaded[3] = { -1, -1, -1 };
+    for (int i = 0; i < 3; i++) {
+        rows[i].resize(static_cast<std::size_t>(this->ncols));
+    }
+
+    for (int j = 0; j < (this->nrows + 1)/2; j++) {
+
+        // fetch any rows that we don't have yet - the last row of the grid may be repeated
+        const std::vector<readers::BedmapPoint>* patch[3];
+        for (int i = 0; i < 3; i++) {
+            const int row = std::min(2*j + i, this->nrows - 1);
+            if (loaded[row % 3] != row) {
+                this->bedmap.queryRow(row, rows[row % 3].data());
+                loaded[row % 3] = row;
+            }
+            patch[i] = &rows[row % 3];
+        }
+
+        for (int i = 0; i < (this->ncols + 1)/2; i++) {
+
+            // the range of each horizon where it is defined, the range of the geoid, and
+            // whether either horizon is undefined anywhere within the 3x3 patch of cells
+            double lo[2] = { HUGE_VAL, HUGE_VAL };
+            double hi[2] = { -HUGE_VAL, -HUGE_VAL };
+            double geoidlo = HUGE_VAL;
+            double geoidhi = -HUGE_VAL;
+            bool missing[2] = { false, false };
+
+            for (int r = 0; r < 3; r++) {
+                for (int c = 0; c < 3; c++) {
+                    const readers::BedmapPoint& cell = (*patch[r])[static_cast<std::size_t>(std::min(2*i + c, this->ncols - 1))];
+                    const double values[2] = { cell.surface, cell.bed };
+
+                    for (int h = 0; h < 2; h++) {
+                        if (std::isnan(values[h])) {
+                            missing[h] = true;
+                        }
+                        else {
+                            lo[h] = std::min(lo[h], values[h]);
+                            hi[h] = std::max(hi[h], values[h]);
+                        }
+                    }
+
+                    if (!std::isnan(cell.geoid)) {
+                        geoidlo = std::min(geoidlo, cell.geoid);
+                        geoidhi = std::max(geoidhi, cell.geoid);
+                    }
+                }
+            }
+
+            // where a horizon is undefined at any corner of an interpolation cell,
+            // that cell falls back to the geoid (see getElevationAtPoint)
+            for (int h = 0; h < 2; h++) {
+                if (missing[h]) {
+                    lo[h] = std::min(lo[h], geoidlo);
+                    hi[h] = std::max(hi[h], geoidhi);
+                }
+
+                // and only store bounds if we found any elevations
+                if (lo[h] <= hi[h]) {
+                    this->levels[h][0][static_cast<std::size_t>(j*size + i)] = Bounds{roundDown(lo[h]), roundUp(hi[h])};
+                }
+            }
+        }
+    }
+}
+
+
+// compute every level above level 0
+void ElevationPyramid::buildLevels() {
+
+    while (this->sizes.back() > 1) {
+
+        // the level below us
+        const int below = this->sizes.back();
+        const int size = (below + 1)/2;
+        this->sizes.push_back(size);
+
+        for (int h = 0; h < 2; h++) {
+            const std::vector<Bounds>& children = this->levels[h].back();
+            std::vector<Bounds> nodes(static_cast<std::size_t>(size*size), Bounds{EMPTY_MIN, EMPTY_MAX});
+
+            // each node bounds its (up to) four children
+            for (int j = 0; j < size; j++) {
+                for (int i = 0; i < size; i++) {
+                    Bounds& node = nodes[static_cast<std::size_t>(j*size + i)];
+                    for (int cj = 2*j; cj < std::min(2*j + 2, below); cj++) {
+                        for (int ci = 2*i; ci < std::min(2*i + 2, below); ci++) {
+                            const Bounds& child = children[static_cast<std::size_t>(cj*below + ci)];
+                            node.min = std::min(node.min, child.min);
+                            node.max = std::max(node.max, child.max);
+                        }
+                    }
+                }
+            }
+
+            this->levels[h].push_back(nodes);
+        }
+    }
+}
+
+
+// get the bounds of the node containing cell (col, row) at `level`
+const ElevationPyramid::Bounds& ElevationPyramid::getNode(const Horizon horizon, const int level,
+                                                          const int col, const int row) const {
+
+    // each node of `level` covers 2^(level + 1) cells along each side
+    const int size = this->sizes[static_cast<std::size_t>(level)];
+    const int i = col >> (level + 1);
+    const int j = row >> (level + 1);
+
+    return this->levels[static_cast<int>(horizon)][static_cast<std::size_t>(level)][static_cast<std::size_t>(j*size + i)];
+}
+
+
+// get the (min, max) elevation (m) of a node
+std::pair<double, double> ElevationPyramid::getBounds(const Horizon horizon, const int level,
+                                                      const int col, const int row) const {
+
+    // check that the node exists
+    if ((level < 0) || (level >= this->getNumLevels()) ||
+        (col < 0) || (row < 0) || (col >= this->getLevelSize(level)) || (row >= this->getLevelSize(level))) {
+        std::cerr << "Node (" << col << ", " << row << ") of level " << level
+                  << " is outside of the pyramid. Quitting..." << std::endl;
+        throw std::exception();
+    }
+
+    const Bounds& node = this->levels[static_cast<int>(horizon)][static_cast<std::size_t>(level)]
+        [static_cast<std::size_t>(row*this->getLevelSize(level) + col)];
+
+    return std::make_pair(static_cast<double>(node.min), static_cast<double>(node.max));
+}
+
+
+// the radii (km) between which `horizon` lies everywhere
+std::pair<double, double> ElevationPyramid::getShell(const Horizon horizon) const {
+
+    // the top node bounds the whole grid, and the ellipsoid is used outside of it
+    const Bounds& top = this->levels[static_cast<int>(horizon)].back()[0];
+    const double lo = std::min(0., static_cast<double>(top.min));
+    const double hi = std::max(0., static_cast<double>(top.max));
+
+    return std::make_pair(EARTH_B + lo/1000. - MARGIN, EARTH_A + hi/1000. + MARGIN);
+}
+
+
+// get the elevation of `horizon` at (x, y) in Bedmap coordinates
+double ElevationPyramid::getElevationAtPoint(const Horizon horizon, const double x, const double y) const {
+
+    // there is no data outside of the grid
+    if (!((fabs(x) <= this->halfwidth) && (fabs(y) <= this->halfwidth)))
+        return std::numeric_limits<double>::quiet_NaN();
+
+    // where the horizon is undefined (i.e. the ice surface over the ocean), we use the geoid
+    const readers::BedmapPoint point = this->bedmap.queryAtPoint(x, y);
+    const double elevation = horizon == Horizon::Surface ? point.surface : point.bed;
+
+    return std::isnan(elevation) ? point.geoid : elevation;
+}
+
+
+// get the height of the ray above `horizon` at s
+double ElevationPyramid::getClearance(const Horizon horizon, const Ray& ray, const double s) const {
+
+    // the point on the ray
+    const double px = ray.ox + s*ray.dx;
+    const double py = ray.oy + s*ray.dy;
+    const double pz = ray.oz + s*ray.dz;
+    const double r = sqrt(px*px + py*py + pz*pz);
+    const double theta = acos(pz/r);
+    const double phi = atan2(py, px);
+
+    // the height of the point above the ellipsoid
+    const double height = r - ellipsoidRadius(sin(theta), cos(theta));
+
+    // and of the horizon above the ellipsoid
+    double x, y;
+    std::uint8_t inrange;
+    if (!readers::projectStereographic(1, &theta, &phi, &x, &y, &inrange, this->halfwidth))
+        return height;
+
+    return height - this->getElevationAtPoint(horizon, x, y)/1000.;
+}
+
+
+// get the height of a point above `horizon`
+double ElevationPyramid::getHeight(const Horizon horizon, const Vector3<double>& point) const {
+
+    // this is the clearance at the start of a ray from the point
+    Ray ray;
+    ray.ox = point.x; ray.oy = point.y; ray.oz = point.z;
+    ray.dx = 0; ray.dy = 0; ray.dz = 0;
+    ray.closest = 0;
+    ray.smin = 0;
+    ray.inner = 0;
+
+    return this->getClearance(horizon, ray, 0);
+}
+
+
+// find the root of the clearance between a and b
+double ElevationPyramid::findCrossing(const Horizon horizon, const Ray& ray,
+                                      double a, double ga, double b, double gb) const {
+
+    // the sign of the clearance before the crossing
+    const bool before = ga > 0;
+
+    // the Illinois variant of regula falsi - this converges superlinearly since
+    // the clearance is nearly linear (or quadratic) over such short distances
+    for (int i = 0; (i < 100) && (fabs(b - a) > TOLERANCE); i++) {
+
+        const double c = b - gb*(b - a)/(gb - ga);
+        const double gc = this->getClearance(horizon, ray, c);
+        if (gc == 0.)
+            return c;
+
+        // the root is between b and c, or else between a and c and we halve
+        // the value at a so that a also moves on the next iteration
+        if (gc*gb < 0) {
+            a = b;
+            ga = gb;
+        }
+        else {
+            ga *= 0.5;
+        }
+        b = c;
+        gb = gc;
+    }
+
+    // a and b still bracket the root, and we return the end past it so that
+    // a search that starts from the crossing does not find it again
+    return (ga > 0) != before ? a : b;
+}
+
+
+// find the first crossing of `horizon` along a ray
+bool ElevationPyramid::intersect(const Horizon horizon, const Vector3<double>& origin, const Vector3<double>& direction,
+                                 const double smin, const double smax, double& s) const {
+
+    Ray ray;
+    ray.ox = origin.x; ray.oy = origin.y; ray.oz = origin.z;
+    ray.dx = direction.x; ray.dy = direction.y; ray.dz = direction.z;
+    ray.closest = -(origin*direction);
+    ray.smin = smin;
+
+    // the topography lies entirely within a spherical shell, so
+    // we only need to traverse the parts of the ray inside it
+    const std::pair<double, double> shell = this->getShell(horizon);
+    ray.inner = shell.first;
+
+    // the ray enters and leaves the outside of the shell at closest -/+ outer...
+    const double distance2 = origin.sqrMag() - ray.closest*ray.closest;
+    const double outer2 = shell.second*shell.second - distance2;
+    if (outer2 <= 0)
+        return false;
+    const double enter = std::max(smin, ray.closest - sqrt(outer2));
+    const double leave = std::min(smax, ray.closest + sqrt(outer2));
+
+    // ...and, if it passes that close, the inside of the shell at closest -/+ inner
+    const double inner2 = ray.inner*ray.inner - distance2;
+    if (inner2 <= 0)
+        return this->traverse(horizon, ray, enter, leave, s);
+
+    // so we have two pieces to traverse
+    if (this->traverse(horizon, ray, enter, std::min(leave, ray.closest - sqrt(inner2)), s))
+        return true;
+
+    return this->traverse(horizon, ray, std::max(enter, ray.closest + sqrt(inner2)), leave, s);
+}
+
+
+// walk the ray through the pyramid between sa and sb
+bool ElevationPyramid::traverse(const Horizon horizon, const Ray& ray, const double sa, const double sb, double& s) const {
+
+    // the top of the pyramid and where we start from
+    const int top = this->getNumLevels() - 1;
+    int level = top;
+
+    // the grid in the same units as Bedmap::locateCell
+    const double xllcorner = -this->halfwidth;
+    const double yllcorner = -this->halfwidth;
+
+    // the most recent value of the clearance, which we use at the start of the next step
+    double tg = -HUGE_VAL;
+    double g = 0;
+
+    // how quickly the radius of the ellipsoid beneath the ray can change (km per km)
+    const double rslope = 1.02*(EARTH_A - EARTH_B)/ray.inner;
+
+    double t = sa;
+    while (t < sb) {
+
+        // the point on the ray and its direction
+        const double px = ray.ox + t*ray.dx;
+        const double py = ray.oy + t*ray.dy;
+        const double pz = ray.oz + t*ray.dz;
+        const double r = sqrt(px*px + py*py + pz*pz);
+        const double theta = acos(pz/r);
+        const double phi = atan2(py, px);
+
+        // the distance that we can step (on the ray), and the bounds (m) over that
+        // step; these are the bounds for the ellipsoid unless we are over the grid
+        double step = 0;
+        double lo = 0;
+        double hi = 0;
+        bool grid = false;
+
+        // the cell of the grid that we are in
+        int col = 0;
+        int row = 0;
+        double xi = 0;
+        double yi = 0;
+
+        if (PI - theta > this->cap_angle) {
+            // we are outside of the cap around the grid - every point of the cap inside the shell is
+            // at least this far away, since it is at least (PI - theta) - cap_angle radians away
+            step = 2*ray.inner*sin(0.5*((PI - theta) - this->cap_angle));
+        }
+        else {
+            // we are over the cap, so we find out where on the map we are
+            double x, y;
+            std::uint8_t inrange;
+            readers::projectStereographic(1, &theta, &phi, &x, &y, &inrange, HUGE_VAL);
+
+            if ((fabs(x) <= this->halfwidth) && (fabs(y) <= this->halfwidth)) {
+                // we are over the grid, so find the cell exactly as Bedmap::locateCell does
+                grid = true;
+                xi = (x - xllcorner) - 0.5;
+                yi = (-yllcorner - y) - 0.5;
+                col = std::max(0, std::min(this->ncols - 1, static_cast<int>(floor(xi))));
+                row = std::max(0, std::min(this->nrows - 1, static_cast<int>(floor(yi))));
+            }
+            else {
+                // to reach the grid we must either travel to it on the map, or leave the
+                // cap and travel back across the gap between the cap and the grid
+                const double rho = sqrt(x*x + y*y);
+                const double gap = sqrt(pow(std::max(fabs(x) - this->halfwidth, 0.), 2) +
+                                        pow(std::max(fabs(y) - this->halfwidth, 0.), 2));
+                step = std::min(gap, 2*this->cap_radius - rho - sqrt(2.)*this->halfwidth)/this->map_speed;
+            }
+        }
+
+        // descend the pyramid until the ray is clear of a node, or we reach the bottom
+        while (true) {
+
+            if (grid) {
+                // the bounds of our node at this level
+                const Bounds& node = this->getNode(horizon, level, col, row);
+                lo = node.min;
+                hi = node.max;
+
+                // and the distance on the map to the edge of the node - the outermost nodes
+                // extend to the edge of the grid
+                const int span = 1 << (level + 1);
+                const int i = col/span;
+                const int j = row/span;
+                const double left = i == 0 ? -0.5 : i*span;
+                const double right = (i + 1)*span >= this->ncols ? this->ncols - 0.5 : (i + 1)*span;
+                const double upper = j == 0 ? -0.5 : j*span;
+                const double lower = (j + 1)*span >= this->nrows ? this->nrows - 0.5 : (j + 1)*span;
+                step = std::min(std::min(xi - left, right - xi), std::min(yi - upper, lower - yi))/this->map_speed;
+            }
+
+            // the end of this step
+            const double end = std::min(sb, t + std::max(step, MIN_STEP));
+
+            // the exact range of the radius of the ray over the step
+            const double rmin = radiusAt(ray.ox, ray.oy, ray.oz, ray.dx, ray.dy, ray.dz,
+                                         std::max(t, std::min(end, ray.closest)));
+            const double rmax = std::max(r, radiusAt(ray.ox, ray.oy, ray.oz, ray.dx, ray.dy, ray.dz, end));
+
+            // and bounds on the height of the ray above the ellipsoid
+            const double ellipsoid = ellipsoidRadius(sin(theta), cos(theta));
+            const double hmin = rmin - ellipsoid - rslope*(end - t);
+            const double hmax = rmax - ellipsoid + rslope*(end - t);
+
+            // if the ray is entirely above or below this node for the whole step, we skip it
+            if ((hmin > hi/1000. + MARGIN) || (hmax < lo/1000. - MARGIN)) {
+                t = end;
+                level = std::min(level + 1, top);
+                break;
+            }
+
+            // if we are not over the grid, the horizon is the ellipsoid, which we can intersect exactly
+            if (!grid) {
+                const double a = (pow(ray.dx, 2) + pow(ray.dy, 2))/pow(EARTH_A, 2) + pow(ray.dz, 2)/pow(EARTH_B, 2);
+                const double b = 2*((px*ray.dx + py*ray.dy)/pow(EARTH_A, 2) + pz*ray.dz/pow(EARTH_B, 2));
+                const double c = (pow(px, 2) + pow(py, 2))/pow(EARTH_A, 2) + pow(pz, 2)/pow(EARTH_B, 2) - 1;
+                const double discriminant = b*b - 4*a*c;
+
+                // the roots are relative to t; we take the first one within this step that is clear of
+                // smin, which may be a crossing that we found before and has a root there to rounding
+                if (discriminant >= 0) {
+                    const double roots[2] = { (-b - sqrt(discriminant))/(2*a), (-b + sqrt(discriminant))/(2*a) };
+                    for (const double root : roots) {
+                        if ((root >= 0) && (t + root <= end) && (t + root > ray.smin + TOLERANCE)) {
+                            s = t + root;
+                            return true;
+                        }
+                    }
+                }
+
+                t = end;
+                break;
+            }
+
+            // otherwise try the next level down
+            if (level > 0) {
+                level--;
+                continue;
+            }
+
+            // at the bottom of the pyramid, we look for a change in the sign of the clearance
+            if (tg != t) {
+                g = this->getClearance(horizon, ray, t);
+            }
+            if ((g == 0.) && (t > ray.smin)) {
+                s = t;
+                return true;
+            }
+
+            const double next = std::min(sb, t + LEAF_STEP);
+            const double gnext = this->getClearance(horizon, ray, next);
+            if (g*gnext < 0) {
+                s = this->findCrossing(horizon, ray, t, g, next, gnext);
+                return true;
+            }
+
+            // no crossing, so we carry on from the end of this step
+            t = next;
+            tg = next;
+            g = gnext;
+            break;
+        }
+    }
+
+    return false;
+}
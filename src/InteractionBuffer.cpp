@@ -0,0 +1,107 @@
+#include <iostream>
+#include <algorithm>
+#include <InteractionBuffer.hpp>
+
+using namespace anita;
+
+
+// scatter the interactions of an event into the columns
+void InteractionBuffer::append(const int event, const InteractionList& interactions) {
+
+    Columns& c = this->columns;
+
+    c.events.push_back(event);
+    for (const Interaction& interaction : interactions) {
+        c.trials.push_back(interaction.trials);
+        c.flavor.push_back(static_cast<std::uint8_t>(interaction.particle.flavor));
+        c.neutrino.push_back(static_cast<std::uint8_t>(interaction.particle.neutrino));
+        c.energy.push_back(interaction.particle.energy);
+        c.theta.push_back(interaction.location.theta);
+        c.phi.push_back(interaction.location.phi);
+        c.r.push_back(interaction.location.r);
+        c.direction_theta.push_back(interaction.direction.theta);
+        c.direction_phi.push_back(interaction.direction.phi);
+        c.direction_r.push_back(interaction.direction.r);
+        c.current.push_back(static_cast<std::uint8_t>(interaction.current));
+        c.distance.push_back(interaction.distance);
+        c.weight.push_back(interaction.weight);
+    }
+
+    // and the end of this event is the start of the next
+    c.offsets.push_back(c.energy.size());
+}
+
+
+void InteractionBuffer::reserve(const std::size_t nevents, const std::size_t ninteractions) {
+
+    Columns& c = this->columns;
+
+    c.events.reserve(nevents);
+    c.offsets.reserve(nevents + 1);
+
+    c.trials.reserve(ninteractions);
+    for (std::vector<std::uint8_t>* column : { &c.flavor, &c.neutrino, &c.current })
+        column->reserve(ninteractions);
+    for (std::vector<double>* column : { &c.energy, &c.theta, &c.phi, &c.r, &c.direction_theta,
+                                         &c.direction_phi, &c.direction_r, &c.distance, &c.weight })
+        column->reserve(ninteractions);
+}
+
+
+void InteractionBuffer::clear() {
+
+    Columns& c = this->columns;
+
+    c.events.clear();
+    c.offsets.assign(1, 0);
+
+    c.trials.clear();
+    for (std::vector<std::uint8_t>* column : { &c.flavor, &c.neutrino, &c.current })
+        column->clear();
+    for (std::vector<double>* column : { &c.energy, &c.theta, &c.phi, &c.r, &c.direction_theta,
+                                         &c.direction_phi, &c.direction_r, &c.distance, &c.weight })
+        column->clear();
+}
+
+
+// gather a row of the columns
+Interaction InteractionBuffer::getInteraction(const std::size_t row) const {
+
+    const Columns& c = this->columns;
+
+    if (row >= this->getNumInteractions()) {
+        std::cerr << "Interaction " << row << " is not in the buffer. Quitting..." << std::endl;
+        throw std::exception();
+    }
+
+    // the event that this row belongs to is the last one that starts at or before it -
+    // empty events start at the same row as the next event so we take the last of them
+    const std::size_t i = static_cast<std::size_t>(
+        std::upper_bound(c.offsets.begin(), c.offsets.end(), row) - c.offsets.begin()) - 1;
+
+    Interaction interaction(c.trials[row],
+                            ParticleState{static_cast<Flavor>(c.flavor[row]), c.neutrino[row] != 0, c.energy[row]},
+                            SphericalCoordinate(c.theta[row], c.phi[row], c.r[row]),
+                            SphericalCoordinate(c.direction_theta[row], c.direction_phi[row], c.direction_r[row]),
+                            static_cast<Current>(c.current[row]), c.distance[row]);
+    interaction.event = c.events[i];
+    interaction.weight = c.weight[row];
+
+    return interaction;
+}
+
+
+InteractionList InteractionBuffer::getEvent(const std::size_t i) const {
+
+    if (i >= this->getNumEvents()) {
+        std::cerr << "Event " << i << " is not in the buffer. Quitting..." << std::endl;
+        throw std::exception();
+    }
+
+    InteractionList interactions;
+    interactions.reserve(this->getNumInteractions(i));
+    for (std::size_t row = this->columns.offsets[i]; row < this->columns.offsets[i + 1]; row++)
+        interactions.push_back(this->getInteraction(row));
+
+    return interactions;
+}
@@ -3,9 +3,16 @@
 #include <boost/program_options.hpp>
 
 #include <NuMC.hpp>
+#include <Random.hpp>
 #include <ANITA.hpp>
 #include <Continent.hpp>
 #include <Propagator.hpp>
+#include <Acceptance.hpp>
+#include <Reweighter.hpp>
+#include <readers/Table.hpp>
+#include <InteractionSink.hpp>
+#include <writers/ColumnarWriter.hpp>
+#include <writers/InteractionWriter.hpp>
 
 using namespace anita;
 
@@ -25,13 +32,26 @@ int main(int argc, char** argv) {
 
         // general options
         ("num-events", po::value<int>()->required(), "Number of incident neutrinos")
+        ("threads", po::value<unsigned int>()->default_value(1), "Number of threads to propagate neutrinos with. If 0, use all available cores.")
+        ("seed", po::value<unsigned long>()->default_value(0), "The seed of the run. Each event is reproducible from (seed, event number) for any number of threads.")
+        ("output", po::value<std::string>()->default_value(""), "The file to write every interaction to. If empty, interactions are discarded.")
+        ("format", po::value<std::string>()->default_value("root"), "The format of the output file - 'root' for a TTree, or 'columnar' for the NuMC columnar format.")
+        ("compression", po::value<int>()->default_value(4), "The ROOT compression algorithm of the output file (1: ZLIB, 2: LZMA, 4: LZ4, 5: ZSTD).")
+        ("compression-level", po::value<int>()->default_value(4), "The compression level of the output file from 0 (none) to 9. Columnar files always use zlib.")
+        ("basket-size", po::value<int>()->default_value(64000), "The basket size (in bytes) of every branch in the output file.")
 
         // options for particle propagation
-        ("spectrum", po::value<std::string>()->required()->default_value("Kotera2010_mix_max"), "The neutrino spectrum file in data/fluxes/.")
+        ("spectrum", po::value<std::string>()->required()->default_value("Kotera2010_mix_max"), "The neutrino spectrum file in data/fluxes/, or 'reference' for a flat spectrum in log10(eV) to reweight.")
+        ("reweight", po::value<bool>()->default_value(false), "Whether to reweight every event to all the flux models in data/fluxes/ and print the rate of each.")
         ("energy", po::value<double>()->default_value(0), "Incident energy of neutrinos in log10(eV) units if spectrum is 'fixed'.")
         ("min-energy", po::value<double>()->default_value(14.), "A minimum energy cut for propagation in log10(eV) units.")
         ("max-energy", po::value<double>()->default_value(20.9), "A maximum energy cut for propagation in log10(eV) units.")
         ("max-depth", po::value<double>()->default_value(50), "The maximum depth (in km) to save terminating hadronic air shower interactions.")
+        ("acceptance", po::value<bool>()->default_value(false), "Whether to only accumulate and print the acceptance against energy, flavor, current and depth.")
+        ("energy-bins", po::value<std::size_t>()->default_value(14), "The number of energy bins between the energy cuts for the acceptance.")
+        ("depth-bins", po::value<std::size_t>()->default_value(10), "The number of depth bins up to max-depth for the acceptance.")
+        ("precision", po::value<double>()->default_value(0), "If positive, stop accumulating the acceptance once every energy bin has this relative error, with num-events as the maximum.")
+        ("max-time", po::value<double>()->default_value(0), "If positive, the maximum wall time (in seconds) to accumulate the acceptance for.")
         ("nc-regeneration", po::value<bool>()->default_value(true), "Whether to use neutral current regeneration for neutrinos. If 'false', NC interactions terminate propagation.")
 
         // options for radio emission from particle interactions
@@ -66,10 +86,24 @@ int main(int argc, char** argv) {
         return false;
     }
 
+    // check that we know how to write the requested format
+    const std::string format = vm["format"].as<std::string>();
+    if ((format != "root") && (format != "columnar")) {
+        std::cerr << "Unknown output format '" << format << "' - expected 'root' or 'columnar'." << std::endl;
+        return 1;
+    }
+
     ////////////////////////////////////////////////////////////////////////////
     //////////////////////////// START SIMULATION //////////////////////////////
     ////////////////////////////////////////////////////////////////////////////
 
+    // seed the random number streams of every event
+    setSeed(vm["seed"].as<unsigned long>());
+
+    // start loading the interaction and decay tables in the background
+    // while the Continent loads its data files
+    readers::TableRegistry::preload();
+
     // we create a representation of Antarctica
     // this create a new Continent() class that loads BEDMAP and other
     // data files relevant to particle propagation
@@ -81,8 +115,86 @@ int main(int argc, char** argv) {
                                              vm["min-energy"].as<double>(), // min energy cut
                                              vm["max-energy"].as<double>()); // max energy cut
 
+    // reweight every event to all the flux models in a single pass
+    if (vm["reweight"].as<bool>()) {
+
+        Reweighter reweighter(vm["num-events"].as<int>());
+        propagator.propagateParticles(vm["num-events"].as<int>(), reweighter, vm["threads"].as<unsigned int>());
+
+        // and print the rate of every model
+        for (std::size_t i = 0; i < reweighter.getModels().size(); i++) {
+            std::cout << reweighter.getModels()[i] << ": " << reweighter.getRate(i)
+                      << " +/- " << reweighter.getError(i) << " cm^-2 s^-1 sr^-1" << std::endl;
+        }
+
+        return 0;
+    }
+
+    // accumulate the acceptance without keeping any interactions
+    if (vm["acceptance"].as<bool>()) {
+
+        Acceptance acceptance(propagator, continent, vm["energy-bins"].as<std::size_t>(),
+                              vm["max-depth"].as<double>(), vm["depth-bins"].as<std::size_t>());
+
+        // either until every energy bin is precise enough or we run out of events or time
+        if ((vm["precision"].as<double>() > 0) || (vm["max-time"].as<double>() > 0)) {
+            StoppingCriteria criteria;
+            criteria.precision = vm["precision"].as<double>();
+            criteria.max_time = vm["max-time"].as<double>();
+            criteria.max_events = vm["num-events"].as<int>();
+            const int nevents = propagator.propagateUntilConverged(acceptance, criteria, vm["threads"].as<unsigned int>());
+            std::cout << "Propagated " << nevents << " neutrinos." << std::endl;
+        }
+        // or for a fixed number of events
+        else {
+            propagator.propagateParticles(vm["num-events"].as<int>(), acceptance, vm["threads"].as<unsigned int>());
+        }
+
+        // and print the effective volume of every energy, flavor and current
+        for (std::size_t i = 0; i < acceptance.getNumEnergyBins(); i++) {
+            for (const Flavor flavor : { Flavor::Electron, Flavor::Muon, Flavor::Tau }) {
+                for (const Current current : { Current::Charged, Current::Neutral }) {
+                    std::cout << acceptance.getEnergy(i) << " " << static_cast<int>(flavor) << " " << static_cast<int>(current) << ": "
+                              << acceptance.getAcceptance(i, flavor, current) << " km^2 sr, "
+                              << acceptance.getVolume(i, flavor, current) << " km^3 sr" << std::endl;
+                }
+            }
+        }
+
+        return 0;
+    }
+
+    // write every event to a columnar file on a background thread
+    if (!vm["output"].as<std::string>().empty() && (format == "columnar")) {
+
+        writers::ColumnarOptions options;
+        options.compression_level = vm["compression-level"].as<int>();
+
+        writers::ColumnarWriter writer(vm["output"].as<std::string>(), options);
+        propagator.propagateParticles(vm["num-events"].as<int>(), writer, vm["threads"].as<unsigned int>());
+
+        return 0;
+    }
+
+    // or to a ROOT file
+    if (!vm["output"].as<std::string>().empty()) {
+
+        writers::WriterOptions options;
+        options.compression_algorithm = vm["compression"].as<int>();
+        options.compression_level = vm["compression-level"].as<int>();
+        options.basket_size = vm["basket-size"].as<int>();
+
+        writers::InteractionWriter writer(vm["output"].as<std::string>(), options);
+        propagator.propagateParticles(vm["num-events"].as<int>(), writer, vm["threads"].as<unsigned int>());
+
+        return 0;
+    }
+
+    // otherwise we discard each event as soon as it is propagated
+    NullSink sink;
+
     // we want to propagate 100 neutrinos through the Earth
-    // this function is implicitly thread-safe
-    propagator.propagateParticles(vm["num-events"].as<int>());
+    // neutrinos are distributed over a work-stealing pool of `threads` workers
+    propagator.propagateParticles(vm["num-events"].as<int>(), sink, vm["threads"].as<unsigned int>());
 
 } // END: main
@@ -1,26 +1,61 @@
 #include <map>
+#include <chrono>
+#include <mutex>
+#include <limits>
 #include <math.h>
 #include <vector>
+#include <iostream>
+#include <algorithm>
 
 #include <NuMC.hpp>
 #include <Lepton.hpp>
 #include <Random.hpp>
 #include <Particle.hpp>
 #include <Neutrino.hpp>
+#include <Scheduler.hpp>
+#include <Acceptance.hpp>
 #include <Propagator.hpp>
+#include <ParticleState.hpp>
+#include <InteractionSink.hpp>
 
 using namespace anita;
 
 // This function implements the complete propagation of a fixed number of particles
 // drawn from a particular energy distribution
-std::map<int, InteractionList> Propagator::propagateParticles(const int particlesToSimulate) const {
+std::map<int, InteractionList> Propagator::propagateParticles(const int particlesToSimulate,
+                                                              const unsigned int nthreads) const {
 
+    // collect every event into a map keyed by event index - the map orders them
+    // so the result does not depend on which thread propagated which neutrino
+    MapSink sink;
+    this->propagateParticles(particlesToSimulate, sink, nthreads);
 
-    // create a vector to store all valid interactions
-    std::map<int, InteractionList> interactionMap;
+    // and we are done
+    return sink.release();
 
-    // iterate over the number of desired particles
-    for (int n = 0; n < particlesToSimulate; n++) {
+}
+
+
+// propagate a fixed number of particles, handing each event to `sink` as it finishes
+void Propagator::propagateParticles(const int particlesToSimulate, InteractionSink& sink,
+                                    const unsigned int nthreads, const int first) const {
+
+    // create a pool of workers to distribute the neutrinos over
+    const Scheduler scheduler(nthreads);
+
+    // sinks that aren't safe to call from several threads are protected by this lock
+    std::mutex sink_lock;
+    const bool concurrent = sink.isConcurrent();
+
+    // propagate a single neutrino
+    auto task = [this, &sink, &sink_lock, concurrent, first](const unsigned int worker, const int index) {
+
+        // the event number of this neutrino
+        const int n = first + index;
+
+        // every random number drawn for this event comes from the (seed, event) stream
+        // so each event is reproducible regardless of the number of threads
+        beginEvent(static_cast<std::uint64_t>(n));
 
         // randomly pick an energy from the desired distribution
         // or a fixed energy if spectrum == energySpectrum::Fixed
@@ -30,104 +65,181 @@ std::map<int, InteractionList> Propagator::propagateParticles(const int particle
         // this is either an ElectronNeutrino, MuonNeutrino, or TauNeutrino
         auto neutrino = Neutrino::generateRandomNeutrino(energy);
 
-        // propagate the particle through the Earth and save it to the list
-        interactionMap[n] = this->propagate(*neutrino);
+        // propagate the particle through the Earth
+        InteractionList interactions = this->propagate(*neutrino);
 
-    }
+        // and record which neutrino this was, and how likely we were to generate it
+        const double weight = this->getGenerationWeight(energy);
+        for (Interaction& interaction : interactions) {
+            interaction.event = n;
+            interaction.weight = weight;
+        }
 
-    // and we are done
-    return interactionMap;
+        // and pass it straight on to the sink
+        if (concurrent) {
+            sink.consume(worker, n, interactions);
+        }
+        else {
+            std::lock_guard<std::mutex> guard(sink_lock);
+            sink.consume(worker, n, interactions);
+        }
 
-}
+    };
 
+    // iterate over the number of desired particles
+    sink.begin(scheduler.getNumThreads());
+    scheduler.run(particlesToSimulate, task);
+    sink.finish();
 
-InteractionList Propagator::propagate(Neutrino& particle) const {
-    // this function takes a Neutrino object and continually generates
-    // random starting locations and directions and propagates the
-    // particle through the Earth, storing all interactions during
-    // propagation
+}
 
-    // initialize a new vector to store interactions of this particle
-    InteractionList interactions;
 
-    int ntrials = 1; // the number of particle attempts before a successful interaction that is accepted
-    while (ntrials) {
+// propagate batches of particles until the acceptance has converged
+int Propagator::propagateUntilConverged(Acceptance& acceptance, const StoppingCriteria& criteria,
+                                        const unsigned int nthreads) const {
 
-        // get random location on the surface of the sphere
-        SphericalCoordinate surface = this->continent.getRandomSurfacePoint();
+    // we need to propagate something between each check
+    if (criteria.batch_size <= 0) {
+        std::cerr << "Cannot propagate batches of " << criteria.batch_size << " particles. Quitting..." << std::endl;
+        throw std::exception();
+    }
 
-        // and a direction at the surface at this point
-        // TODO: VERIFY
-        SphericalCoordinate direction = this->continent.getRandomSurfaceDirection();
+    const auto start = std::chrono::steady_clock::now();
 
-        // and we compute the starting location of the particle on the surface of the Earth
-        // TODO: VERIFY
-        SphericalCoordinate start_point = SphericalCoordinate(PI - surface.theta,
-                                                              surface.phi + PI,
-                                                              surface.r); // geoid level
+    int nevents = 0;
+    while (nevents < criteria.max_events) {
 
-        // compute chord length of travel through Earth
-        double chord_length = 2*this->continent.getSurfaceElevation(surface.theta, surface.phi)*cos(direction.theta);
+        // every batch continues the event numbers of the last, so the run is
+        // identical to a single run of the same number of events
+        const int batch = std::min(criteria.batch_size, criteria.max_events - nevents);
+        this->propagateParticles(batch, acceptance, nthreads, nevents);
+        nevents += batch;
 
-        // we create a new Interaction to store the initial state of the propagation
-        Interaction interaction = Interaction(0, particle, surface, direction,
-                                              Current::Charged, 0);
+        // stop once every energy bin is precise enough
+        if (acceptance.isConverged(criteria.precision))
+            break;
 
-        // we step through the Earth
-        for (double distance = 0. ; distance < chord_length; )  {
+        // or we have run out of time
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if ((criteria.max_time > 0) && (elapsed.count() >= criteria.max_time))
+            break;
+    }
 
-            // we get the local density and material of the earth at the current location
-            // double density = this->continent.getDensity(interaction.location);
+    return nevents;
 
-            // get the interaction length at this density
-            // shame we can't use C++17 here :(
-            // auto interactionAndCurrent = interaction.particle.getInteractionLength(density);
-            // double interaction_length = interactionAndCurrent.first;
-            // Current current = interactionAndCurrent.second;
+}
 
-            // TODO: check for interaction and get current
-            bool interacted = true; // replace this with whether we have interacted
 
-            // we interact at this step
-            if (interacted) {
+// the height (km) above the semi-major axis at which chords start
+static constexpr double ATMOSPHERE_HEIGHT = 10.;
 
-                // get the particle resulting from this interaction or decay
-                // Particle* new_particle = particle.getInteractionProducts(current);
+// convert a vector from the center of the Earth into a spherical coordinate
+static SphericalCoordinate toSpherical(const Vector3<double>& v) {
+    const double r = v.mag();
+    return SphericalCoordinate(acos(v.z/r), atan2(v.y, v.x), r);
+}
 
-                // TODO: change any relevant fields in the interaction object
 
-                // and add the current interaction site to the list
-                // interactions.push_back(interaction);
+// sample the distance to the next interaction along the chord
+double anita::sampleInteractionDistance(const ColumnDepth& column, const double start, const double depth,
+                                        const PropagationMode mode) {
 
-            }
-            // we have a neutrino
-            if (interaction.particle.isNeutrino()) {
+    // invert the cumulative column depth at an exponentially distributed depth past `start`
+    if (mode == PropagationMode::Inversion) {
+        return column.getDistance(column.getColumnDepth(start) - depth*log(1 - uniform()));
+    }
 
-                // get a reference to the neutrino
-                Neutrino& neutrino = dynamic_cast<Neutrino&>(interaction.particle);
+    // otherwise we step along the chord, testing for an interaction at every step
+    for (double distance = start; distance < column.getLength(); distance += PROPAGATION_STEP) {
 
-            }
-            else { // we have a lepton
+        // the column depth of this step, which may be cut short by the end of the chord
+        const double step = std::min(PROPAGATION_STEP, column.getLength() - distance);
+        const double grammage = column.getColumnDepth(distance + step) - column.getColumnDepth(distance);
 
-                // get a reference to the lepton
-                Lepton& lepton = dynamic_cast<Lepton&>(interaction.particle);
+        // the probability that we interact somewhere in this step
+        if (uniform() < 1 - exp(-grammage/depth)) {
+            return distance + 0.5*step;
+        }
+    }
 
-            }
+    // we made it out of the chord
+    return std::numeric_limits<double>::infinity();
+}
 
-            // update the interaction with the new position and info
-            // interaction = Interaction(ntrials++, particle, location, direction,
-            //                           depth, current, length, interaction.num_NC, interaction.num_CC);
 
-            // and increment the distance somehow?? whether we interact or not
-            // distance +=
+InteractionList Propagator::propagate(Neutrino& particle) const {
+    // this function takes a Neutrino object, picks a random exit point
+    // and direction, and propagates the particle along the chord through
+    // the Earth that ends there, storing all interactions during propagation
 
+    // initialize a new vector to store interactions of this particle
+    InteractionList interactions;
 
-        } // END: while interaction.depth
+    // get random location on the ice
+    const SphericalCoordinate surface = this->continent.getRandomSurfacePoint();
+    const Vector3<double> up(sin(surface.theta)*cos(surface.phi),
+                             sin(surface.theta)*sin(surface.phi),
+                             cos(surface.theta));
+
+    // and find the surface of the ice below it
+    const double top = EARTH_A + ATMOSPHERE_HEIGHT;
+    double height = 0;
+    if (!this->continent.getSurfaceIntersection(up*top, up*(-1.), top, height)) {
+        std::cerr << "Unable to find the surface at (" << surface.theta << ", " << surface.phi << "). Quitting..." << std::endl;
+        throw std::exception();
+    }
+    const Vector3<double> exit = up*(top - height);
+
+    // a random direction over the outward hemisphere at this point, weighted by the cosine
+    // from the vertical as an isotropic flux crosses the surface
+    const double cost = sqrt(uniform());
+    const double sint = sqrt(1 - cost*cost);
+    const double azimuth = 2*PI*uniform();
+    const Vector3<double> east(-sin(surface.phi), cos(surface.phi), 0);
+    const Vector3<double> north = up.cross(east);
+    const Vector3<double> direction = up*cost + east*(sint*cos(azimuth)) + north*(sint*sin(azimuth));
+
+    // and trace the chord back to where it enters the atmosphere
+    const double b = exit*direction;
+    const double length = b + sqrt(std::max(b*b - exit.sqrMag() + top*top, 0.));
+    const Vector3<double> origin = exit - direction*length;
+
+    // the cumulative column depth along the chord
+    const ColumnDepth column = this->continent.getColumnDepth(origin, direction, length);
+
+    // the direction doesn't change as we propagate
+    const SphericalCoordinate heading = toSpherical(direction);
+
+    // we propagate a copy of the state of the particle rather than the particle itself
+    ParticleState state = getState(particle);
+
+    // jump from interaction to interaction until we leave the chord
+    for (double distance = 0.; ; ) {
+
+        // the distance to the next interaction at the current energy
+        distance = sampleInteractionDistance(column, distance, getInteractionDepth(state),
+                                             this->propagation_mode);
+        if (!(distance <= length))
+            break;
+
+        // pick the current of this interaction and record it
+        const Current current = getRandomCurrent(state);
+        interactions.push_back(Interaction(1, state, toSpherical(origin + direction*distance),
+                                           heading, current, distance));
+
+        // we do not propagate charged leptons (see propagate in Propagator.hpp), so a CC interaction ends the chain
+        if (current == Current::Charged)
+            break;
+
+        // a NC interaction only carries away a fraction y of the energy
+        state.energy += log10(1 - getYFactor(state, current));
+        if (state.energy < this->min_energy)
+            break;
 
-        // if we get here, our particle did not make it to the surface
-        ntrials++; // Peter has ntrials += 2. Why?
+    }
 
-    } // END: while (ntrials)
+    // and the particle leaves with the energy of its state
+    particle.setEnergy(state.energy);
 
     return interactions;
 
@@ -140,10 +252,36 @@ double Propagator::getRandomNeutrinoEnergy() const {
         return this->fixed_energy;
     }
 
-    // otherwise we use the Von Neumann method to sample from the flux distribution
-    // we wrap flux->getFlux() in a lambda and a closure around "this"
-    return sampleFromFunction([this](double E) { return this->flux.getFlux(E); },
-                              this->min_energy, this->max_energy,
-                              this->flux.min_flux, this->flux.max_flux);
+    // otherwise we invert the CDF of the flux at a uniform fraction
+    // between the fractions of the flux at the min/max energy cuts
+    return this->flux.getInverseCDF(this->min_fraction + (this->max_fraction - this->min_fraction)*uniform());
+
+}
+
+
+double Propagator::getGenerationWeight(const double energy) const {
+
+    // a fixed energy cannot be reweighted
+    if (this->fixed_energy > 0) {
+        return 1.;
+    }
+
+    // energies are generated by inverting the piecewise linear CDF between the energy cuts,
+    // so their density is exactly the slope of that CDF normalized between the cuts
+    const double density = this->flux.getCDFSlope(energy)/(this->max_fraction - this->min_fraction);
+
+    // and energies that are never generated (outside of the cuts or the flux) carry no weight
+    if ((energy < this->min_energy) || (energy > this->max_energy) || !(density > 0))
+        return 0.;
+
+    return 1./density;
+
+}
+
+
+double Propagator::getGenerationAcceptance() const {
+
+    // the cosine weighted hemisphere integrates to pi
+    return PI*this->continent.getIceArea();
 
 }
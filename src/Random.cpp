@@ -1,61 +1,186 @@
+#include <math.h>
+#include <atomic>
 #include <Random.hpp>
 
-#include <boost/random/uniform_int.hpp>
-#include <boost/random/uniform_real.hpp>
-#include <boost/random/mersenne_twister.hpp>
-#include <boost/random/variate_generator.hpp>
-#include <boost/random/normal_distribution.hpp>
-#include <boost/random/poisson_distribution.hpp>
+using namespace anita;
 
-boost::mt19937 gen;
+// the multipliers and key increments of Philox4x32 from Salmon et al.
+static constexpr std::uint32_t PHILOX_M0 = 0xD2511F53;
+static constexpr std::uint32_t PHILOX_M1 = 0xCD9E8D57;
+static constexpr std::uint32_t PHILOX_W0 = 0x9E3779B9;
+static constexpr std::uint32_t PHILOX_W1 = 0xBB67AE85;
 
-double uniform(double min, double max) {
+Philox::Counter Philox::generate(Counter ctr, Key key) {
+
+    // ten rounds of the Philox bijection, bumping the key between rounds
+    for (int round = 0; round < 10; round++) {
+
+        // 32x32 -> 64 bit products of the first and third words
+        const std::uint64_t p0 = static_cast<std::uint64_t>(PHILOX_M0)*ctr[0];
+        const std::uint64_t p1 = static_cast<std::uint64_t>(PHILOX_M1)*ctr[2];
 
-  // NOTE: boost::uniform_real is a closed range i.e. dist(0, 2) == [0, 2]
-  // unlike open range of normal C/C++ RNG's
-  boost::uniform_real<double> dist(min, max);
+        ctr = {{ static_cast<std::uint32_t>(p1 >> 32) ^ ctr[1] ^ key[0], static_cast<std::uint32_t>(p1),
+                 static_cast<std::uint32_t>(p0 >> 32) ^ ctr[3] ^ key[1], static_cast<std::uint32_t>(p0) }};
 
-  // we use a global generator to avoid initialize a Mersenne Twister each invocation
-  boost::variate_generator<boost::mt19937&, boost::uniform_real<double>> uni(gen, dist);
+        key[0] += PHILOX_W0;
+        key[1] += PHILOX_W1;
+    }
 
-  return uni();
+    return ctr;
 }
 
-int uniformInt(int min, int max) {
+void RandomStream::reset(const std::uint64_t seed, const std::uint64_t event) {
 
-    // NOTE: boost::uniform_int is a closed range i.e. dist(0, 2) == [0, 1, 2]
-    // unlike open range of normal C/C++ RNG's
-    boost::uniform_int<int> dist(min, max);
+    // the key is the run seed
+    this->key = {{ static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32) }};
 
-    // we use a global generator to avoid initialize a Mersenne Twister each invocation
-    boost::variate_generator<boost::mt19937&, boost::uniform_int<int>> uni(gen, dist);
+    // the low half of the counter numbers the blocks, the high half is the event
+    this->counter = {{ 0, 0, static_cast<std::uint32_t>(event), static_cast<std::uint32_t>(event >> 32) }};
 
-    return uni();
+    // and mark the current block as used up
+    this->index = 4;
+    this->spare = 0;
+    this->has_spare = false;
 }
 
-int poisson(double mean) {
+void RandomStream::refill() {
 
-  // poisson distribution generator
-  boost::poisson_distribution<int> dist(mean);
+    // generate the block for the current counter
+    this->block = Philox::generate(this->counter, this->key);
+    this->index = 0;
 
-  // we use a global generator to avoid initialize a Mersenne Twister each invocation
-  boost::variate_generator<boost::mt19937&,
-                           boost::poisson_distribution<int>> pois(gen, dist);
+    // and increment the 64-bit block number
+    if (++this->counter[0] == 0)
+        ++this->counter[1];
+}
+
+double RandomStream::uniform(const double min, const double max) {
+
+    // build a 53-bit mantissa from two 32-bit words - this is in [0, 1)
+    const std::uint64_t bits = ((static_cast<std::uint64_t>(this->next()) << 32) | this->next()) >> 11;
+    const double u = static_cast<double>(bits)*(1./9007199254740992.);
 
-  // return a poisson sampled variable
-  return pois();
+    return min + (max - min)*u;
 }
 
-double gaussian(double mean, double stdev) {
+int RandomStream::uniformInt(const int min, const int max) {
+
+    // the number of possible values, which is inclusive of max
+    const std::uint64_t range = static_cast<std::uint64_t>(static_cast<std::int64_t>(max) - min) + 1;
+
+    // Lemire's multiply-and-reject to map 32 random bits onto [0, range) without bias
+    const std::uint64_t threshold = (UINT64_C(0x100000000) - range) % range;
+    std::uint64_t product = static_cast<std::uint64_t>(this->next())*range;
+    while ((product & UINT64_C(0xFFFFFFFF)) < threshold) {
+        product = static_cast<std::uint64_t>(this->next())*range;
+    }
+
+    return static_cast<int>(static_cast<std::int64_t>(min) + static_cast<std::int64_t>(product >> 32));
+}
+
+int RandomStream::poisson(const double mean) {
+
+    // for small means, we multiply uniforms until we drop below exp(-mean)
+    if (mean < 10) {
+        const double limit = exp(-mean);
+        double product = this->uniform();
+        int k = 0;
+        while (product > limit) {
+            product *= this->uniform();
+            k++;
+        }
+        return k;
+    }
+
+    // otherwise we use the transformed rejection method (PTRS) of
+    // W. Hormann, "The transformed rejection method for generating Poisson random variables" (1993)
+    const double slam = sqrt(mean);
+    const double loglam = log(mean);
+    const double b = 0.931 + 2.53*slam;
+    const double a = -0.059 + 0.02483*b;
+    const double invalpha = 1.1239 + 1.1328/(b - 3.4);
+    const double vr = 0.9277 - 3.6224/(b - 2);
+
+    while (true) {
+        const double U = this->uniform() - 0.5;
+        const double V = this->uniform();
+        const double us = 0.5 - fabs(U);
+        const double k = floor((2*a/us + b)*U + mean + 0.43);
+
+        // the squeeze - accepts most samples
+        if ((us >= 0.07) && (V <= vr))
+            return static_cast<int>(k);
+
+        // reject the tails
+        if ((k < 0) || ((us < 0.013) && (V > us)))
+            continue;
+
+        // and the full acceptance test
+        if (log(V) + log(invalpha) - log(a/(us*us) + b) <= -mean + k*loglam - lgamma(k + 1))
+            return static_cast<int>(k);
+    }
+}
+
+double RandomStream::gaussian(const double mean, const double stdev) {
+
+    // Box-Muller produces normal variates in pairs, so use the spare if we have one
+    if (this->has_spare) {
+        this->has_spare = false;
+        return mean + stdev*this->spare;
+    }
 
-  // normal distribution - mean and stdev
-  boost::normal_distribution<double> dist(mean, stdev);
+    // 1 - uniform() is in (0, 1] so the log is always finite
+    const double r = sqrt(-2*log(1. - this->uniform()));
+    const double angle = 2*M_PI*this->uniform();
 
-  // we use a global generator to avoid initialize a Mersenne Twister each invocation
-  boost::variate_generator<boost::mt19937&,
-                           boost::normal_distribution<double>> norm(gen, dist);
+    this->spare = r*sin(angle);
+    this->has_spare = true;
 
-  return norm();
+    return mean + stdev*r*cos(angle);
+}
+
+// the seed of the current run
+static std::atomic<std::uint64_t> run_seed(0);
+
+// threads that draw outside of an event are given their own stream in the top half of
+// the event space, so they never overlap each other or any event
+static std::atomic<std::uint64_t> thread_streams(0);
+static constexpr std::uint64_t THREAD_STREAM_OFFSET = UINT64_C(0x8000000000000000);
+
+RandomStream& getRandomStream() {
+    thread_local RandomStream stream(run_seed.load(), THREAD_STREAM_OFFSET + thread_streams++);
+    return stream;
+}
+
+void setSeed(std::uint64_t seed) {
+    run_seed = seed;
+
+    // the calling thread's stream may already exist, so restart it with the new seed
+    getRandomStream().reset(seed, THREAD_STREAM_OFFSET + thread_streams++);
+}
+
+std::uint64_t getSeed() {
+    return run_seed.load();
+}
+
+void beginEvent(std::uint64_t event) {
+    getRandomStream().reset(run_seed.load(), event);
+}
+
+double uniform(double min, double max) {
+    return getRandomStream().uniform(min, max);
+}
+
+int uniformInt(int min, int max) {
+    return getRandomStream().uniformInt(min, max);
+}
+
+int poisson(double mean) {
+    return getRandomStream().poisson(mean);
+}
+
+double gaussian(double mean, double stdev) {
+    return getRandomStream().gaussian(mean, stdev);
 }
 
 double sampleFromFunction(std::function<double(double)> f,
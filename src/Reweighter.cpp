@@ -0,0 +1,76 @@
+#include <math.h>
+#include <iostream>
+#include <Reweighter.hpp>
+
+using namespace anita;
+
+Reweighter::Reweighter(const std::vector<std::string> fluxes, const int N)
+    : names(fluxes), ngenerated(N), rates(fluxes.size(), 0.), squares(fluxes.size(), 0.) {
+
+    // we need to know how many neutrinos the weights are shared between
+    if (N <= 0) {
+        std::cerr << "Cannot reweight " << N << " generated neutrinos. Quitting..." << std::endl;
+        throw std::exception();
+    }
+
+    // load every flux model once
+    for (const std::string& name : fluxes) {
+        this->models.emplace_back(new readers::Flux(name));
+    }
+
+}
+
+
+void Reweighter::begin(const unsigned int nworkers) {
+
+    // a fresh set of sums for every worker
+    Accumulator empty;
+    empty.weights.assign(this->models.size(), 0.);
+    empty.squares.assign(this->models.size(), 0.);
+    this->accumulators.assign(nworkers, empty);
+
+}
+
+
+double Reweighter::getWeight(const std::size_t model, const double energy, const double weight) const {
+    return this->models.at(model)->getDensity(energy)*weight/static_cast<double>(this->ngenerated);
+}
+
+
+void Reweighter::consume(const unsigned int worker, const int event, InteractionList& interactions) {
+
+    // events without any interactions don't contribute
+    if (interactions.empty()) return;
+
+    // the first interaction is at the energy the neutrino was generated with
+    const double energy = interactions.front().particle.energy;
+    const double weight = interactions.front().weight;
+
+    // and we only touch the sums of this worker
+    Accumulator& accumulator = this->accumulators.at(worker);
+    for (std::size_t i = 0; i < this->models.size(); i++) {
+        const double w = this->getWeight(i, energy, weight);
+        accumulator.weights[i] += w;
+        accumulator.squares[i] += w*w;
+    }
+
+}
+
+
+void Reweighter::finish() {
+
+    // add up the sums of every worker
+    for (const Accumulator& accumulator : this->accumulators) {
+        for (std::size_t i = 0; i < this->models.size(); i++) {
+            this->rates[i] += accumulator.weights[i];
+            this->squares[i] += accumulator.squares[i];
+        }
+    }
+    this->accumulators.clear();
+
+}
+
+
+double Reweighter::getError(const std::size_t model) const {
+    return sqrt(this->squares.at(model));
+}
@@ -0,0 +1,145 @@
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <exception>
+#include <Utils.hpp>
+#include <Scheduler.hpp>
+
+using namespace anita;
+
+Scheduler::Scheduler(const unsigned int threads)
+    : nthreads(threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency())) {}
+
+
+// pop the next event from the front of a range
+int Scheduler::pop(WorkRange& range) {
+
+    std::lock_guard<std::mutex> guard(range.lock);
+
+    // this range has run dry
+    if (range.begin >= range.end)
+        return -1;
+
+    // otherwise we take the first event
+    return range.begin++;
+}
+
+
+// steal the back half of the largest range owned by another worker
+bool Scheduler::steal(WorkRange* ranges, const unsigned int worker) const {
+
+    // we keep trying until there is nothing left to steal
+    while (true) {
+
+        // find the victim with the most remaining events - this is only
+        // approximate as the other workers keep popping while we look
+        unsigned int victim = worker;
+        int most = 0;
+        for (unsigned int i = 1; i < this->nthreads; i++) {
+            const unsigned int candidate = (worker + i) % this->nthreads;
+            std::lock_guard<std::mutex> guard(ranges[candidate].lock);
+            const int remaining = ranges[candidate].end - ranges[candidate].begin;
+            if (remaining > most) {
+                most = remaining;
+                victim = candidate;
+            }
+        }
+
+        // there is no work left anywhere
+        if (victim == worker)
+            return false;
+
+        // take the back half (rounded up) of the victim's range
+        int begin = 0; int end = 0;
+        {
+            std::lock_guard<std::mutex> guard(ranges[victim].lock);
+            const int remaining = ranges[victim].end - ranges[victim].begin;
+
+            // somebody beat us to it - look again
+            if (remaining <= 0)
+                continue;
+
+            end = ranges[victim].end;
+            begin = end - (remaining + 1)/2;
+            ranges[victim].end = begin;
+        }
+
+        // and hand it to ourselves. We never hold two locks at once
+        // so this can't deadlock against another thief
+        std::lock_guard<std::mutex> guard(ranges[worker].lock);
+        ranges[worker].begin = begin;
+        ranges[worker].end = end;
+        return true;
+    }
+}
+
+
+// run `task` once for every event in [0, nevents)
+void Scheduler::run(const int nevents, const Task& task, const Setup& setup) const {
+
+    // there is nothing to do
+    if (nevents <= 0)
+        return;
+
+    // allocate one range per worker, each on its own cache line(s),
+    // and split the events into contiguous blocks
+    auto ranges = utils::makeAligned<WorkRange>(this->nthreads);
+    for (unsigned int i = 0; i < this->nthreads; i++) {
+        ranges[i].begin = static_cast<int>((static_cast<long>(nevents)*i)/this->nthreads);
+        ranges[i].end = static_cast<int>((static_cast<long>(nevents)*(i + 1))/this->nthreads);
+    }
+
+    // the first exception thrown by any worker, and a flag to stop the others
+    std::exception_ptr error;
+    std::mutex error_lock;
+    std::atomic<bool> failed(false);
+
+    // the loop run by every worker
+    auto work = [&](const unsigned int worker) {
+        try {
+            // let the caller initialize any per-thread state
+            if (setup)
+                setup(worker);
+
+            while (!failed.load(std::memory_order_relaxed)) {
+
+                // take our next event, or steal some more if we have run out
+                const int event = pop(ranges[worker]);
+                if (event < 0) {
+                    if (!this->steal(ranges.get(), worker))
+                        break;
+                    continue;
+                }
+
+                // and process the event
+                task(worker, event);
+            }
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> guard(error_lock);
+            if (!error)
+                error = std::current_exception();
+            failed = true;
+        }
+    };
+
+    // launch the helper threads - the calling thread is always worker 0
+    std::vector<std::thread> threads;
+    threads.reserve(this->nthreads - 1);
+    for (unsigned int i = 1; i < this->nthreads; i++) {
+        threads.emplace_back(work, i);
+    }
+
+    // do our share of the work and wait for everyone else
+    work(0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // pass any failure on to the caller
+    if (error)
+        std::rethrow_exception(error);
+
+}
@@ -0,0 +1,133 @@
+#include <math.h>
+#include <iostream>
+#include <Random.hpp>
+#include <SurfaceSampler.hpp>
+
+using namespace anita;
+
+AliasTable::AliasTable(const std::vector<double>& weights)
+    : probability(weights.size()), alias(weights.size()) {
+
+    const std::size_t n = weights.size();
+
+    // we need something to sample from
+    if (n == 0) {
+        std::cerr << "Cannot build an alias table with no entries. Quitting..." << std::endl;
+        throw std::exception();
+    }
+
+    // the mean weight
+    double total = 0;
+    for (const double weight : weights) total += weight;
+    const double mean = total/static_cast<double>(n);
+
+    // scale the weights so that the average is one, and split them into those
+    // that are under-full (small) and over-full (large)
+    std::vector<double> scaled(n);
+    std::vector<std::uint32_t> small, large;
+    for (std::size_t i = 0; i < n; i++) {
+        scaled[i] = weights[i]/mean;
+        if (scaled[i] < 1) small.push_back(static_cast<std::uint32_t>(i));
+        else large.push_back(static_cast<std::uint32_t>(i));
+    }
+
+    // fill each under-full entry from an over-full one (Vose's algorithm)
+    while (!small.empty() && !large.empty()) {
+        const std::uint32_t less = small.back(); small.pop_back();
+        const std::uint32_t more = large.back(); large.pop_back();
+
+        this->probability[less] = static_cast<float>(scaled[less]);
+        this->alias[less] = more;
+
+        // the over-full entry gave away what the under-full one was missing
+        scaled[more] = (scaled[more] + scaled[less]) - 1;
+        if (scaled[more] < 1) small.push_back(more);
+        else large.push_back(more);
+    }
+
+    // whatever is left over is full (up to rounding)
+    for (const std::uint32_t i : large) { this->probability[i] = 1; this->alias[i] = i; }
+    for (const std::uint32_t i : small) { this->probability[i] = 1; this->alias[i] = i; }
+}
+
+std::size_t AliasTable::sample() const {
+
+    // use one uniform for both the entry and the coin flip
+    const double u = uniform()*static_cast<double>(this->probability.size());
+    const std::size_t i = static_cast<std::size_t>(u);
+
+    return (u - static_cast<double>(i)) < this->probability[i] ? i : this->alias[i];
+}
+
+// the authalic function q of Snyder, Pg. 16, Eq. 3-12
+static double authalicQ(const double lat) {
+    const double esin = EARTH_E*sin(lat);
+    return (1 - EARTH_E*EARTH_E)*(sin(lat)/(1 - esin*esin) - log((1 - esin)/(1 + esin))/(2*EARTH_E));
+}
+
+SurfaceSampler::SurfaceSampler(const readers::Bedmap& bm)
+    : bedmap(bm), ice_area(0),
+      // the area of the ellipsoid between latitude L and the pole is pi a^2 (q_p - q(L))
+      cap_area(PI*EARTH_A*EARTH_A*(authalicQ(PI/2) - authalicQ(PI/3))),
+      table(this->findIceCells()) {}
+
+std::vector<double> SurfaceSampler::findIceCells() {
+
+    const int ncols = this->bedmap.getNumColumns();
+    const int nrows = this->bedmap.getNumRows();
+
+    // the (x, y) of the center of every cell in a row, and the Bedmap2 values there
+    std::vector<double> x(static_cast<std::size_t>(ncols)), y(static_cast<std::size_t>(ncols));
+    std::vector<readers::BedmapPoint> points(static_cast<std::size_t>(ncols));
+
+    // the area of every ice cell
+    std::vector<double> areas;
+
+    for (int row = 0; row < nrows; row++) {
+
+        // query every cell in this row at once
+        for (int col = 0; col < ncols; col++) {
+            const std::pair<double, double> center = this->bedmap.getCellCenter(col, row);
+            x[static_cast<std::size_t>(col)] = center.first;
+            y[static_cast<std::size_t>(col)] = center.second;
+        }
+        this->bedmap.queryAtPoints(x.size(), x.data(), y.data(), points.data());
+
+        // and keep the cells that are grounded ice or ice shelf
+        for (int col = 0; col < ncols; col++) {
+            const readers::BedmapPoint& point = points[static_cast<std::size_t>(col)];
+            if (point.mask == readers::IceMask::Ocean) continue;
+
+            // a 1 km^2 cell on the map has area 1/k^2 on the ellipsoid
+            const double k = this->bedmap.getScaleFactor(point.x, point.y);
+            areas.push_back(1./(k*k));
+            this->cells.push_back(static_cast<std::uint32_t>(row*ncols + col));
+            this->ice_area += areas.back();
+        }
+    }
+
+    // there must be some ice...
+    if (this->cells.empty()) {
+        std::cerr << "Unable to find any ice in the BEDMAP2 icemask. Quitting..." << std::endl;
+        throw std::exception();
+    }
+
+    return areas;
+}
+
+std::pair<double, double> SurfaceSampler::sample() const {
+
+    // pick a cell weighted by its area
+    const std::uint32_t cell = this->cells[this->table.sample()];
+    const int ncols = this->bedmap.getNumColumns();
+    const std::pair<double, double> center = this->bedmap.getCellCenter(static_cast<int>(cell) % ncols,
+                                                                        static_cast<int>(cell) / ncols);
+
+    // a uniform point within the cell
+    const double x = center.first + uniform(-0.5, 0.5);
+    const double y = center.second + uniform(-0.5, 0.5);
+
+    // and convert back to (theta, phi) with phi in [0, 2pi)
+    const std::pair<double, double> coord = this->bedmap.BEDMAPLocationToCoord(x, y);
+    return std::make_pair(coord.first, coord.second < 0 ? coord.second + 2*PI : coord.second);
+}
@@ -0,0 +1,135 @@
+#include <array>
+#include <math.h>
+#include <iostream>
+#include <algorithm>
+#include <Constants.hpp>
+#include <CrossSectionTable.hpp>
+
+using namespace anita;
+
+constexpr double CrossSectionTable::TOLERANCE;
+
+
+CrossSectionTable::CrossSectionTable(const CrossSectionModel xsmodel, const double minE, const double maxE,
+                                     const std::size_t npoints)
+    : model(xsmodel), min_energy(minE), max_energy(maxE),
+      inverse_step(static_cast<double>(npoints - 1)/(maxE - minE)), max_error(0) {
+
+    // we need at least one interval to interpolate over
+    if ((npoints < 2) || !(maxE > minE)) {
+        std::cerr << "Invalid cross section table of " << npoints << " points over ["
+                  << minE << ", " << maxE << "]. Quitting..." << std::endl;
+        throw std::exception();
+    }
+
+    // evaluate the parametrizations at every energy
+    this->charged.resize(npoints);
+    this->neutral.resize(npoints);
+    this->depth.resize(npoints);
+    for (std::size_t i = 0; i < npoints; i++) {
+        const double E = minE + static_cast<double>(i)/this->inverse_step;
+        this->charged[i] = getChargedCurrentCrossSection(E, xsmodel);
+        this->neutral[i] = getNeutralCurrentCrossSection(E, xsmodel);
+        this->depth[i] = this->getExactDepth(E);
+    }
+
+    // and check the interpolation in the middle of every interval, where it is worst
+    for (std::size_t i = 0; i + 1 < npoints; i++) {
+        const double E = minE + (static_cast<double>(i) + 0.5)/this->inverse_step;
+        const double errors[3] = {
+            this->interpolate(this->charged, E)/getChargedCurrentCrossSection(E, xsmodel) - 1,
+            this->interpolate(this->neutral, E)/getNeutralCurrentCrossSection(E, xsmodel) - 1,
+            this->interpolate(this->depth, E)/this->getExactDepth(E) - 1
+        };
+        for (const double error : errors) {
+            this->max_error = std::max(this->max_error, fabs(error));
+        }
+    }
+
+    if (!(this->max_error <= TOLERANCE)) {
+        std::cerr << "Cross section table has a relative error of " << this->max_error
+                  << " (more than " << TOLERANCE << "). Quitting..." << std::endl;
+        throw std::exception();
+    }
+}
+
+
+// every model is tabulated once per process, the first time that any table is needed
+const CrossSectionTable& CrossSectionTable::getTable(const CrossSectionModel model) {
+
+    static const std::array<CrossSectionTable, 7> tables = {{
+            CrossSectionTable(CrossSectionModel::ConnollyLower),
+            CrossSectionTable(CrossSectionModel::ConnollyMiddle),
+            CrossSectionTable(CrossSectionModel::ConnollyUpper),
+            CrossSectionTable(CrossSectionModel::ALLM),
+            CrossSectionTable(CrossSectionModel::ASW),
+            CrossSectionTable(CrossSectionModel::Sarkar),
+            CrossSectionTable(CrossSectionModel::CKMT)
+        }};
+
+    // the tables are in the order of the enum
+    return tables.at(static_cast<std::size_t>(model));
+}
+
+
+// the interaction depth from the parametrizations
+double CrossSectionTable::getExactDepth(const double E) const {
+    return 1./(N_A*(getChargedCurrentCrossSection(E, this->model) + getNeutralCurrentCrossSection(E, this->model)));
+}
+
+
+// linearly interpolate between the two energies either side of E
+double CrossSectionTable::interpolate(const std::vector<double>& values, const double E) const {
+
+    const double u = (E - this->min_energy)*this->inverse_step;
+    const std::size_t i = std::min(static_cast<std::size_t>(u), values.size() - 2);
+    const double fraction = u - static_cast<double>(i);
+
+    return values[i] + fraction*(values[i + 1] - values[i]);
+}
+
+
+double CrossSectionTable::getCrossSection(const Current current, const double E) const {
+
+    if (current == Current::Charged) {
+        return this->contains(E) ? this->interpolate(this->charged, E) : getChargedCurrentCrossSection(E, this->model);
+    }
+    else {
+        return this->contains(E) ? this->interpolate(this->neutral, E) : getNeutralCurrentCrossSection(E, this->model);
+    }
+}
+
+
+void CrossSectionTable::getCrossSections(const Current current, const double* energies, double* xsections,
+                                         const std::size_t n) const {
+
+    // pick the table once for the whole batch
+    const std::vector<double>& values = current == Current::Charged ? this->charged : this->neutral;
+
+    for (std::size_t i = 0; i < n; i++) {
+        xsections[i] = this->contains(energies[i]) ? this->interpolate(values, energies[i])
+            : this->getCrossSection(current, energies[i]);
+    }
+}
+
+
+double CrossSectionTable::getInteractionDepth(const double E) const {
+    return this->contains(E) ? this->interpolate(this->depth, E) : this->getExactDepth(E);
+}
+
+
+double CrossSectionTable::getInteractionLength(const double E, const Material material) const {
+    return this->getInteractionDepth(E)/(CM_PER_KM*getMaterialDensity(material));
+}
+
+
+void CrossSectionTable::getInteractionLengths(const Material material, const double* energies, double* lengths,
+                                              const std::size_t n) const {
+
+    // the density is the same for the whole batch
+    const double scale = 1./(CM_PER_KM*getMaterialDensity(material));
+
+    for (std::size_t i = 0; i < n; i++) {
+        lengths[i] = scale*this->getInteractionDepth(energies[i]);
+    }
+}
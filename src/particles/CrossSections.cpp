@@ -18,9 +18,9 @@ double anita::getChargedCurrentCrossSection(const double E, const CrossSectionMo
         // this stores the final cross section value
         double xsection = 0.;
 
-        // iterate over the polynomial powers
+        // iterate over the polynomial powers - E is already in log10(eV)
         for (int i = 0 ; i < 4; i++){
-            xsection += coeff[i]*pow(log10(E), i);
+            xsection += coeff[i]*pow(E, i);
         }
         // and take a final power
         return pow(10, xsection);
@@ -91,9 +91,9 @@ double anita::getNeutralCurrentCrossSection(const double E, const CrossSectionMo
         // this stores the final cross section value
         double xsection = 0.;
 
-        // iterate over the polynomial powers
+        // iterate over the polynomial powers - E is already in log10(eV)
         for (int i = 0 ; i < 4; i++){
-            xsection += coeff[i]*pow(log10(E), i);
+            xsection += coeff[i]*pow(E, i);
         }
         // and take a final power
         return pow(10, xsection);
@@ -13,8 +13,8 @@ std::pair<double, InteractionType> Electron::getInteractionLength(const double d
 }
 
 /// Return the primary particle from a neutrino interaction
-std::unique_ptr<Particle> Electron::getInteractionProducts(const InteractionType interaction) const {
+ParticlePtr<Particle> Electron::getInteractionProducts(const InteractionType interaction) const {
 
     // TODO; replace
-    return std::make_unique<ElectronNeutrino>(18.);
+    return makeParticle<ElectronNeutrino>(18.);
 }
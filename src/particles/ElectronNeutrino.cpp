@@ -7,8 +7,8 @@
 using namespace anita;
 
 /// Return the primary particle from a neutrino interaction
-std::unique_ptr<Particle> ElectronNeutrino::getInteractionProducts(const Current current) const {
+ParticlePtr<Particle> ElectronNeutrino::getInteractionProducts(const Current current) const {
 
     // TODO; replace
-    return std::make_unique<Electron>(18.);
+    return makeParticle<Electron>(18.);
 }
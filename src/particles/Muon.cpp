@@ -13,8 +13,8 @@ std::pair<double, InteractionType> Muon::getInteractionLength(const double densi
 }
 
 /// Return the primary particle from a neutrino interaction
-std::unique_ptr<Particle> Muon::getInteractionProducts(const InteractionType interaction) const {
+ParticlePtr<Particle> Muon::getInteractionProducts(const InteractionType interaction) const {
 
     // TODO; replace
-    return std::make_unique<MuonNeutrino>(18.);
+    return makeParticle<MuonNeutrino>(18.);
 }
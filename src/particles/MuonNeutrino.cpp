@@ -7,8 +7,8 @@
 using namespace anita;
 
 /// Return the primary particle from a neutrino interaction
-std::unique_ptr<Particle> MuonNeutrino::getInteractionProducts(const Current current) const {
+ParticlePtr<Particle> MuonNeutrino::getInteractionProducts(const Current current) const {
 
     // TODO; replace
-    return std::make_unique<Muon>(18.);
+    return makeParticle<Muon>(18.);
 }
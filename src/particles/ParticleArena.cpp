@@ -0,0 +1,65 @@
+#include <iostream>
+#include <Particle.hpp>
+#include <ParticleArena.hpp>
+
+using namespace anita;
+
+constexpr std::size_t ParticleArena::BLOCK_SIZE;
+
+
+// destroy the particle and give its memory back
+void ParticleDeleter::operator()(Particle* particle) const {
+
+    // particles without an arena came from new
+    if (!this->arena) {
+        delete particle;
+        return;
+    }
+
+    particle->~Particle();
+    this->arena->release();
+}
+
+
+// every thread gets its own arena on first use
+ParticleArena& ParticleArena::local() {
+    thread_local ParticleArena arena;
+    return arena;
+}
+
+
+void* ParticleArena::allocate(const std::size_t size, const std::size_t alignment) {
+
+    // we only ever hold particles, which are much smaller than a block
+    if (size + alignment > BLOCK_SIZE) {
+        std::cerr << "A particle of " << size << " bytes does not fit in a ParticleArena. Quitting..." << std::endl;
+        throw std::exception();
+    }
+
+    // the offset in the current block at which this would start
+    std::size_t start = (this->offset + alignment - 1)/alignment*alignment;
+
+    // if it doesn't fit in the current block, move to the next
+    if ((this->block >= this->blocks.size()) || (start + size > BLOCK_SIZE)) {
+        if (this->block < this->blocks.size()) this->block++;
+        if (this->block == this->blocks.size()) {
+            this->blocks.emplace_back(new unsigned char[BLOCK_SIZE]);
+        }
+        start = 0;
+    }
+
+    // new[] gives memory aligned for any fundamental type, so the offset is enough
+    this->offset = start + size;
+    return this->blocks[this->block].get() + start;
+}
+
+
+// rewind the arena once every particle has gone
+void ParticleArena::release() {
+
+    this->live--;
+    if (this->live == 0) {
+        this->block = 0;
+        this->offset = 0;
+    }
+}
@@ -0,0 +1,152 @@
+#include <array>
+#include <math.h>
+#include <iostream>
+#include <Random.hpp>
+#include <Constants.hpp>
+#include <Lepton.hpp>
+#include <Neutrino.hpp>
+#include <ParticleState.hpp>
+#include <CrossSectionTable.hpp>
+
+using namespace anita;
+
+// only neutrinos have cross sections
+static void requireNeutrino(const ParticleState& state, const char* name) {
+    if (!state.neutrino) {
+        std::cerr << name << " is only defined for neutrinos. Quitting..." << std::endl;
+        throw std::exception();
+    }
+}
+
+
+ParticleState anita::getState(const Particle& particle) {
+
+    // the flag tells us which half of the hierarchy we are in, so no dynamic_cast is needed
+    const Flavor flavor = particle.isNeutrino() ? static_cast<const Neutrino&>(particle).flavor
+        : static_cast<const Lepton&>(particle).getFlavor();
+
+    return ParticleState{flavor, particle.isNeutrino(), particle.getEnergy()};
+}
+
+
+ParticlePtr<Particle> anita::createParticle(const ParticleState& state) {
+
+    switch (state.flavor) {
+    case Flavor::Electron:
+        if (state.neutrino) return makeParticle<ElectronNeutrino>(state.energy);
+        return makeParticle<Electron>(state.energy);
+    case Flavor::Muon:
+        if (state.neutrino) return makeParticle<MuonNeutrino>(state.energy);
+        return makeParticle<Muon>(state.energy);
+    case Flavor::Tau:
+        if (state.neutrino) return makeParticle<TauNeutrino>(state.energy);
+        return makeParticle<Tau>(state.energy);
+    }
+
+    std::cerr << "Unknown Flavor in createParticle. Quitting..." << std::endl;
+    throw std::exception();
+}
+
+
+double anita::getEnergyLoss(const ParticleState& state) {
+
+    // only tau neutrinos have an energy loss so far
+    if (!state.neutrino || (state.flavor != Flavor::Tau)) {
+        return 0;
+    }
+
+    // we provide the various 3-parameter parametrizations in
+    // the appendix of arXiv::1704.00050
+    // the following arrays are {beta_0, beta_1, beta_2}
+    // Beta(E) = beta0 + b1*ln(E/E0) + b2*(ln(E/E0))^2
+    // where E0 = 10^10 GeV and E is in GeV
+    //
+    // with E and E0 in log10(eV) space, this is
+    // beta0 + beta1*ln(10)*(E - 19) beta2*(ln(10)*(E -19))^2
+
+    // we create a lambda expression and wrap E in a closure
+    // so that we only need to provide the coefficients
+    auto Evaluate = [E = state.energy](std::array<double, 3> coeff) -> double {
+
+        // convert base 10 energies to natural logarithm
+        const double En = log(10)*(E - 19);
+
+        // and return
+        return coeff[0] + coeff[1]*En + coeff[2]*En*En;
+
+    };
+
+    switch (Neutrino::getEnergyLossModel()) {
+    case EnergyLossModel::BDHM: return Evaluate({0.425, 4.04e-2, 1.12e-3});
+    case EnergyLossModel::Soyez: return Evaluate({0.371, 3.20e-2, 9.54e-4});
+    case EnergyLossModel::Soyez_ASW: return Evaluate({0.461, 3.90e-2, 1.13e-3});
+    case EnergyLossModel::ALLM: return Evaluate({1.020, 0.210, 1.51e-2});
+    }
+
+    // we have an unknown energy loss model
+    std::cerr << "Unknown energy loss model. Quitting.." << std::endl;
+    throw std::exception();
+}
+
+
+double anita::getCrossSection(const ParticleState& state, const Current current) {
+
+    requireNeutrino(state, "getCrossSection");
+
+    // the cross sections are tabulated for every model
+    if ((current == Current::Charged) || (current == Current::Neutral)) {
+        return CrossSectionTable::getTable(Neutrino::getCrossSectionModel()).getCrossSection(current, state.energy);
+    }
+
+    std::cerr << "Unknown current interaction. Quitting..." << std::endl;
+    throw std::exception();
+}
+
+
+double anita::getInteractionDepth(const ParticleState& state) {
+
+    requireNeutrino(state, "getInteractionDepth");
+
+    // per nucleon, so this is 1/(N_A sigma)
+    return CrossSectionTable::getTable(Neutrino::getCrossSectionModel()).getInteractionDepth(state.energy);
+}
+
+
+std::pair<double, InteractionType> anita::getInteractionLength(const ParticleState& state, const double density) {
+
+    // charged leptons only decay so far
+    if (!state.neutrino) {
+        return std::make_pair(0, InteractionType::Decay);
+    }
+
+    // the interaction depth is in g/cm^2 so this is in km
+    return std::make_pair(getInteractionDepth(state)/(CM_PER_KM*density), InteractionType::Current);
+}
+
+
+Current anita::getRandomCurrent(const ParticleState& state) {
+
+    const double charged = getCrossSection(state, Current::Charged);
+    const double neutral = getCrossSection(state, Current::Neutral);
+
+    return uniform()*(charged + neutral) < charged ? Current::Charged : Current::Neutral;
+}
+
+
+double anita::getYFactor(const ParticleState& state, const Current current) {
+
+    requireNeutrino(state, "getYFactor");
+
+    // we use the pre-loaded final state table to draw a random y-factor
+    // as the data files have pre-sampled randomness in them. The first
+    // dimension of each final state is y
+    if (current == Current::Charged) {
+        return Neutrino::chargedTable().evaluate(state.energy, 0);
+    }
+    else if (current == Current::Neutral) {
+        return Neutrino::neutralTable().evaluate(state.energy, 0);
+    }
+
+    std::cerr << "Unknown current in getYFactor" << std::endl;
+    throw std::exception();
+}
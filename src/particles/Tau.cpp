@@ -15,8 +15,8 @@ std::pair<double, InteractionType> Tau::getInteractionLength(const double densit
 
 
 /// Return the primary particle from a neutrino interaction
-std::unique_ptr<Particle> Tau::getInteractionProducts(const InteractionType interaction) const {
+ParticlePtr<Particle> Tau::getInteractionProducts(const InteractionType interaction) const {
 
     // TODO; replace
-    return std::make_unique<TauNeutrino>(18.);
+    return makeParticle<TauNeutrino>(18.);
 }
@@ -1,38 +1,92 @@
 #include <math.h>
 #include <string>
 #include <tuple>
+#include <limits>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <NuMC.hpp>
 #include <Utils.hpp>
 #include <algorithm>
 #include <Constants.hpp>
 #include <readers/Bedmap.hpp>
+#include <readers/Bilinear.hpp>
+#include <readers/Stereographic.hpp>
 
 using namespace anita::readers;
 
-Bedmap::~Bedmap() {
+// the layout of the header at the start of every preprocessed raster
+// the header is 64 bytes so that the values that follow it are cache-line aligned
+struct PreprocessedHeader {
+    char magic[8];              // always "NUMCBM2"
+    std::uint32_t version;      // the version of this layout
+    std::uint32_t ncols;        // the dimensions of the raster
+    std::uint32_t nrows;
+    std::uint32_t reserved;
+    std::uint64_t source_size;  // the size and modification time of the raw file
+    std::int64_t source_mtime;  // this was produced from, so that stale copies are rejected
+    char padding[24];
+};
+static_assert(sizeof(PreprocessedHeader) == 64, "Preprocessed Bedmap header must be 64 bytes.");
+
+static constexpr char PREPROCESSED_MAGIC[8] = "NUMCBM2";
+static constexpr std::uint32_t PREPROCESSED_VERSION = 1;
+
+
+BedmapRaster::BedmapRaster(const std::string filename, const int ncols, const int nrows,
+                           const BedmapStorage storage) : mapped(false) {
+
+    // the location of the raw data file
+    const std::string path = std::string(DATA_DIR) + std::string("/bedmap2_bin/") + filename;
+
+    // if we are allowed, try and map a preprocessed copy of the raw file
+    if (storage == BedmapStorage::MemoryMap) {
+
+        // the preprocessed copy lives next to the raw file
+        const std::string preprocessed = path + std::string(".nan");
+
+        // we have a valid preprocessed copy so we are done
+        if (this->mapPreprocessed(preprocessed, path, ncols, nrows))
+            return;
+
+        // otherwise we read the raw file and create the preprocessed copy for next time
+        float* raw = this->readRawData(path, ncols, nrows);
+        if (this->writePreprocessed(preprocessed, path, raw, ncols, nrows)
+            && this->mapPreprocessed(preprocessed, path, ncols, nrows)) {
+            delete[] raw;
+            return;
+        }
+
+        // if we couldn't write the copy (i.e. a read-only data directory), we keep the heap copy
+        std::cerr << "Unable to memory-map BEDMAP2 file (" << filename << "). "
+                  << "Using a private copy instead..." << std::endl;
+        this->values = std::shared_ptr<const float>(raw, std::default_delete<float[]>());
+        return;
+    }
+
+    // otherwise we just read the raw data onto the heap
+    this->values = std::shared_ptr<const float>(this->readRawData(path, ncols, nrows),
+                                                std::default_delete<float[]>());
 
-    // we have to free any allocate BEDMAP2 data files
-    delete[] this->surface;
-    delete[] this->bed;
-    delete[] this->icemask;
-    delete[] this->thickness;
-    delete[] this->gl04c_to_wgs;
 }
 
 
-float* Bedmap::readBedmapData(std::string filename) const {
+float* BedmapRaster::readRawData(const std::string path, const int ncols, const int nrows) const {
     // this function allocates a sufficient amount of memory, reads the binary data
     // table of BEDMAP2 data found in filename and returns it to the caller
 
     // we then attempt to open the file
-    std::string path = std::string(DATA_DIR) + std::string("/bedmap2_bin/");
-    FILE* file = fopen((path + filename).c_str(), "rb");
+    FILE* file = fopen(path.c_str(), "rb");
 
     // if we cannot open bedmap, we exit with error code 1
     if (!file) {
-        std::cerr << "Unable to find bedmap file (" << filename << "). Quitting..." << std::endl;
+        std::cerr << "Unable to find bedmap file (" << path << "). Quitting..." << std::endl;
         throw std::exception();
     }
 
@@ -40,21 +94,21 @@ float* Bedmap::readBedmapData(std::string filename) const {
     fseek(file, 0, SEEK_END);
     const long int length = ftell(file);
     rewind(file);
-    if (length != 4*this->ncols*this->nrows) { // 32-bit/4-byte floats per element
-        std::cerr << "BEDMAP2 data file " << filename << " does not meet specifications. Quitting..." << std::endl;
-        std::cerr << "Calculated length: " << length << " != Expected Length: " << 4*this->ncols*this->nrows << std::endl;
+    if (length != 4*ncols*nrows) { // 32-bit/4-byte floats per element
+        std::cerr << "BEDMAP2 data file " << path << " does not meet specifications. Quitting..." << std::endl;
+        std::cerr << "Calculated length: " << length << " != Expected Length: " << 4*ncols*nrows << std::endl;
         throw std::exception();
     }
 
     // allocate enough memory for data table
-    float* _data = new float[this->ncols*this->nrows];
+    float* _data = new float[ncols*nrows];
 
     // read the entire array into memory
-    fread(_data, sizeof(float), static_cast<size_t>(length), file);
+    fread(_data, sizeof(float), static_cast<size_t>(ncols*nrows), file);
 
     // check that we read the entire file
-    if (ftell(file) != 4*this->ncols*this->nrows) {
-        std::cerr << "Unable to load all of BEDMAP2 file (" << filename << "). Quitting..." << std::endl;
+    if (ftell(file) != 4*ncols*nrows) {
+        std::cerr << "Unable to load all of BEDMAP2 file (" << path << "). Quitting..." << std::endl;
         throw std::exception();
     }
 
@@ -66,7 +120,7 @@ float* Bedmap::readBedmapData(std::string filename) const {
     // so we can detect when we accidentally use NaN's in calculations
     // we don't care about NaN-hitting performance because we should NEVER
     // be operating on NaN's
-    for (int i = 0; i < this->ncols*this->nrows; i++) {
+    for (int i = 0; i < ncols*nrows; i++) {
         if (_data[i] < -9990.0)
             _data[i] = std::numeric_limits<float>::quiet_NaN();
     }
@@ -77,6 +131,96 @@ float* Bedmap::readBedmapData(std::string filename) const {
 }
 
 
+bool BedmapRaster::mapPreprocessed(const std::string path, const std::string source, const int ncols, const int nrows) {
+
+    // we need the size and modification time of the raw file to check the copy is up to date
+    struct stat source_stat;
+    if (stat(source.c_str(), &source_stat) != 0)
+        return false;
+
+    // open the preprocessed file - it's fine if it doesn't exist yet
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    // check that the file is the size we expect
+    const size_t expected = sizeof(PreprocessedHeader) + sizeof(float)*static_cast<size_t>(ncols*nrows);
+    struct stat file_stat;
+    if ((fstat(fd, &file_stat) != 0) || (static_cast<size_t>(file_stat.st_size) != expected)) {
+        close(fd);
+        return false;
+    }
+
+    // map the entire file read-only and shared so the pages live in the page cache
+    void* map = mmap(nullptr, expected, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // the mapping keeps its own reference to the file
+    if (map == MAP_FAILED)
+        return false;
+
+    // and check that the header matches the raw file
+    const PreprocessedHeader* header = static_cast<const PreprocessedHeader*>(map);
+    if ((memcmp(header->magic, PREPROCESSED_MAGIC, sizeof(PREPROCESSED_MAGIC)) != 0)
+        || (header->version != PREPROCESSED_VERSION)
+        || (header->ncols != static_cast<std::uint32_t>(ncols))
+        || (header->nrows != static_cast<std::uint32_t>(nrows))
+        || (header->source_size != static_cast<std::uint64_t>(source_stat.st_size))
+        || (header->source_mtime != static_cast<std::int64_t>(source_stat.st_mtime))) {
+        munmap(map, expected);
+        return false;
+    }
+
+    // everything is good - the values start immediately after the header
+    // and the mapping is released along with the last copy of this raster
+    const float* first = reinterpret_cast<const float*>(static_cast<const char*>(map) + sizeof(PreprocessedHeader));
+    this->values = std::shared_ptr<const float>(first, [map, expected](const float*) { munmap(map, expected); });
+    this->mapped = true;
+
+    return true;
+
+}
+
+
+bool BedmapRaster::writePreprocessed(const std::string path, const std::string source,
+                                     const float* data, const int ncols, const int nrows) const {
+
+    // the raw file we are making a copy of
+    struct stat source_stat;
+    if (stat(source.c_str(), &source_stat) != 0)
+        return false;
+
+    // fill in the header
+    PreprocessedHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, PREPROCESSED_MAGIC, sizeof(PREPROCESSED_MAGIC));
+    header.version = PREPROCESSED_VERSION;
+    header.ncols = static_cast<std::uint32_t>(ncols);
+    header.nrows = static_cast<std::uint32_t>(nrows);
+    header.source_size = static_cast<std::uint64_t>(source_stat.st_size);
+    header.source_mtime = static_cast<std::int64_t>(source_stat.st_mtime);
+
+    // we write to a temporary file unique to this process and then rename it into place
+    // so that other processes never see a partially written file
+    const std::string temporary = path + std::string(".") + std::to_string(getpid());
+    FILE* file = fopen(temporary.c_str(), "wb");
+    if (!file)
+        return false;
+
+    // write the header and the data
+    const size_t count = static_cast<size_t>(ncols*nrows);
+    const bool written = (fwrite(&header, sizeof(header), 1, file) == 1)
+        && (fwrite(data, sizeof(float), count, file) == count);
+
+    // check that everything made it to disk
+    if ((fclose(file) != 0) || !written || (rename(temporary.c_str(), path.c_str()) != 0)) {
+        remove(temporary.c_str());
+        return false;
+    }
+
+    return true;
+
+}
+
+
 std::pair<double, double> Bedmap::coordToBEDMAPLocation(const double theta, const double phi) const {
     // Uses "Map Projections - A Working Manual" by J.P Snyder" https://pubs.usgs.gov/pp/1395/report.pdf
     // Stereographic Projections - starting pg. 154. Numerical example on pg. 315
@@ -112,6 +256,59 @@ std::pair<double, double> Bedmap::coordToBEDMAPLocation(const double theta, cons
 }
 
 
+// convert (x,y) in BEDMAP coordinates (km) back to (theta, phi) in radians
+std::pair<double, double> Bedmap::BEDMAPLocationToCoord(const double x, const double y) const {
+    // Uses "Map Projections - A Working Manual" by J.P Snyder" https://pubs.usgs.gov/pp/1395/report.pdf
+    // All page and equation numbers refer to Snyder
+
+    // the distance from the pole on the map gives t - Pg. 162, Eq. 21-39
+    const double p = sqrt(x*x + y*y);
+    const double t = p/AMTC;
+
+    // the conformal latitude - Pg. 161, Eq. 7-13
+    const double chi = PI/2 - 2*atan(t);
+
+    // and the series for the (positive) southern latitude - Pg. 15, Eq. 3-5
+    // the first neglected term is ~e^10, i.e. ~1e-13 radians
+    const double e2 = EARTH_E*EARTH_E; const double e4 = e2*e2;
+    const double e6 = e4*e2; const double e8 = e4*e4;
+    const double lat = chi + (e2/2 + 5*e4/24 + e6/12 + 13*e8/360)*sin(2*chi)
+        + (7*e4/48 + 29*e6/240 + 811*e8/11520)*sin(4*chi)
+        + (7*e6/120 + 81*e8/1120)*sin(6*chi)
+        + (4279*e8/161280)*sin(8*chi);
+
+    // and convert to theta from the north pole. x = p sin(lon), y = p cos(lon)
+    return std::make_pair(PI/2 + lat, atan2(x, y));
+}
+
+
+// the scale factor of the projection at (x,y) in BEDMAP coordinates (km)
+double Bedmap::getScaleFactor(const double x, const double y) const {
+
+    const double p = sqrt(x*x + y*y);
+
+    // at the pole we use the limit of the scale factor - Pg. 161, Eq. 21-35
+    if (p < 1e-9) {
+        return M_C*sqrt(pow(1 + EARTH_E, 1 + EARTH_E)*pow(1 - EARTH_E, 1 - EARTH_E))/(2*T_C);
+    }
+
+    // otherwise k = p/(a m) - Pg. 161, Eq. 21-32 with m from Eq. 14-15
+    const double lat = this->BEDMAPLocationToCoord(x, y).first - PI/2;
+    const double m = cos(lat)/sqrt(1 - EARTH_E*EARTH_E*sin(lat)*sin(lat));
+
+    return p/(EARTH_A*m);
+}
+
+
+// project many (theta, phi) into BEDMAP coordinates (km) at once
+std::size_t Bedmap::coordsToBEDMAPLocations(const std::size_t n, const double* theta, const double* phi,
+                                            double* x, double* y, std::uint8_t* inrange) const {
+
+    // the grid is square and centered on the pole
+    return projectStereographic(n, theta, phi, x, y, inrange, -this->xllcorner);
+}
+
+
 // get the surface ice elevation/radius (in m) relative to WGS84 ellipsoid at a given lat/phi (radians)
 double Bedmap::getSurfaceElevation(const double theta, const double phi) const {
 
@@ -128,7 +325,7 @@ double Bedmap::getSurfaceElevation(const double theta, const double phi) const {
 double Bedmap::getSurfaceElevationAtPoint(const double x, const double y) const {
 
     // bilinear interpolate data (returns EIGEN-GL04C) and then add conversion to WGS84
-    return interpData(this->surface, x, y) + interpData(this->gl04c_to_wgs, x, y);
+    return interpData(Surface, x, y) + interpData(Geoid, x, y);
 
 }
 
@@ -148,7 +345,7 @@ double Bedmap::getIceThickness(const double theta, const double phi) const {
 double Bedmap::getIceThicknessAtPoint(const double x, const double y) const {
 
     // bilinear interpolate data (returns EIGEN-GL04C) and then add conversion to WGS84
-    return this->interpData(this->thickness, x, y);
+    return this->interpData(Thickness, x, y);
 }
 
 
@@ -167,7 +364,7 @@ double Bedmap::getBedDepth(const double theta, const double phi) const {
 double Bedmap::getBedDepthAtPoint(const double x, const double y) const {
 
     // bilinear interpolate data (returns EIGEN-GL04C) and then add conversion to WGS84
-    return this->interpData(this->bed, x, y) + interpData(this->gl04c_to_wgs, x, y);
+    return this->interpData(Bed, x, y) + interpData(Geoid, x, y);
 }
 
 
@@ -188,7 +385,13 @@ IceMask Bedmap::getIceMask(const double theta, const double phi) const {
 IceMask Bedmap::getIceMaskAtPoint(const double x, const double y) const {
 
     // evaluate the mask at this point
-    const double mask = this->interpData(this->icemask, x, y);
+    return this->toIceMask(this->interpData(Mask, x, y));
+
+}
+
+
+// convert an interpolated icemask value to an IceMask
+IceMask Bedmap::toIceMask(const double mask) const {
 
     // if we are closer to being grounded, we return grounded
     if (mask < 1)
@@ -206,6 +409,108 @@ IceMask Bedmap::getIceMaskAtPoint(const double x, const double y) const {
 }
 
 
+// query every BEDMAP2 field at a given theta/phi (radians)
+BedmapPoint Bedmap::query(const double theta, const double phi) const {
+
+    // project once
+    std::pair<double, double> loc = coordToBEDMAPLocation(theta, phi);
+
+    // and query at this point
+    return this->queryAtPoint(loc.first, loc.second);
+}
+
+
+// query every BEDMAP2 field at a given (x,y) in BEDMAP coordinates (km)
+BedmapPoint Bedmap::queryAtPoint(const double x, const double y) const {
+
+    // find the surrounding cells once and gather every raster there
+    return this->queryCell(x, y, this->locateCell(x, y));
+
+}
+
+
+// get the raw value of every BEDMAP2 field at a single cell of the grid
+BedmapPoint Bedmap::queryAtCell(const int col, const int row) const {
+
+    // check that we are on the grid
+    if ((col < 0) || (col >= this->ncols) || (row < 0) || (row >= this->nrows)) {
+        std::cerr << "Cell (" << col << ", " << row << ") is outside of the BEDMAP grid. Quitting..." << std::endl;
+        throw std::exception();
+    }
+
+    // a "cell" whose four corners are all (col, row) interpolates to exactly
+    // the value at (col, row), even if a neighbouring value is NaN
+    Cell cell;
+    cell.i00 = this->tiles ? this->tileIndex(col, row) : row*this->ncols + col;
+    cell.i10 = cell.i00;
+    cell.i01 = cell.i00;
+    cell.i11 = cell.i00;
+    cell.pos = std::pair<double, double>(0, 0);
+
+    const std::pair<double, double> center = this->getCellCenter(col, row);
+    return this->queryCell(center.first, center.second, cell);
+
+}
+
+
+// get the raw value of every BEDMAP2 field along a row of the grid
+void Bedmap::queryRow(const int row, BedmapPoint* points) const {
+
+    // check that we are on the grid
+    if ((row < 0) || (row >= this->nrows)) {
+        std::cerr << "Row " << row << " is outside of the BEDMAP grid. Quitting..." << std::endl;
+        throw std::exception();
+    }
+
+    // the rasters in the order of Field
+    const float* fields[NFields] = { this->surface.data(), this->bed.data(), this->thickness.data(),
+                                     this->gl04c_to_wgs.data(), this->icemask.data() };
+
+    for (int col = 0; col < this->ncols; col++) {
+
+        // read each field straight from the tiles, where the fields of each cell are
+        // interleaved, or from the rasters
+        double values[NFields];
+        if (this->tiles) {
+            const float* cell = this->tiles.get() + NFields*this->tileIndex(col, row);
+            for (int f = 0; f < NFields; f++) {
+                values[f] = cell[f];
+            }
+        }
+        else {
+            for (int f = 0; f < NFields; f++) {
+                values[f] = fields[f][row*this->ncols + col];
+            }
+        }
+
+        BedmapPoint& point = points[col];
+        point.x = this->xllcorner + (static_cast<double>(col) + 0.5)*this->cellsize;
+        point.y = -this->yllcorner - (static_cast<double>(row) + 0.5)*this->cellsize;
+        point.geoid = values[Geoid];
+        point.surface = values[Surface] + point.geoid;
+        point.bed = values[Bed] + point.geoid;
+        point.thickness = values[Thickness];
+        point.mask = this->toIceMask(values[Mask]);
+    }
+}
+
+
+// gather every BEDMAP2 field within a cell found by locateCell
+BedmapPoint Bedmap::queryCell(const double x, const double y, const Cell& cell) const {
+
+    BedmapPoint point;
+    point.x = x;
+    point.y = y;
+    point.geoid = this->interpCell(Geoid, cell);
+    point.surface = this->interpCell(Surface, cell) + point.geoid;
+    point.bed = this->interpCell(Bed, cell) + point.geoid;
+    point.thickness = this->interpCell(Thickness, cell);
+    point.mask = this->toIceMask(this->interpCell(Mask, cell));
+
+    return point;
+}
+
+
 // interpolate a function evaluated at the four points of a unit square to a point (x,y)
 double Bedmap::interpIndex2D(const std::tuple<double, double, double, double> f,
                                     const std::pair<double, double> pos) const {
@@ -219,24 +524,388 @@ double Bedmap::interpIndex2D(const std::tuple<double, double, double, double> f,
 }
 
 
-// interpolate between data points to evaluate `data` at a given x,y in BEDMAP coordinates (km)
-double Bedmap::interpData(const float *data, const double x, const double y) const {
+// interpolate between data points to evaluate `field` at a given x,y in BEDMAP coordinates (km)
+double Bedmap::interpData(const Field field, const double x, const double y) const {
+
+    // find the cells around this location and interpolate
+    return this->interpCell(field, this->locateCell(x, y));
+
+}
+
+
+// clamp a (floating point) row/column onto the grid. NaN's are sent to zero
+static inline int clampIndex(const double index, const int n) {
+    return index >= 0 ? (index <= n - 1 ? static_cast<int>(index) : n - 1) : 0;
+}
+
+
+// the number of points that the batch queries process at once
+static constexpr std::size_t QUERY_BLOCK = 256;
+
+
+// query every BEDMAP2 field at many theta/phi (radians)
+void Bedmap::query(const std::size_t n, const double* theta, const double* phi, BedmapPoint* points) const {
+
+    // storage for one block of projected points
+    double x[QUERY_BLOCK];
+    double y[QUERY_BLOCK];
+    std::uint8_t inrange[QUERY_BLOCK];
+
+    for (std::size_t first = 0; first < n; first += QUERY_BLOCK) {
+        const std::size_t count = std::min(QUERY_BLOCK, n - first);
+
+        // project the block - points off the grid become NaN which interpolate to NaN/Ocean
+        this->coordsToBEDMAPLocations(count, theta + first, phi + first, x, y, inrange);
+
+        // and query them
+        this->queryAtPoints(count, x, y, points + first);
+    }
+}
+
+
+// query every BEDMAP2 field at many (x,y) in BEDMAP coordinates (km)
+void Bedmap::queryAtPoints(const std::size_t n, const double* x, const double* y, BedmapPoint* points) const {
+
+    // the gather kernels only understand the planar layout
+    if (this->tiles) {
+        for (std::size_t i = 0; i < n; i++) {
+            points[i] = this->queryAtPoint(x[i], y[i]);
+        }
+        return;
+    }
+
+    // the grid and every raster in the order of Field
+    const BilinearGrid grid = { this->ncols, this->nrows, this->xllcorner, this->yllcorner };
+    const float* rasters[NFields] = { this->surface.data(), this->bed.data(), this->thickness.data(),
+                                      this->gl04c_to_wgs.data(), this->icemask.data() };
+
+    // storage for one block of interpolated values
+    double values[NFields][QUERY_BLOCK];
+    double* out[NFields] = { values[Surface], values[Bed], values[Thickness], values[Geoid], values[Mask] };
+
+    for (std::size_t first = 0; first < n; first += QUERY_BLOCK) {
+        const std::size_t count = std::min(QUERY_BLOCK, n - first);
+
+        // interpolate every raster for this block at once
+        interpolateBilinear(grid, count, x + first, y + first, NFields, rasters, out);
+
+        // and assemble the points exactly as queryAtPoint does
+        for (std::size_t i = 0; i < count; i++) {
+            BedmapPoint& point = points[first + i];
+            point.x = x[first + i];
+            point.y = y[first + i];
+            point.geoid = values[Geoid][i];
+            point.surface = values[Surface][i] + point.geoid;
+            point.bed = values[Bed][i] + point.geoid;
+            point.thickness = values[Thickness][i];
+            point.mask = this->toIceMask(values[Mask][i]);
+        }
+    }
+}
+
+
+// find the four grid cells around a given x,y in BEDMAP coordinates (km)
+Bedmap::Cell Bedmap::locateCell(const double x, const double y) const {
 
     // find the index corresponding to x and y
     // we don't divide by cellsize since cellsize==1 for BEDMAP2 and division is "expensive"
     const double xi = abs(x - this->xllcorner) - 0.5;
     const double yi = abs(y + this->yllcorner) - 0.5;
 
+    // the rows and columns on either side of us, clamped onto the grid - the outermost
+    // half-cell of the grid (or a NaN) would otherwise read outside of the rasters
+    const double xf = floor(xi);
+    const double yf = floor(yi);
+    const int x0 = clampIndex(xf, this->ncols);
+    const int x1 = clampIndex(ceil(xi), this->ncols);
+    const int y0 = clampIndex(yf, this->nrows);
+    const int y1 = clampIndex(ceil(yi), this->nrows);
+
+    // the position within the cell. This is fmod(xi, 1) for xi >= 0, but fmod
+    // is surprisingly slow (~80 ns) for arguments this large
+    Cell cell;
+    cell.pos = std::pair<double, double>(xi - xf, yi - yf);
+
+    // the raster indices of the four corners
+    if (!this->tiles) {
+        cell.i00 = y0*this->ncols + x0;
+        cell.i10 = y0*this->ncols + x1;
+        cell.i01 = y1*this->ncols + x0;
+        cell.i11 = y1*this->ncols + x1;
+        return cell;
+    }
+
+    // or the indices within the tile of (x0, y0). The halo means that
+    // the other three corners are always in the same tile
+    cell.i00 = this->tileIndex(x0, y0);
+    cell.i10 = cell.i00 + (x1 - x0);
+    cell.i01 = cell.i00 + (y1 - y0)*tilestride;
+    cell.i11 = cell.i01 + (x1 - x0);
+
+    return cell;
+}
+
+
+// interpolate `field` within a cell found by locateCell
+double Bedmap::interpCell(const Field field, const Cell& cell) const {
+
     // get the data table values at this location and store in a tuple
     std::tuple<double, double, double, double> f;
 
-    // assign values
-    std::get<0>(f) = data[static_cast<int>(floor(yi)*this->ncols + floor(xi))];
-    std::get<1>(f) = data[static_cast<int>(floor(yi)*this->ncols + ceil(xi))];
-    std::get<2>(f) = data[static_cast<int>(ceil(yi)*this->ncols + floor(xi))];
-    std::get<3>(f) = data[static_cast<int>(ceil(yi)*this->ncols + ceil(xi))];
+    if (this->tiles) {
+        // the fields of each cell are interleaved in the tiles
+        const float* data = this->tiles.get() + field;
+        f = std::make_tuple(data[NFields*cell.i00], data[NFields*cell.i10],
+                            data[NFields*cell.i01], data[NFields*cell.i11]);
+    }
+    else {
+        // otherwise each field is in its own raster
+        const BedmapRaster* rasters[NFields] = { &this->surface, &this->bed, &this->thickness,
+                                                 &this->gl04c_to_wgs, &this->icemask };
+        const float* data = rasters[field]->data();
+        f = std::make_tuple(data[cell.i00], data[cell.i10], data[cell.i01], data[cell.i11]);
+    }
 
     // interpolate in index space
-    return interpIndex2D(f, std::pair<double, double>(fmod(xi, 1), fmod(yi, 1)));
+    return interpIndex2D(f, cell.pos);
+
+}
+
+
+// get the index of the cell at (col, row) within the tiles
+int Bedmap::tileIndex(const int col, const int row) const {
+
+    // the tile containing this cell, and the first cell of that tile
+    const int tile = (row/tilesize)*this->ntiles + col/tilesize;
+
+    return tile*tilestride*tilestride + (row % tilesize)*tilestride + (col % tilesize);
+}
+
+
+// copy the rasters into interleaved tiles with a one-cell halo
+std::shared_ptr<const float> Bedmap::buildTiles() const {
+
+    // the rasters in the order they are interleaved
+    const float* fields[NFields] = { this->surface.data(), this->bed.data(), this->thickness.data(),
+                                     this->gl04c_to_wgs.data(), this->icemask.data() };
+
+    // allocate every tile including the halo
+    const std::size_t ncells = static_cast<std::size_t>(this->ntiles*this->ntiles*tilestride*tilestride);
+    float* tiled = new float[NFields*ncells];
+
+    // and fill them in, tile by tile
+    for (int ty = 0; ty < this->ntiles; ty++) {
+        for (int tx = 0; tx < this->ntiles; tx++) {
+
+            // the first cell of this tile within the tiles
+            float* tile = tiled + NFields*static_cast<std::size_t>((ty*this->ntiles + tx)*tilestride*tilestride);
+
+            for (int j = 0; j < tilestride; j++) {
+                for (int i = 0; i < tilestride; i++) {
+
+                    // the cell of the grid this is - the halo is the first row/column of the next tile
+                    const int col = tx*tilesize + i;
+                    const int row = ty*tilesize + j;
+                    float* cell = tile + NFields*(j*tilestride + i);
+
+                    // and copy every field - the grid is padded with NaN
+                    const bool valid = (col < this->ncols) && (row < this->nrows);
+                    for (int f = 0; f < NFields; f++) {
+                        cell[f] = valid ? fields[f][row*this->ncols + col] : std::numeric_limits<float>::quiet_NaN();
+                    }
+                }
+            }
+        }
+    }
+
+    return std::shared_ptr<const float>(tiled, std::default_delete<float[]>());
+}
+
+
+// walk a straight path across the grid, collecting every segment
+std::size_t Bedmap::walk(const double x, const double y, const double dx, const double dy, const double length,
+                         std::vector<BedmapSegment>& segments) const {
+
+    segments.clear();
+
+    // and just walk until we run out of path or grid
+    BedmapWalker walker(*this, x, y, dx, dy, length);
+    BedmapSegment segment;
+    while (walker.next(segment)) {
+        segments.push_back(segment);
+    }
+
+    return segments.size();
+}
+
+
+// start a walk along a straight path
+BedmapWalker::BedmapWalker(const Bedmap& bm, const double x, const double y,
+                           const double dx, const double dy, const double pathlength)
+    : bedmap(bm), xi(std::abs(x - bm.xllcorner) - 0.5), yi(std::abs(y + bm.yllcorner) - 0.5),
+      ux(0), uy(0), length(pathlength), distance(0), col(0), row(0), finished(false) {
+
+    // we need a direction
+    const double norm = sqrt(dx*dx + dy*dy);
+    if (!(norm > 0)) {
+        std::cerr << "Cannot walk across BEDMAP along (" << dx << ", " << dy << "). Quitting..." << std::endl;
+        throw std::exception();
+    }
+
+    // and to start on the grid
+    if (!((fabs(x) <= -bm.xllcorner) && (fabs(y) <= -bm.yllcorner))) {
+        std::cerr << "Cannot walk across BEDMAP from outside the grid at (" << x << ", " << y
+                  << "). Quitting..." << std::endl;
+        throw std::exception();
+    }
+
+    // rows are counted from the top of the map, so they run opposite to y
+    this->ux = dx/norm;
+    this->uy = -dy/norm;
+
+    // the cell that we start in. If we start on the boundary of two cells and are
+    // heading backwards, we start in the cell behind us so that no segment is empty
+    this->col = static_cast<int>(floor(this->xi));
+    this->row = static_cast<int>(floor(this->yi));
+    if ((this->ux < 0) && (this->col == this->xi) && (this->col > -1)) this->col--;
+    if ((this->uy < 0) && (this->row == this->yi) && (this->row > -1)) this->row--;
+
+    // and read all four of its corners
+    for (int corner = 0; corner < 4; corner++) {
+        this->readCorner(corner);
+    }
+    this->entry = this->evaluate(0);
+}
+
+
+// read the values at a corner of the current cell
+void BedmapWalker::readCorner(const int corner) {
+
+    // the corner, clamped onto the grid exactly as Bedmap::locateCell does
+    const int c = std::max(0, std::min(this->bedmap.ncols - 1, this->col + (corner & 1)));
+    const int r = std::max(0, std::min(this->bedmap.nrows - 1, this->row + (corner >> 1)));
+
+    if (this->bedmap.tiles) {
+        // the fields of each cell are interleaved in the tiles
+        const float* cell = this->bedmap.tiles.get() + Bedmap::NFields*this->bedmap.tileIndex(c, r);
+        for (int f = 0; f < 4; f++) {
+            this->corners[f][corner] = cell[f];
+        }
+    }
+    else {
+        // otherwise each field is in its own raster
+        const float* fields[4] = { this->bedmap.surface.data(), this->bedmap.bed.data(),
+                                   this->bedmap.thickness.data(), this->bedmap.gl04c_to_wgs.data() };
+        for (int f = 0; f < 4; f++) {
+            this->corners[f][corner] = fields[f][r*this->bedmap.ncols + c];
+        }
+    }
+}
+
+
+// move to a neighbouring cell, reusing the two corners that we share with it
+void BedmapWalker::step(const int dcol, const int drow) {
+
+    this->col += dcol;
+    this->row += drow;
+
+    // the corners that we keep, and the corners we have to read. Corners are
+    // numbered (0, 0), (1, 0), (0, 1), (1, 1) so bit 0 is the column and bit 1 the row
+    const int bit = dcol ? 1 : 2;
+    const bool forwards = (dcol + drow) > 0;
+    for (int corner = 0; corner < 4; corner++) {
+        // the corners on the far side of the cell we are moving into
+        if (((corner & bit) != 0) != forwards)
+            continue;
+
+        // which the cell we are leaving shares with us on its near side
+        for (int f = 0; f < 4; f++) {
+            this->corners[f][corner ^ bit] = this->corners[f][corner];
+        }
+        this->readCorner(corner);
+    }
+}
+
+
+// interpolate the profile within the current cell
+BedmapProfile BedmapWalker::evaluate(const double s) const {
+
+    // the position within the cell
+    const double x = (this->xi + s*this->ux) - this->col;
+    const double y = (this->yi + s*this->uy) - this->row;
+
+    // the same bilinear interpolation as Bedmap::interpIndex2D for every field. Corners
+    // with no weight are left out so that a path along the edge of a cell does not pick
+    // up a NaN from the far side, just as locateCell does not for points on the edge
+    const double weights[4] = { (1 - x)*(1 - y), x*(1 - y), (1 - x)*y, x*y };
+    double values[4] = { 0, 0, 0, 0 };
+    for (int c = 0; c < 4; c++) {
+        if (weights[c] == 0.) continue;
+        for (int f = 0; f < 4; f++)
+            values[f] += this->corners[f][c]*weights[c];
+    }
+
+    BedmapProfile profile;
+    profile.surface = values[Bedmap::Surface] + values[Bedmap::Geoid];
+    profile.bed = values[Bedmap::Bed] + values[Bedmap::Geoid];
+    profile.thickness = values[Bedmap::Thickness];
+
+    return profile;
+}
+
+
+// fill in the next segment along the path
+bool BedmapWalker::next(BedmapSegment& segment) {
+
+    if (this->finished)
+        return false;
+
+    // the distance along the path to the next column and row boundaries. The outermost
+    // half cells end at the edge of the grid rather than at the next cell
+    const double right = std::min(static_cast<double>(this->col + 1), this->bedmap.ncols - 0.5);
+    const double left = std::max(static_cast<double>(this->col), -0.5);
+    const double lower = std::min(static_cast<double>(this->row + 1), this->bedmap.nrows - 0.5);
+    const double upper = std::max(static_cast<double>(this->row), -0.5);
+    const double tcol = this->ux > 0 ? (right - this->xi)/this->ux : (this->ux < 0 ? (left - this->xi)/this->ux : HUGE_VAL);
+    const double trow = this->uy > 0 ? (lower - this->yi)/this->uy : (this->uy < 0 ? (upper - this->yi)/this->uy : HUGE_VAL);
+
+    // this segment ends at whichever we reach first
+    const double end = std::min(std::min(tcol, trow), this->length);
+
+    segment.start = this->distance;
+    segment.end = end;
+    segment.col = this->col;
+    segment.row = this->row;
+    segment.entry = this->entry;
+    segment.exit = this->evaluate(end);
+
+    // each field is quadratic along the segment, so Simpson's rule is exact
+    const BedmapProfile middle = this->evaluate(0.5*(this->distance + end));
+    segment.mean.surface = (segment.entry.surface + 4*middle.surface + segment.exit.surface)/6.;
+    segment.mean.bed = (segment.entry.bed + 4*middle.bed + segment.exit.bed)/6.;
+    segment.mean.thickness = (segment.entry.thickness + 4*middle.thickness + segment.exit.thickness)/6.;
+
+    // the fields are continuous, so where we leave this cell is where we enter the next
+    this->distance = end;
+    this->entry = segment.exit;
+
+    // we stop at the end of the path...
+    if (end >= this->length) {
+        this->finished = true;
+        return true;
+    }
+
+    // ...or otherwise move into the next cell (or two, if we pass through a corner)
+    if (tcol <= end) this->step(this->ux > 0 ? 1 : -1, 0);
+    if (trow <= end) this->step(0, this->uy > 0 ? 1 : -1);
+
+    // and stop if that takes us off the grid, i.e. unless -1 <= col < ncols and -1 <= row < nrows.
+    // Shifting by one and comparing unsigned catches both ends at once without signed arithmetic
+    // that the compiler would have to assume does not overflow
+    const unsigned int ucol = static_cast<unsigned int>(this->col) + 1u;
+    const unsigned int urow = static_cast<unsigned int>(this->row) + 1u;
+    if ((ucol > static_cast<unsigned int>(this->bedmap.ncols)) || (urow > static_cast<unsigned int>(this->bedmap.nrows)))
+        this->finished = true;
 
+    return true;
 }
@@ -0,0 +1,257 @@
+#include <math.h>
+#include <algorithm>
+#include <readers/Bilinear.hpp>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define NUMC_HAVE_GATHER_KERNELS 1
+#endif
+
+using namespace anita::readers;
+
+// the number of rasters we interpolate in one pass over a block of points
+static constexpr std::size_t MAX_RASTERS = 8;
+
+// clamp a (floating point) row/column onto the grid. NaN's are sent to zero
+static inline int clampIndex(const double index, const int n) {
+    return index >= 0 ? (index <= n - 1 ? static_cast<int>(index) : n - 1) : 0;
+}
+
+void anita::readers::interpolateBilinearScalar(const BilinearGrid& grid, const std::size_t n,
+                                               const double* x, const double* y,
+                                               const std::size_t nrasters, const float* const* rasters,
+                                               double* const* out) {
+
+    for (std::size_t i = 0; i < n; i++) {
+
+        // find the (fractional) column and row - this is Bedmap::locateCell
+        const double xi = fabs(x[i] - grid.xllcorner) - 0.5;
+        const double yi = fabs(y[i] + grid.yllcorner) - 0.5;
+        const double xf = floor(xi);
+        const double yf = floor(yi);
+
+        // the four corners, clamped onto the grid
+        const int x0 = clampIndex(xf, grid.ncols);
+        const int x1 = clampIndex(ceil(xi), grid.ncols);
+        const int y0 = clampIndex(yf, grid.nrows);
+        const int y1 = clampIndex(ceil(yi), grid.nrows);
+        const int i00 = y0*grid.ncols + x0;
+        const int i10 = y0*grid.ncols + x1;
+        const int i01 = y1*grid.ncols + x0;
+        const int i11 = y1*grid.ncols + x1;
+
+        // the position within the cell
+        const double px = xi - xf;
+        const double py = yi - yf;
+
+        // and interpolate every raster - this is Bedmap::interpIndex2D
+        for (std::size_t r = 0; r < nrasters; r++) {
+            const float* f = rasters[r];
+            out[r][i] = static_cast<double>(f[i00])*(1 - px)*(1 - py) + static_cast<double>(f[i10])*px*(1 - py)
+                + static_cast<double>(f[i01])*(1 - px)*py + static_cast<double>(f[i11])*px*py;
+        }
+    }
+}
+
+#ifdef NUMC_HAVE_GATHER_KERNELS
+
+// the vector kernels must not contract the multiplies and adds into FMA's
+// (which AVX-512 allows), or they would no longer agree with the scalar kernel
+#pragma GCC push_options
+#pragma GCC optimize("fp-contract=off")
+
+__attribute__((target("avx2")))
+void anita::readers::interpolateBilinearAVX2(const BilinearGrid& grid, const std::size_t n,
+                                             const double* x, const double* y,
+                                             const std::size_t nrasters, const float* const* rasters,
+                                             double* const* out) {
+
+    // the tail below has room for MAX_RASTERS output pointers, so do any more in several passes
+    if (nrasters > MAX_RASTERS) {
+        for (std::size_t first = 0; first < nrasters; first += MAX_RASTERS)
+            interpolateBilinearAVX2(grid, n, x, y, std::min(MAX_RASTERS, nrasters - first), rasters + first, out + first);
+        return;
+    }
+
+    // constants that we need for every block
+    const __m256d absmask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7FFFFFFFFFFFFFFF));
+    const __m256d xll = _mm256_set1_pd(grid.xllcorner);
+    const __m256d yll = _mm256_set1_pd(grid.yllcorner);
+    const __m256d half = _mm256_set1_pd(0.5);
+    const __m256d one = _mm256_set1_pd(1.);
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d xmax = _mm256_set1_pd(grid.ncols - 1);
+    const __m256d ymax = _mm256_set1_pd(grid.nrows - 1);
+    const __m128i ncols = _mm_set1_epi32(grid.ncols);
+
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+
+        // find the (fractional) column and row
+        const __m256d xi = _mm256_sub_pd(_mm256_and_pd(_mm256_sub_pd(_mm256_loadu_pd(x + i), xll), absmask), half);
+        const __m256d yi = _mm256_sub_pd(_mm256_and_pd(_mm256_add_pd(_mm256_loadu_pd(y + i), yll), absmask), half);
+        const __m256d xf = _mm256_floor_pd(xi);
+        const __m256d yf = _mm256_floor_pd(yi);
+
+        // the four corners, clamped onto the grid. max(NaN, 0) is 0
+        const __m128i x0 = _mm256_cvttpd_epi32(_mm256_min_pd(_mm256_max_pd(xf, zero), xmax));
+        const __m128i x1 = _mm256_cvttpd_epi32(_mm256_min_pd(_mm256_max_pd(_mm256_ceil_pd(xi), zero), xmax));
+        const __m128i y0 = _mm_mullo_epi32(_mm256_cvttpd_epi32(_mm256_min_pd(_mm256_max_pd(yf, zero), ymax)), ncols);
+        const __m128i y1 = _mm_mullo_epi32(_mm256_cvttpd_epi32(_mm256_min_pd(_mm256_max_pd(_mm256_ceil_pd(yi), zero), ymax)), ncols);
+        const __m128i i00 = _mm_add_epi32(y0, x0);
+        const __m128i i10 = _mm_add_epi32(y0, x1);
+        const __m128i i01 = _mm_add_epi32(y1, x0);
+        const __m128i i11 = _mm_add_epi32(y1, x1);
+
+        // the position within the cell and the weights
+        const __m256d px = _mm256_sub_pd(xi, xf);
+        const __m256d py = _mm256_sub_pd(yi, yf);
+        const __m256d qx = _mm256_sub_pd(one, px);
+        const __m256d qy = _mm256_sub_pd(one, py);
+
+        // and gather and interpolate every raster
+        for (std::size_t r = 0; r < nrasters; r++) {
+            const float* f = rasters[r];
+            const __m256d f00 = _mm256_cvtps_pd(_mm_i32gather_ps(f, i00, 4));
+            const __m256d f10 = _mm256_cvtps_pd(_mm_i32gather_ps(f, i10, 4));
+            const __m256d f01 = _mm256_cvtps_pd(_mm_i32gather_ps(f, i01, 4));
+            const __m256d f11 = _mm256_cvtps_pd(_mm_i32gather_ps(f, i11, 4));
+
+            __m256d v = _mm256_mul_pd(_mm256_mul_pd(f00, qx), qy);
+            v = _mm256_add_pd(v, _mm256_mul_pd(_mm256_mul_pd(f10, px), qy));
+            v = _mm256_add_pd(v, _mm256_mul_pd(_mm256_mul_pd(f01, qx), py));
+            v = _mm256_add_pd(v, _mm256_mul_pd(_mm256_mul_pd(f11, px), py));
+            _mm256_storeu_pd(out[r] + i, v);
+        }
+    }
+
+    // clear the upper halves of the vector registers, or every SSE instruction
+    // (i.e. all of libm) runs many times slower until the next vzeroupper. The
+    // compiler does not insert this for us without optimization
+    _mm256_zeroupper();
+
+    // and the remainder with the scalar kernel
+    double* tail[MAX_RASTERS];
+    for (std::size_t r = 0; r < nrasters; r++) tail[r] = out[r] + i;
+    interpolateBilinearScalar(grid, n - i, x + i, y + i, nrasters, rasters, tail);
+}
+
+__attribute__((target("avx512f")))
+void anita::readers::interpolateBilinearAVX512(const BilinearGrid& grid, const std::size_t n,
+                                               const double* x, const double* y,
+                                               const std::size_t nrasters, const float* const* rasters,
+                                               double* const* out) {
+
+    // the tail below has room for MAX_RASTERS output pointers, so do any more in several passes
+    if (nrasters > MAX_RASTERS) {
+        for (std::size_t first = 0; first < nrasters; first += MAX_RASTERS)
+            interpolateBilinearAVX512(grid, n, x, y, std::min(MAX_RASTERS, nrasters - first), rasters + first, out + first);
+        return;
+    }
+
+    // constants that we need for every block
+    const __m512d xll = _mm512_set1_pd(grid.xllcorner);
+    const __m512d yll = _mm512_set1_pd(grid.yllcorner);
+    const __m512d half = _mm512_set1_pd(0.5);
+    const __m512d one = _mm512_set1_pd(1.);
+    const __m512d zero = _mm512_setzero_pd();
+    const __m512d xmax = _mm512_set1_pd(grid.ncols - 1);
+    const __m512d ymax = _mm512_set1_pd(grid.nrows - 1);
+    const __m256i ncols = _mm256_set1_epi32(grid.ncols);
+
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+
+        // find the (fractional) column and row
+        const __m512d xi = _mm512_sub_pd(_mm512_abs_pd(_mm512_sub_pd(_mm512_loadu_pd(x + i), xll)), half);
+        const __m512d yi = _mm512_sub_pd(_mm512_abs_pd(_mm512_add_pd(_mm512_loadu_pd(y + i), yll)), half);
+        const __m512d xf = _mm512_floor_pd(xi);
+        const __m512d yf = _mm512_floor_pd(yi);
+        const __m512d xc = _mm512_ceil_pd(xi);
+        const __m512d yc = _mm512_ceil_pd(yi);
+
+        // the four corners, clamped onto the grid. max(NaN, 0) is 0
+        const __m256i x0 = _mm512_cvttpd_epi32(_mm512_min_pd(_mm512_max_pd(xf, zero), xmax));
+        const __m256i x1 = _mm512_cvttpd_epi32(_mm512_min_pd(_mm512_max_pd(xc, zero), xmax));
+        const __m256i y0 = _mm256_mullo_epi32(_mm512_cvttpd_epi32(_mm512_min_pd(_mm512_max_pd(yf, zero), ymax)), ncols);
+        const __m256i y1 = _mm256_mullo_epi32(_mm512_cvttpd_epi32(_mm512_min_pd(_mm512_max_pd(yc, zero), ymax)), ncols);
+        const __m256i i00 = _mm256_add_epi32(y0, x0);
+        const __m256i i10 = _mm256_add_epi32(y0, x1);
+        const __m256i i01 = _mm256_add_epi32(y1, x0);
+        const __m256i i11 = _mm256_add_epi32(y1, x1);
+
+        // the position within the cell and the weights
+        const __m512d px = _mm512_sub_pd(xi, xf);
+        const __m512d py = _mm512_sub_pd(yi, yf);
+        const __m512d qx = _mm512_sub_pd(one, px);
+        const __m512d qy = _mm512_sub_pd(one, py);
+
+        // and gather and interpolate every raster
+        for (std::size_t r = 0; r < nrasters; r++) {
+            const float* f = rasters[r];
+            const __m512d f00 = _mm512_cvtps_pd(_mm256_i32gather_ps(f, i00, 4));
+            const __m512d f10 = _mm512_cvtps_pd(_mm256_i32gather_ps(f, i10, 4));
+            const __m512d f01 = _mm512_cvtps_pd(_mm256_i32gather_ps(f, i01, 4));
+            const __m512d f11 = _mm512_cvtps_pd(_mm256_i32gather_ps(f, i11, 4));
+
+            __m512d v = _mm512_mul_pd(_mm512_mul_pd(f00, qx), qy);
+            v = _mm512_add_pd(v, _mm512_mul_pd(_mm512_mul_pd(f10, px), qy));
+            v = _mm512_add_pd(v, _mm512_mul_pd(_mm512_mul_pd(f01, qx), py));
+            v = _mm512_add_pd(v, _mm512_mul_pd(_mm512_mul_pd(f11, px), py));
+            _mm512_storeu_pd(out[r] + i, v);
+        }
+    }
+
+    // clear the upper halves of the vector registers (see above)
+    _mm256_zeroupper();
+
+    // and the remainder with the AVX2 kernel
+    double* tail[MAX_RASTERS];
+    for (std::size_t r = 0; r < nrasters; r++) tail[r] = out[r] + i;
+    interpolateBilinearAVX2(grid, n - i, x + i, y + i, nrasters, rasters, tail);
+}
+
+#pragma GCC pop_options
+
+#else
+
+// without x86 intrinsics, every kernel is the scalar kernel
+void anita::readers::interpolateBilinearAVX2(const BilinearGrid& grid, const std::size_t n,
+                                             const double* x, const double* y,
+                                             const std::size_t nrasters, const float* const* rasters,
+                                             double* const* out) {
+    interpolateBilinearScalar(grid, n, x, y, nrasters, rasters, out);
+}
+
+void anita::readers::interpolateBilinearAVX512(const BilinearGrid& grid, const std::size_t n,
+                                               const double* x, const double* y,
+                                               const std::size_t nrasters, const float* const* rasters,
+                                               double* const* out) {
+    interpolateBilinearScalar(grid, n, x, y, nrasters, rasters, out);
+}
+
+#endif
+
+void anita::readers::interpolateBilinear(const BilinearGrid& grid, const std::size_t n,
+                                         const double* x, const double* y,
+                                         const std::size_t nrasters, const float* const* rasters,
+                                         double* const* out) {
+
+    // the vector kernels handle at most MAX_RASTERS at once
+    for (std::size_t first = 0; first < nrasters; first += MAX_RASTERS) {
+        const std::size_t count = std::min(MAX_RASTERS, nrasters - first);
+
+#ifdef NUMC_HAVE_GATHER_KERNELS
+        // we check the CPU once
+        static const bool avx512 = __builtin_cpu_supports("avx512f");
+        static const bool avx2 = __builtin_cpu_supports("avx2");
+
+        if (avx512)
+            interpolateBilinearAVX512(grid, n, x, y, count, rasters + first, out + first);
+        else if (avx2)
+            interpolateBilinearAVX2(grid, n, x, y, count, rasters + first, out + first);
+        else
+#endif
+            interpolateBilinearScalar(grid, n, x, y, count, rasters + first, out + first);
+    }
+}
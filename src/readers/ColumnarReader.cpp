@@ -0,0 +1,223 @@
+#include <cstring>
+#include <iostream>
+#include <zlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <readers/ColumnarReader.hpp>
+
+using namespace anita;
+using namespace anita::columnar;
+using namespace anita::readers;
+
+
+// map the file and read its footer
+ColumnarReader::ColumnarReader(const std::string filename) : data(nullptr), size(0) {
+
+    const int descriptor = open(filename.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        std::cerr << "Unable to open columnar file (" << filename << "). Quitting..." << std::endl;
+        throw std::exception();
+    }
+
+    // the mapping keeps the file open once we close the descriptor
+    struct stat status;
+    void* mapping = MAP_FAILED;
+    if ((fstat(descriptor, &status) == 0) && (status.st_size > 0)) {
+        this->size = static_cast<std::size_t>(status.st_size);
+        mapping = mmap(nullptr, this->size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    }
+    ::close(descriptor);
+
+    if (mapping == MAP_FAILED) {
+        std::cerr << "Unable to map columnar file (" << filename << "). Quitting..." << std::endl;
+        throw std::exception();
+    }
+    this->data = static_cast<const unsigned char*>(mapping);
+
+    // the rest of the constructor must not leak the mapping
+    try {
+
+        // check the header and the trailer
+        FooterTrailer trailer;
+        if (this->size < sizeof(FileHeader) + sizeof(FooterTrailer)) {
+            std::cerr << "Columnar file (" << filename << ") is too short. Quitting..." << std::endl;
+            throw std::exception();
+        }
+        this->read(&this->header, 0, 1);
+        this->read(&trailer, this->size - sizeof(FooterTrailer), 1);
+        if ((memcmp(this->header.magic, MAGIC, sizeof(MAGIC)) != 0) || (memcmp(trailer.magic, MAGIC, sizeof(MAGIC)) != 0)
+            || (this->header.version != VERSION)) {
+            std::cerr << "File (" << filename << ") is not a version " << VERSION << " columnar file. Quitting..." << std::endl;
+            throw std::exception();
+        }
+
+        // and read the footer
+        std::uint64_t offset = trailer.offset;
+        this->read(&this->footer, offset, 1);
+        offset += sizeof(FooterHeader);
+
+        this->columns.resize(this->footer.ncolumns);
+        this->read(this->columns.data(), offset, this->columns.size());
+        offset += sizeof(ColumnInfo)*this->columns.size();
+
+        this->groups.resize(this->footer.ngroups);
+        this->read(this->groups.data(), offset, this->groups.size());
+        offset += sizeof(RowGroupInfo)*this->groups.size();
+
+        this->chunks.resize(this->groups.size()*this->columns.size());
+        this->read(this->chunks.data(), offset, this->chunks.size());
+        offset += sizeof(ChunkInfo)*this->chunks.size();
+
+        // which must end exactly at the trailer, with every chunk before it
+        bool valid = (offset + sizeof(FooterTrailer) == this->size);
+        for (ColumnInfo& column : this->columns) {
+            column.name[sizeof(column.name) - 1] = '\0';
+            valid &= (column.width == getWidth(column.type));
+        }
+        for (const ChunkInfo& chunk : this->chunks)
+            valid &= (chunk.offset <= trailer.offset) && (chunk.size <= trailer.offset - chunk.offset);
+        if (!valid) {
+            std::cerr << "The footer of columnar file (" << filename << ") is corrupt. Quitting..." << std::endl;
+            throw std::exception();
+        }
+    }
+    catch (const std::exception&) {
+        munmap(const_cast<unsigned char*>(this->data), this->size);
+        throw;
+    }
+}
+
+
+ColumnarReader::~ColumnarReader() {
+    munmap(const_cast<unsigned char*>(this->data), this->size);
+}
+
+
+// copy structures out of the mapping
+template <typename T>
+void ColumnarReader::read(T* values, const std::uint64_t offset, const std::size_t count) const {
+
+    if ((offset > this->size) || (count*sizeof(T) > this->size - offset)) {
+        std::cerr << "Columnar file is truncated. Quitting..." << std::endl;
+        throw std::exception();
+    }
+
+    memcpy(values, this->data + offset, count*sizeof(T));
+}
+
+
+std::size_t ColumnarReader::getNumRows(const std::size_t group) const {
+    return static_cast<std::size_t>(this->groups.at(group).nrows);
+}
+
+
+std::vector<std::string> ColumnarReader::getColumns() const {
+
+    std::vector<std::string> names;
+    for (const ColumnInfo& column : this->columns)
+        names.push_back(column.name);
+
+    return names;
+}
+
+
+std::string ColumnarReader::getCommit() const {
+    return std::string(this->header.commit, strnlen(this->header.commit, sizeof(this->header.commit)));
+}
+
+
+std::string ColumnarReader::getHash() const {
+    return std::string(this->header.hash, strnlen(this->header.hash, sizeof(this->header.hash)));
+}
+
+
+std::size_t ColumnarReader::findColumn(const std::string column) const {
+
+    for (std::size_t i = 0; i < this->columns.size(); i++) {
+        if (column == this->columns[i].name)
+            return i;
+    }
+
+    std::cerr << "There is no column named " << column << " in this file. Quitting..." << std::endl;
+    throw std::exception();
+}
+
+
+bool ColumnarReader::isMapped(const std::string column, const std::size_t group) const {
+
+    if (group >= this->groups.size()) {
+        std::cerr << "There is no row group " << group << " in this file. Quitting..." << std::endl;
+        throw std::exception();
+    }
+
+    const ChunkInfo& chunk = this->chunks[group*this->columns.size() + this->findColumn(column)];
+
+    // plain chunks are aligned for their type by the writer
+    return (chunk.encoding == Plain) && (chunk.offset % 8 == 0);
+}
+
+
+// find, and if necessary decode, a chunk
+std::pair<const unsigned char*, std::size_t> ColumnarReader::getChunk(const std::string column, const std::size_t group,
+                                                                      const Type type) const {
+
+    const std::size_t index = this->findColumn(column);
+    if (this->columns[index].type != type) {
+        std::cerr << "Column " << column << " was requested with the wrong type. Quitting..." << std::endl;
+        throw std::exception();
+    }
+
+    // isMapped checks the row group for us
+    const bool mapped = this->isMapped(column, group);
+    const ChunkInfo& chunk = this->chunks[group*this->columns.size() + index];
+    const std::size_t nrows = static_cast<std::size_t>(this->groups[group].nrows);
+    const std::size_t length = nrows*this->columns[index].width;
+
+    // plain chunks are used in place
+    if (mapped) {
+        if (chunk.size != length) {
+            std::cerr << "Column " << column << " of row group " << group << " is corrupt. Quitting..." << std::endl;
+            throw std::exception();
+        }
+        return std::make_pair(this->data + chunk.offset, nrows);
+    }
+
+    // everything else is decoded once
+    std::lock_guard<std::mutex> guard(this->lock);
+    const std::pair<std::size_t, std::size_t> key(index, group);
+    auto found = this->decoded.find(key);
+    if (found != this->decoded.end())
+        return std::make_pair(found->second.data(), nrows);
+
+    std::vector<unsigned char> values(length);
+    bool valid = true;
+    if (chunk.encoding & Deflate) {
+        uLongf decompressed = static_cast<uLongf>(length);
+        valid = (uncompress(values.data(), &decompressed, this->data + chunk.offset, static_cast<uLong>(chunk.size)) == Z_OK)
+            && (decompressed == length);
+    }
+    else {
+        valid = (chunk.size == length);
+        if (valid) memcpy(values.data(), this->data + chunk.offset, length);
+    }
+    if (!valid) {
+        std::cerr << "Column " << column << " of row group " << group << " is corrupt. Quitting..." << std::endl;
+        throw std::exception();
+    }
+
+    // and undo the differences between consecutive integers
+    if (chunk.encoding & Delta) {
+        std::uint32_t value = 0;
+        for (std::size_t i = 0; i + 4 <= length; i += 4) {
+            std::uint32_t difference;
+            memcpy(&difference, &values[i], 4);
+            value += difference;
+            memcpy(&values[i], &value, 4);
+        }
+    }
+
+    const std::vector<unsigned char>& stored = this->decoded.emplace(key, std::move(values)).first->second;
+    return std::make_pair(stored.data(), nrows);
+}
@@ -1,7 +1,9 @@
 #include <map>
+#include <math.h>
 #include <fstream>
 #include <iostream>
 #include <algorithm>
+#include <dirent.h>
 #include <readers/Flux.hpp>
 #include <Math/Interpolator.h>
 #include <boost/range/adaptors.hpp>
@@ -12,6 +14,51 @@ using namespace anita::readers;
 Flux::Flux(const std::string filename) : spline(new ROOT::Math::Interpolator(0, ROOT::Math::Interpolation::kCSPLINE)) {
 
 
+    // the reference flux is flat over the whole range of energies of a Particle
+    if (filename == REFERENCE_FLUX) {
+        this->flux = { {6., 0.}, {15., 0.}, {24., 0.} };
+    }
+    else {
+        this->readFile(filename);
+    }
+
+    // maps are guaranteed to be presorted
+    //so the min and max energy is just the first and last element
+    this->min_energy = this->flux.begin()->first;
+    this->max_energy = this->flux.rbegin()->first;
+
+    // and we find the maximum and minimum value in the map
+    auto by_flux = [](const std::pair<const double, double>& a,
+                      const std::pair<const double, double>& b) { return a.second < b.second; };
+    this->min_flux = (*std::min_element(this->flux.begin(),
+                                        this->flux.end(), by_flux)).second;
+    this->max_flux = (*std::max_element(this->flux.begin(),
+                                        this->flux.end(), by_flux)).second;
+
+    // we now build a cubic spline interpolant using ROOT
+    // first, we need X and Y arrrays
+    // get the keys of the flux data file that has been initialized
+    std::vector<double> x;
+    boost::copy(boost::adaptors::keys(this->flux),
+                std::back_inserter(x));
+
+    // and get the values
+    std::vector<double> y;
+    boost::copy(boost::adaptors::values(this->flux),
+                std::back_inserter(y));
+
+    // we build a interpolation scheme using ROOT; this is a cubic spline
+    this->spline->SetData(static_cast<unsigned int>(x.size()), &x[0], &y[0]);
+
+    // and tabulate the CDF so that we can sample energies directly
+    this->buildCDF();
+
+    // and we are done
+}
+
+// read the energies and fluxes from a file in data/fluxes
+void Flux::readFile(const std::string filename) {
+
     // directory of the flux data files
     const std::string flux_dir = std::string(DATA_DIR) + std::string("/fluxes/");
     const std::string flux_name = flux_dir+filename+std::string(".dat");
@@ -45,32 +92,123 @@ Flux::Flux(const std::string filename) : spline(new ROOT::Math::Interpolator(0,
 
     // and close the file
     influx.close();
+}
 
-    // maps are guaranteed to be presorted
-    //so the min and max energy is just the first and last element
-    this->min_energy = this->flux.begin()->first;
-    this->max_energy = this->flux.rbegin()->first;
+// the number of points in the CDF table
+static constexpr std::size_t NCDF = 4096;
 
-    // and we find the maximum and minimum value in the map
-    this->min_flux = (*std::min_element(this->flux.begin(),
-                                        this->flux.end())).first;
-    this->max_flux = (*std::max_element(this->flux.begin(),
-                                       this->flux.end())).second;
+void Flux::buildCDF() {
 
-    // we now build a cubic spline interpolant using ROOT
-    // first, we need X and Y arrrays
-    // get the keys of the flux data file that has been initialized
-    std::vector<double> x;
-    boost::copy(boost::adaptors::keys(this->flux),
-                std::back_inserter(x));
+    // we need a range of energies to sample from
+    if (!(this->max_energy > this->min_energy)) {
+        std::cerr << "Flux file has no range of energies to sample from. Quitting..." << std::endl;
+        throw std::exception();
+    }
 
-    // and get the values
-    std::vector<double> y;
-    boost::copy(boost::adaptors::values(this->flux),
-                std::back_inserter(y));
+    // integrate 10^flux over log10 eV with the trapezoidal rule. We scale by the
+    // maximum flux so that this doesn't underflow for a very small flux
+    const double step = (this->max_energy - this->min_energy)/static_cast<double>(NCDF - 1);
+    this->values.assign(NCDF, 0.);
+    for (std::size_t i = 0; i < NCDF; i++) {
+        this->values[i] = this->getFlux(this->min_energy + static_cast<double>(i)*step);
+    }
+    this->cdf.assign(NCDF, 0.);
+    double previous = pow(10., this->values[0] - this->max_flux);
+    for (std::size_t i = 1; i < NCDF; i++) {
+        const double current = pow(10., this->values[i] - this->max_flux);
+        this->cdf[i] = this->cdf[i - 1] + 0.5*(previous + current)*step;
+        previous = current;
+    }
 
-    // we build a interpolation scheme using ROOT; this is a cubic spline
-    this->spline->SetData(static_cast<unsigned int>(x.size()), &x[0], &y[0]);
+    // and normalize it, keeping the total number of neutrinos
+    const double total = this->cdf.back();
+    this->integral = log(10.)*pow(10., this->max_flux)*total;
+    if (!(total > 0)) {
+        std::cerr << "Flux file integrates to zero. Quitting..." << std::endl;
+        throw std::exception();
+    }
+    for (double& value : this->cdf) {
+        value /= total;
+    }
+    this->cdf.back() = 1.;
+}
 
-    // and we are done
+double Flux::getCDF(const double energy) const {
+
+    // the CDF is flat outside of the flux file
+    const double u = (energy - this->min_energy)/(this->max_energy - this->min_energy)*static_cast<double>(NCDF - 1);
+    if (u <= 0) return 0.;
+    if (u >= static_cast<double>(NCDF - 1)) return 1.;
+
+    const std::size_t i = static_cast<std::size_t>(u);
+    return this->cdf[i] + (u - static_cast<double>(i))*(this->cdf[i + 1] - this->cdf[i]);
+}
+
+double Flux::getDensity(const double energy) const {
+
+    // there are no neutrinos outside of the flux file
+    const double u = (energy - this->min_energy)/(this->max_energy - this->min_energy)*static_cast<double>(NCDF - 1);
+    if ((u < 0) || (u > static_cast<double>(NCDF - 1))) return 0.;
+
+    // and we interpolate the flux (in log10) between the points of the table
+    const std::size_t i = std::min(static_cast<std::size_t>(u), NCDF - 2);
+    const double value = this->values[i] + (u - static_cast<double>(i))*(this->values[i + 1] - this->values[i]);
+    return log(10.)*pow(10., value);
+}
+
+double Flux::getCDFSlope(const double energy) const {
+
+    // the CDF is flat outside of the flux file
+    const double step = (this->max_energy - this->min_energy)/static_cast<double>(NCDF - 1);
+    const double u = (energy - this->min_energy)/step;
+    if ((u < 0) || (u > static_cast<double>(NCDF - 1))) return 0.;
+
+    // the same interval as getCDF, except that the last point belongs to the last interval
+    const std::size_t i = std::min(static_cast<std::size_t>(u), NCDF - 2);
+    return (this->cdf[i + 1] - this->cdf[i])/step;
+}
+
+double Flux::getInverseCDF(const double fraction) const {
+
+    // find the interval of the CDF that contains this fraction, i.e. cdf[i] <= fraction < cdf[i + 1].
+    // The CDF only increases (and starts at zero), so this is a binary search. A fraction of one
+    // is in the last interval
+    const double f = std::min(std::max(fraction, 0.), 1.);
+    const auto above = std::upper_bound(this->cdf.begin(), this->cdf.end(), f);
+    const std::size_t i = std::min(static_cast<std::size_t>(above - this->cdf.begin()), NCDF - 1) - 1;
+
+    // and invert the same linear interpolation as getCDF within it
+    const double width = this->cdf[i + 1] - this->cdf[i];
+    const double t = width > 0 ? std::min(std::max((f - this->cdf[i])/width, 0.), 1.) : 0.;
+    return this->min_energy + (static_cast<double>(i) + t)*(this->max_energy - this->min_energy)/static_cast<double>(NCDF - 1);
+}
+
+std::vector<std::string> Flux::getModels() {
+
+    // directory of the flux data files
+    const std::string flux_dir = std::string(DATA_DIR) + std::string("/fluxes/");
+
+    DIR* directory = opendir(flux_dir.c_str());
+    if (!directory) {
+        std::cerr << "Unable to open flux directory (" << flux_dir
+                  << "). Quitting..." << std::endl;
+        throw std::exception();
+    }
+
+    // every .dat file is a flux model
+    std::vector<std::string> models;
+    const std::string extension = ".dat";
+    for (struct dirent* entry = readdir(directory); entry; entry = readdir(directory)) {
+        const std::string name = entry->d_name;
+        if ((name.size() > extension.size())
+            && (name.compare(name.size() - extension.size(), extension.size(), extension) == 0)) {
+            models.push_back(name.substr(0, name.size() - extension.size()));
+        }
+    }
+    closedir(directory);
+
+    // readdir returns the files in no particular order
+    std::sort(models.begin(), models.end());
+
+    return models;
 }
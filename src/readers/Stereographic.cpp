@@ -0,0 +1,253 @@
+#include <math.h>
+#include <limits>
+#include <cstdint>
+#include <readers/Bedmap.hpp>
+#include <readers/Stereographic.hpp>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define NUMC_HAVE_AVX2_KERNEL 1
+#endif
+
+using namespace anita::readers;
+
+// pi/2 split into three parts for Cody-Waite range reduction (from Cephes).
+// the first two parts have few enough bits that k*PIO2_1 and k*PIO2_2 are exact
+static constexpr double TWO_OVER_PI = 0.636619772367581343076;
+static constexpr double PIO2_1 = 1.57079625129699707031;
+static constexpr double PIO2_2 = 7.54978941586159635335E-8;
+static constexpr double PIO2_3 = 5.39030285815811905290E-15;
+
+// the minimax polynomials for sin and cos on [-pi/4, pi/4] (from Cephes)
+static constexpr double S0 = 1.58962301576546568060E-10;
+static constexpr double S1 = -2.50507477628578072866E-8;
+static constexpr double S2 = 2.75573136213857245213E-6;
+static constexpr double S3 = -1.98412698295895385996E-4;
+static constexpr double S4 = 8.33333333332211858878E-3;
+static constexpr double S5 = -1.66666666666666307295E-1;
+static constexpr double C0 = -1.13585365213876817300E-11;
+static constexpr double C1 = 2.08757008419747316778E-9;
+static constexpr double C2 = -2.75573141792967388112E-7;
+static constexpr double C3 = 2.48015872888517045348E-5;
+static constexpr double C4 = -1.38888888888730564116E-3;
+static constexpr double C5 = 4.16666666666665929218E-2;
+
+// the Taylor coefficients of atanh(z) = z + z^3/3 + z^5/5 + ... up to z^13.
+// |z| = |e cos(theta)| < 0.082 so the truncation error is below 1e-17
+static constexpr double A0 = 1./13;
+static constexpr double A1 = 1./11;
+static constexpr double A2 = 1./9;
+static constexpr double A3 = 1./7;
+static constexpr double A4 = 1./5;
+static constexpr double A5 = 1./3;
+
+// the Taylor coefficients of exp(u) up to u^6. |u| < 0.0068 so the truncation error is below 1e-19
+static constexpr double E6 = 1./720;
+static constexpr double E5 = 1./120;
+static constexpr double E4 = 1./24;
+static constexpr double E3 = 1./6;
+static constexpr double E2 = 1./2;
+
+// sin and cos of x using Cody-Waite reduction to [-pi/4, pi/4]
+static inline void sincosScalar(const double x, double& sine, double& cosine) {
+
+    // the nearest multiple of pi/2 and the remainder
+    const double k = nearbyint(x*TWO_OVER_PI);
+    double r = x - k*PIO2_1;
+    r = r - k*PIO2_2;
+    r = r - k*PIO2_3;
+
+    // evaluate both polynomials on the remainder
+    const double z = r*r;
+    const double ps = ((((S0*z + S1)*z + S2)*z + S3)*z + S4)*z + S5;
+    const double pc = ((((C0*z + C1)*z + C2)*z + C3)*z + C4)*z + C5;
+    const double s = r + r*(z*ps);
+    const double c = (1. - 0.5*z) + (z*z)*pc;
+
+    // and rotate into the right quadrant
+    const std::int64_t q = static_cast<std::int64_t>(k) & 3;
+    sine = (q & 1) ? c : s;
+    cosine = (q & 1) ? s : c;
+    if (q & 2) sine = -sine;
+    if ((q + 1) & 2) cosine = -cosine;
+}
+
+// project a single point, returning whether it is within halfwidth
+static inline bool projectScalar(const double theta, const double phi, double& x, double& y, const double halfwidth) {
+
+    double sintheta, costheta, sinphi, cosphi;
+    sincosScalar(theta, sintheta, costheta);
+    sincosScalar(phi, sinphi, cosphi);
+
+    // atanh(e cos(theta))
+    const double z = anita::EARTH_E*costheta;
+    const double w = z*z;
+    const double atanh = z + z*(w*(((((A0*w + A1)*w + A2)*w + A3)*w + A4)*w + A5));
+
+    // exp(-e atanh(e cos(theta)))
+    const double u = -anita::EARTH_E*atanh;
+    const double expu = 1. + u*(1. + u*(E2 + u*(E3 + u*(E4 + u*(E5 + u*E6)))));
+
+    // tan(pi/4 + lat/2) = sin(theta)/(1 - cos(theta)), which has no cancellation near the south pole
+    const double t = (sintheta/(1. - costheta))*expu;
+    const double p = t*AMTC;
+    x = p*sinphi;
+    y = p*cosphi;
+
+    // NaN's fail both comparisons
+    if ((fabs(x) <= halfwidth) && (fabs(y) <= halfwidth))
+        return true;
+
+    x = std::numeric_limits<double>::quiet_NaN();
+    y = std::numeric_limits<double>::quiet_NaN();
+    return false;
+}
+
+std::size_t anita::readers::projectStereographicScalar(const std::size_t n, const double* theta, const double* phi,
+                                                       double* x, double* y, std::uint8_t* inrange,
+                                                       const double halfwidth) {
+
+    std::size_t valid = 0;
+    for (std::size_t i = 0; i < n; i++) {
+        inrange[i] = projectScalar(theta[i], phi[i], x[i], y[i], halfwidth) ? 1 : 0;
+        valid += inrange[i];
+    }
+
+    return valid;
+}
+
+#ifdef NUMC_HAVE_AVX2_KERNEL
+
+// Horner's rule on four lanes. This deliberately avoids FMA so that the
+// results are identical to the scalar kernel
+#define MUL(a, b) _mm256_mul_pd(a, b)
+#define ADD(a, b) _mm256_add_pd(a, b)
+#define SUB(a, b) _mm256_sub_pd(a, b)
+#define SET(a) _mm256_set1_pd(a)
+
+// four lanes of sincosScalar
+__attribute__((target("avx2")))
+static inline void sincosAVX2(const __m256d x, __m256d& sine, __m256d& cosine) {
+
+    // the nearest multiple of pi/2 and the remainder
+    const __m256d k = _mm256_round_pd(MUL(x, SET(TWO_OVER_PI)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256d r = SUB(x, MUL(k, SET(PIO2_1)));
+    r = SUB(r, MUL(k, SET(PIO2_2)));
+    r = SUB(r, MUL(k, SET(PIO2_3)));
+
+    // evaluate both polynomials on the remainder
+    const __m256d z = MUL(r, r);
+    __m256d ps = ADD(MUL(SET(S0), z), SET(S1));
+    ps = ADD(MUL(ps, z), SET(S2));
+    ps = ADD(MUL(ps, z), SET(S3));
+    ps = ADD(MUL(ps, z), SET(S4));
+    ps = ADD(MUL(ps, z), SET(S5));
+    __m256d pc = ADD(MUL(SET(C0), z), SET(C1));
+    pc = ADD(MUL(pc, z), SET(C2));
+    pc = ADD(MUL(pc, z), SET(C3));
+    pc = ADD(MUL(pc, z), SET(C4));
+    pc = ADD(MUL(pc, z), SET(C5));
+    const __m256d s = ADD(r, MUL(r, MUL(z, ps)));
+    const __m256d c = ADD(SUB(SET(1.), MUL(SET(0.5), z)), MUL(MUL(z, z), pc));
+
+    // adding 1.5*2^52 leaves k (mod 2^51) in the low bits of the mantissa
+    const __m256i q = _mm256_and_si256(_mm256_castpd_si256(ADD(k, SET(6755399441055744.))),
+                                       _mm256_set1_epi64x(3));
+
+    // odd quadrants swap sin and cos
+    const __m256d swap = _mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(q, _mm256_set1_epi64x(1)),
+                                                                _mm256_set1_epi64x(1)));
+
+    // and bit 1 of q (or q + 1) moved into the sign bit flips the sign
+    const __m256d sinsign = _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_and_si256(q, _mm256_set1_epi64x(2)), 62));
+    const __m256d cossign = _mm256_castsi256_pd(_mm256_slli_epi64(
+                                _mm256_and_si256(_mm256_add_epi64(q, _mm256_set1_epi64x(1)), _mm256_set1_epi64x(2)), 62));
+
+    sine = _mm256_xor_pd(_mm256_blendv_pd(s, c, swap), sinsign);
+    cosine = _mm256_xor_pd(_mm256_blendv_pd(c, s, swap), cossign);
+}
+
+// project four points at a time, and the remainder with the scalar kernel
+__attribute__((target("avx2")))
+static std::size_t projectAVX2(const std::size_t n, const double* theta, const double* phi,
+                               double* x, double* y, std::uint8_t* inrange,
+                               const double halfwidth) {
+
+    const __m256d absmask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7FFFFFFFFFFFFFFF));
+    const __m256d nan = SET(std::numeric_limits<double>::quiet_NaN());
+
+    std::size_t valid = 0;
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+
+        __m256d sintheta, costheta, sinphi, cosphi;
+        sincosAVX2(_mm256_loadu_pd(theta + i), sintheta, costheta);
+        sincosAVX2(_mm256_loadu_pd(phi + i), sinphi, cosphi);
+
+        // atanh(e cos(theta))
+        const __m256d z = MUL(SET(anita::EARTH_E), costheta);
+        const __m256d w = MUL(z, z);
+        __m256d pa = ADD(MUL(SET(A0), w), SET(A1));
+        pa = ADD(MUL(pa, w), SET(A2));
+        pa = ADD(MUL(pa, w), SET(A3));
+        pa = ADD(MUL(pa, w), SET(A4));
+        pa = ADD(MUL(pa, w), SET(A5));
+        const __m256d atanh = ADD(z, MUL(z, MUL(w, pa)));
+
+        // exp(-e atanh(e cos(theta)))
+        const __m256d u = MUL(SET(-anita::EARTH_E), atanh);
+        __m256d expu = ADD(SET(E5), MUL(u, SET(E6)));
+        expu = ADD(SET(E4), MUL(u, expu));
+        expu = ADD(SET(E3), MUL(u, expu));
+        expu = ADD(SET(E2), MUL(u, expu));
+        expu = ADD(SET(1.), MUL(u, expu));
+        expu = ADD(SET(1.), MUL(u, expu));
+
+        // and the projection itself
+        const __m256d t = MUL(_mm256_div_pd(sintheta, SUB(SET(1.), costheta)), expu);
+        const __m256d p = MUL(t, SET(AMTC));
+        const __m256d px = MUL(p, sinphi);
+        const __m256d py = MUL(p, cosphi);
+
+        // check the bounds - NaN's fail the ordered comparison
+        const __m256d ok = _mm256_and_pd(_mm256_cmp_pd(_mm256_and_pd(px, absmask), SET(halfwidth), _CMP_LE_OQ),
+                                         _mm256_cmp_pd(_mm256_and_pd(py, absmask), SET(halfwidth), _CMP_LE_OQ));
+        _mm256_storeu_pd(x + i, _mm256_blendv_pd(nan, px, ok));
+        _mm256_storeu_pd(y + i, _mm256_blendv_pd(nan, py, ok));
+
+        const int bits = _mm256_movemask_pd(ok);
+        for (std::size_t j = 0; j < 4; j++) {
+            inrange[i + j] = static_cast<std::uint8_t>((bits >> j) & 1);
+            valid += inrange[i + j];
+        }
+    }
+
+    // clear the upper halves of the vector registers, or every SSE instruction
+    // (i.e. all of libm) runs many times slower until the next vzeroupper. The
+    // compiler does not insert this for us without optimization
+    _mm256_zeroupper();
+
+    // and finish off with the scalar kernel
+    return valid + projectStereographicScalar(n - i, theta + i, phi + i, x + i, y + i, inrange + i, halfwidth);
+}
+
+#undef MUL
+#undef ADD
+#undef SUB
+#undef SET
+
+#endif
+
+std::size_t anita::readers::projectStereographic(const std::size_t n, const double* theta, const double* phi,
+                                                 double* x, double* y, std::uint8_t* inrange,
+                                                 const double halfwidth) {
+
+#ifdef NUMC_HAVE_AVX2_KERNEL
+    // we check the CPU once
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    if (avx2)
+        return projectAVX2(n, theta, phi, x, y, inrange, halfwidth);
+#endif
+
+    return projectStereographicScalar(n, theta, phi, x, y, inrange, halfwidth);
+}
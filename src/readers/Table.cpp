@@ -40,7 +40,7 @@ void YTable::readYTableFromFile(std::string filename) {
     for (int i = 0; i < this->imax; i++) {
         for (int j = 0; j < this->nfinal; j++) {
             for (int k = 0; k < this->ndim; k++) {
-                tablefile >> this->data[i*this->nfinal*this->ndim + j*this->nfinal + k];
+                tablefile >> this->data[i*this->nfinal*this->ndim + j*this->ndim + k];
             }
         }
     }
@@ -58,7 +58,7 @@ void YTable::readYTableFromFile(std::string filename) {
     return;
 }
 
-std::vector<double> YTable::evaluate(const double energy) const {
+const double* YTable::sample(const double energy) const {
 
     // linear interpolation plus rounding to find the desired energy bin
     int idx = static_cast<int>(std::round((energy - this->emin)/
@@ -67,18 +67,75 @@ std::vector<double> YTable::evaluate(const double energy) const {
     // and clamp to the range of possible indices
     idx = utils::clamp(idx, 0, this->imax - 1);
 
-    // memory to store results
-    std::vector<double> final;
-    final.resize(static_cast<long unsigned int>(this->ndim));
-
     // pick a random final entry
-    int entry = uniformInt(0, this->nfinal);
+    int entry = uniformInt(0, this->nfinal - 1);
+
+    // and return where it starts
+    return this->data + idx*this->nfinal*this->ndim + entry*this->ndim;
+}
+
+std::vector<double> YTable::evaluate(const double energy) const {
+
+    // pick a random final entry and copy it out
+    const double* entry = this->sample(energy);
+    return std::vector<double>(entry, entry + this->ndim);
+}
 
-    // and fill in the array
-    for (int i=0; i < this->ndim; i++) {
-        final[static_cast<long unsigned int>(i)] = this->data[idx*this->nfinal*this->ndim + entry*this->nfinal + i];
+double YTable::evaluate(const double energy, const int dim) const {
+
+    // this must be one of our dimensions
+    if ((dim < 0) || (dim >= this->ndim)) {
+        std::cerr << "YTable only has " << this->ndim << " dimensions. Quitting..." << std::endl;
+        throw std::exception();
     }
 
-    // and we are done
-    return final;
+    // pick a random final entry and return just the one value
+    return this->sample(energy)[dim];
+}
+
+TableRegistry::Entry TableRegistry::getEntry(const std::string& filename, const std::launch policy) {
+
+    // the tables that have been requested so far, and a lock to protect the map
+    // these are function-local so they are safe to use during static initialization
+    static std::map<std::string, Entry> tables;
+    static std::mutex lock;
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    // if we have already seen this file, share the existing (possibly pending) table
+    auto existing = tables.find(filename);
+    if (existing != tables.end()) {
+        return existing->second;
+    }
+
+    // otherwise we create the table. A deferred load is run by the first caller
+    // to wait on it, an async load starts immediately on its own thread
+    Entry entry = std::async(policy, [filename]() {
+            return std::shared_ptr<const YTable>(
+                std::make_shared<YTable>(std::string(DATA_DIR) + std::string("/") + filename));
+        }).share();
+
+    tables.emplace(filename, entry);
+
+    return entry;
+}
+
+const YTable& TableRegistry::getYTable(const std::string& filename) {
+
+    // wait for the table to be loaded - this rethrows if loading failed
+    return *getEntry(filename, std::launch::deferred).get();
+}
+
+void TableRegistry::preload(const std::vector<std::string>& filenames) {
+
+    // start each table loading on its own thread
+    for (auto& filename : filenames) {
+        getEntry(filename, std::launch::async);
+    }
+}
+
+void TableRegistry::preload() {
+
+    // the CTEQ5 final state tables and the TAUOLA decay table
+    preload({"final_cteq5_cc_nu.data", "final_cteq5_nc_nu.data", "tau_decay_tauola.data"});
 }
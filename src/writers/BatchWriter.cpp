@@ -0,0 +1,136 @@
+#include <iostream>
+#include <writers/BatchWriter.hpp>
+
+using namespace anita;
+using namespace anita::writers;
+
+
+BatchWriter::BatchWriter(const std::size_t batch, const std::size_t queue_length)
+    : batch_size(batch), queue_size(queue_length), closed(false), nevents(0), failed(false) {
+
+    // we need a queue and batches to hand events to the I/O thread
+    if ((batch == 0) || (queue_length == 0)) {
+        std::cerr << "The batch and queue sizes of a writer must be positive. Quitting..." << std::endl;
+        throw std::exception();
+    }
+}
+
+
+// create the buffers and start the I/O thread
+void BatchWriter::begin(const unsigned int nworkers) {
+
+    // a writer can only be used for a single run
+    if (this->thread.joinable() || this->closed) {
+        std::cerr << "A writer can only be used once. Quitting..." << std::endl;
+        throw std::exception();
+    }
+
+    this->buffers.resize(nworkers);
+    for (InteractionBuffer& buffer : this->buffers)
+        buffer.reserve(this->batch_size, this->batch_size);
+
+    this->thread = std::thread(&BatchWriter::run, this);
+}
+
+
+// collect an event, and hand the batch to the I/O thread once it is full
+void BatchWriter::consume(const unsigned int worker, const int event, InteractionList& interactions) {
+
+    InteractionBuffer& buffer = this->buffers.at(worker);
+    buffer.append(event, interactions);
+
+    if (buffer.getNumEvents() >= this->batch_size)
+        this->push(buffer);
+}
+
+
+// move a batch onto the queue, leaving an empty buffer in its place
+void BatchWriter::push(InteractionBuffer& batch) {
+
+    {
+        std::unique_lock<std::mutex> guard(this->lock);
+        this->space.wait(guard, [this]() { return this->queue.size() < this->queue_size; });
+        this->queue.push_back(std::move(batch));
+    }
+    this->ready.notify_one();
+
+    // the moved-from buffer is empty, so we only have to reset it
+    batch = InteractionBuffer();
+    batch.reserve(this->batch_size, this->batch_size);
+}
+
+
+// the I/O thread
+void BatchWriter::run() {
+
+    while (true) {
+
+        // wait for the next batch
+        InteractionBuffer batch;
+        {
+            std::unique_lock<std::mutex> guard(this->lock);
+            this->ready.wait(guard, [this]() { return this->closed || !this->queue.empty(); });
+
+            // the queue is only empty here once it has been closed
+            if (this->queue.empty())
+                return;
+
+            batch = std::move(this->queue.front());
+            this->queue.pop_front();
+        }
+        this->space.notify_one();
+
+        // and write it outside of the lock so workers can keep pushing
+        const bool success = this->write(batch);
+
+        std::lock_guard<std::mutex> guard(this->lock);
+        this->nevents += static_cast<long>(batch.getNumEvents());
+        this->failed |= !success;
+    }
+}
+
+
+// close the queue and wait for the I/O thread to drain it
+void BatchWriter::stop() {
+
+    {
+        std::lock_guard<std::mutex> guard(this->lock);
+        this->closed = true;
+    }
+    this->ready.notify_one();
+
+    if (this->thread.joinable())
+        this->thread.join();
+}
+
+
+// write the partial batches and close the output
+void BatchWriter::finish() {
+
+    // the last events of every worker
+    for (InteractionBuffer& buffer : this->buffers) {
+        if (buffer.getNumEvents() > 0)
+            this->push(buffer);
+    }
+
+    // wait for everything to be written
+    this->stop();
+    this->close(this->nevents);
+
+    if (this->failed) {
+        std::cerr << "Unable to write every event to the output. Quitting..." << std::endl;
+        throw std::exception();
+    }
+}
+
+
+long BatchWriter::getNumEvents() const {
+    std::lock_guard<std::mutex> guard(this->lock);
+    return this->nevents;
+}
+
+
+// make sure that the I/O thread never outlives the writer
+BatchWriter::~BatchWriter() {
+    this->stop();
+}
@@ -0,0 +1,203 @@
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+#include <zlib.h>
+#include <unistd.h>
+#include <Version.hpp>
+#include <writers/ColumnarWriter.hpp>
+
+using namespace anita;
+using namespace anita::writers;
+using namespace anita::columnar;
+
+static_assert(sizeof(int) == sizeof(std::int32_t), "Int32 columns are written straight from int columns.");
+
+// every chunk, and the footer, starts on a multiple of this
+static constexpr std::size_t ALIGNMENT = 8;
+
+
+ColumnarWriter::ColumnarWriter(const std::string name, const ColumnarOptions opts)
+    : BatchWriter(opts.batch_size, opts.queue_size), options(opts), filename(name),
+      temporary(name + std::string(".") + std::to_string(getpid())), file(nullptr), position(0) {
+
+    // zlib only has levels 0 through 9
+    if ((opts.compression_level < 0) || (opts.compression_level > 9)) {
+        std::cerr << "Invalid compression level (" << opts.compression_level << "). Quitting..." << std::endl;
+        throw std::exception();
+    }
+
+    this->file = fopen(this->temporary.c_str(), "wb");
+    if (!this->file) {
+        std::cerr << "Unable to create output file (" << this->temporary << "). Quitting..." << std::endl;
+        throw std::exception();
+    }
+
+    // fill in the header
+    FileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.ncolumns = static_cast<std::uint32_t>(NCOLUMNS);
+    memcpy(header.commit, GIT_COMMIT, std::min(sizeof(header.commit), strlen(GIT_COMMIT)));
+    memcpy(header.hash, SOURCE_HASH, std::min(sizeof(header.hash), strlen(SOURCE_HASH)));
+
+    if (!this->writeBytes(&header, sizeof(header))) {
+        std::cerr << "Unable to write to output file (" << this->temporary << "). Quitting..." << std::endl;
+        fclose(this->file);
+        remove(this->temporary.c_str());
+        throw std::exception();
+    }
+}
+
+
+bool ColumnarWriter::writeBytes(const void* bytes, const std::size_t size) {
+
+    if (size == 0)
+        return true;
+
+    const bool written = fwrite(bytes, 1, size, this->file) == size;
+    this->position += size;
+
+    return written;
+}
+
+
+// encode a chunk and write it at the next aligned offset
+bool ColumnarWriter::writeChunk(const void* values, const std::size_t nrows, const Type type) {
+
+    const unsigned char* data = static_cast<const unsigned char*>(values);
+    std::size_t size = nrows*getWidth(type);
+    std::uint32_t encoding = Plain;
+
+    // integers are replaced by the difference from the previous value, wrapping around
+    if (this->options.delta && (type == Type::Int32) && (nrows > 0)) {
+        this->raw.resize(size);
+        std::uint32_t previous = 0;
+        for (std::size_t i = 0; i < nrows; i++) {
+            std::uint32_t value;
+            memcpy(&value, data + 4*i, 4);
+            const std::uint32_t difference = value - previous;
+            memcpy(&this->raw[4*i], &difference, 4);
+            previous = value;
+        }
+        data = this->raw.data();
+        encoding |= Delta;
+    }
+
+    // and deflated, but only if that saves space
+    if ((this->options.compression_level > 0) && (size > 0)) {
+        uLongf length = compressBound(static_cast<uLong>(size));
+        this->compressed.resize(length);
+        if ((compress2(this->compressed.data(), &length, data, static_cast<uLong>(size), this->options.compression_level) == Z_OK)
+            && (length < size)) {
+            data = this->compressed.data();
+            size = static_cast<std::size_t>(length);
+            encoding |= Deflate;
+        }
+    }
+
+    // every chunk is aligned so that its values can be used in place
+    static const unsigned char zeros[ALIGNMENT] = {};
+    const bool padded = this->writeBytes(zeros, (ALIGNMENT - this->position % ALIGNMENT) % ALIGNMENT);
+
+    ChunkInfo chunk;
+    chunk.offset = this->position;
+    chunk.size = size;
+    chunk.encoding = encoding;
+    chunk.padding = 0;
+    this->chunks.push_back(chunk);
+
+    return this->writeBytes(data, size) && padded;
+}
+
+
+// write a batch as a row group
+bool ColumnarWriter::write(const InteractionBuffer& batch) {
+
+    const InteractionBuffer::Columns& c = batch.getColumns();
+    const std::size_t nrows = batch.getNumInteractions();
+
+    // the event of every row
+    this->rows.resize(nrows);
+    for (std::size_t i = 0; i < batch.getNumEvents(); i++)
+        std::fill(this->rows.begin() + static_cast<std::ptrdiff_t>(c.offsets[i]),
+                  this->rows.begin() + static_cast<std::ptrdiff_t>(c.offsets[i + 1]), c.events[i]);
+
+    // the columns in the same order as COLUMNS
+    const std::array<const void*, NCOLUMNS> columns = {{
+            this->rows.data(), c.trials.data(), c.flavor.data(), c.neutrino.data(), c.energy.data(),
+            c.theta.data(), c.phi.data(), c.r.data(), c.direction_theta.data(), c.direction_phi.data(),
+            c.direction_r.data(), c.current.data(), c.distance.data(), c.weight.data() }};
+
+    bool success = true;
+    for (std::size_t i = 0; i < NCOLUMNS; i++)
+        success &= this->writeChunk(columns[i], nrows, COLUMNS[i].second);
+
+    RowGroupInfo group;
+    group.nrows = nrows;
+    group.nevents = batch.getNumEvents();
+    this->groups.push_back(group);
+
+    return success;
+}
+
+
+// write the footer and move the file into place
+void ColumnarWriter::close(const long total) {
+
+    // finish() may be called more than once
+    if (!this->file)
+        return;
+
+    static const unsigned char zeros[ALIGNMENT] = {};
+    bool written = this->writeBytes(zeros, (ALIGNMENT - this->position % ALIGNMENT) % ALIGNMENT);
+
+    FooterTrailer trailer;
+    memset(&trailer, 0, sizeof(trailer));
+    trailer.offset = this->position;
+    memcpy(trailer.magic, MAGIC, sizeof(MAGIC));
+
+    FooterHeader footer;
+    memset(&footer, 0, sizeof(footer));
+    for (const RowGroupInfo& group : this->groups)
+        footer.nrows += group.nrows;
+    footer.nevents = static_cast<std::uint64_t>(total);
+    footer.ngroups = static_cast<std::uint32_t>(this->groups.size());
+    footer.ncolumns = static_cast<std::uint32_t>(NCOLUMNS);
+    written &= this->writeBytes(&footer, sizeof(footer));
+
+    for (const std::pair<const char*, Type>& column : COLUMNS) {
+        ColumnInfo info;
+        memset(&info, 0, sizeof(info));
+        strncpy(info.name, column.first, sizeof(info.name) - 1);
+        info.type = column.second;
+        info.width = getWidth(column.second);
+        written &= this->writeBytes(&info, sizeof(info));
+    }
+
+    written &= this->writeBytes(this->groups.data(), sizeof(RowGroupInfo)*this->groups.size());
+    written &= this->writeBytes(this->chunks.data(), sizeof(ChunkInfo)*this->chunks.size());
+    written &= this->writeBytes(&trailer, sizeof(trailer));
+
+    // check that everything made it to disk before we move it into place
+    const bool flushed = fclose(this->file) == 0;
+    this->file = nullptr;
+    if (!written || !flushed || (rename(this->temporary.c_str(), this->filename.c_str()) != 0)) {
+        remove(this->temporary.c_str());
+        std::cerr << "Unable to write output file (" << this->filename << "). Quitting..." << std::endl;
+        throw std::exception();
+    }
+}
+
+
+// the I/O thread must stop before the file is closed
+ColumnarWriter::~ColumnarWriter() {
+
+    this->stop();
+
+    // an unfinished file is useless without its footer
+    if (this->file) {
+        fclose(this->file);
+        remove(this->temporary.c_str());
+    }
+}
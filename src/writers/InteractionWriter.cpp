@@ -0,0 +1,114 @@
+#include <iostream>
+#include <TFile.h>
+#include <TTree.h>
+#include <TROOT.h>
+#include <TNamed.h>
+#include <TParameter.h>
+#include <Version.hpp>
+#include <writers/InteractionWriter.hpp>
+
+using namespace anita;
+using namespace anita::writers;
+
+
+InteractionWriter::InteractionWriter(const std::string filename, const WriterOptions opts)
+    : BatchWriter(opts.batch_size, opts.queue_size), tree(nullptr) {
+
+    // the tree is filled on a different thread to the one that created it
+    ROOT::EnableThreadSafety();
+
+    // create the output file
+    this->file.reset(TFile::Open(filename.c_str(), "RECREATE"));
+    if (!this->file || this->file->IsZombie()) {
+        std::cerr << "Unable to create output file (" << filename << "). Quitting..." << std::endl;
+        throw std::exception();
+    }
+    this->file->SetCompressionAlgorithm(opts.compression_algorithm);
+    this->file->SetCompressionLevel(opts.compression_level);
+
+    // the tree is owned by the file
+    this->file->cd();
+    this->tree = new TTree("interactions", "The interactions of every propagated neutrino");
+
+    // and create a branch for every column
+    const int basket = opts.basket_size;
+    this->tree->Branch("event", &this->entry.event, "event/I", basket);
+    this->tree->Branch("trials", &this->entry.trials, "trials/I", basket);
+    this->tree->Branch("flavor", &this->entry.flavor, "flavor/b", basket);
+    this->tree->Branch("neutrino", &this->entry.neutrino, "neutrino/b", basket);
+    this->tree->Branch("energy", &this->entry.energy, "energy/D", basket);
+    this->tree->Branch("theta", &this->entry.theta, "theta/D", basket);
+    this->tree->Branch("phi", &this->entry.phi, "phi/D", basket);
+    this->tree->Branch("r", &this->entry.r, "r/D", basket);
+    this->tree->Branch("direction_theta", &this->entry.direction_theta, "direction_theta/D", basket);
+    this->tree->Branch("direction_phi", &this->entry.direction_phi, "direction_phi/D", basket);
+    this->tree->Branch("direction_r", &this->entry.direction_r, "direction_r/D", basket);
+    this->tree->Branch("current", &this->entry.current, "current/b", basket);
+    this->tree->Branch("distance", &this->entry.distance, "distance/D", basket);
+    this->tree->Branch("weight", &this->entry.weight, "weight/D", basket);
+}
+
+
+// fill the tree with a batch
+bool InteractionWriter::write(const InteractionBuffer& batch) {
+
+    const InteractionBuffer::Columns& c = batch.getColumns();
+
+    bool success = true;
+    for (std::size_t i = 0; i < batch.getNumEvents(); i++) {
+        for (std::size_t row = c.offsets[i]; row < c.offsets[i + 1]; row++) {
+            this->entry.event = c.events[i];
+            this->entry.trials = c.trials[row];
+            this->entry.flavor = c.flavor[row];
+            this->entry.neutrino = c.neutrino[row];
+            this->entry.energy = c.energy[row];
+            this->entry.theta = c.theta[row];
+            this->entry.phi = c.phi[row];
+            this->entry.r = c.r[row];
+            this->entry.direction_theta = c.direction_theta[row];
+            this->entry.direction_phi = c.direction_phi[row];
+            this->entry.direction_r = c.direction_r[row];
+            this->entry.current = c.current[row];
+            this->entry.distance = c.distance[row];
+            this->entry.weight = c.weight[row];
+
+            success &= (this->tree->Fill() >= 0);
+        }
+    }
+
+    return success;
+}
+
+
+// write the tree and the metadata
+void InteractionWriter::close(const long total) {
+
+    // finish() may be called more than once
+    if (!this->file)
+        return;
+
+    // the I/O thread has finished, so the tree is ours again
+    this->file->cd();
+    this->tree->Write();
+
+    // and record what produced this file
+    TNamed("hash", SOURCE_HASH).Write();
+    TNamed("commit", GIT_COMMIT).Write();
+    TParameter<long>("nevents", total).Write();
+
+    this->file->Close();
+    this->file.reset();
+}
+
+
+// the I/O thread must stop before the tree is destroyed
+InteractionWriter::~InteractionWriter() {
+
+    this->stop();
+
+    if (this->file) {
+        this->file->cd();
+        this->tree->Write();
+        this->file->Close();
+    }
+}
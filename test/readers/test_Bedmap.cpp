@@ -1,6 +1,8 @@
+#include <vector>
 #include <fstream>
 #include <iostream>
 #include <doctest.h>
+#include <Random.hpp>
 #include <Constants.hpp>
 #include <readers/Bedmap.hpp>
 #include <boost/spirit/include/qi.hpp>
@@ -15,6 +17,82 @@ TEST_CASE("CREATE BEDMAP") {
     anita::readers::Bedmap _bedmap = anita::readers::Bedmap();
 }
 
+// Checks that the memory-mapped rasters agree exactly with the rasters read onto the heap
+TEST_CASE("BEDMAP STORAGE") {
+
+    // one Bedmap read each way
+    const anita::readers::Bedmap mapped(anita::readers::BedmapStorage::MemoryMap);
+    const anita::readers::Bedmap heap(anita::readers::BedmapStorage::Heap);
+
+    // and compare them on a coarse grid over the whole continent
+    for (double lat = -90; lat <= -60; lat += 0.5) {
+        for (double lon = -180; lon < 180; lon += 5) {
+            const double theta = (PI/2.) - anita::degToRad(lat);
+            const double phi = anita::degToRad(lon);
+
+            // NaN's must match NaN's
+            const double msurface = mapped.getSurfaceElevation(theta, phi);
+            const double hsurface = heap.getSurfaceElevation(theta, phi);
+            CHECK(std::isnan(msurface) == std::isnan(hsurface));
+            if (!std::isnan(hsurface))
+                CHECK(msurface == hsurface);
+
+            const double mbed = mapped.getBedDepth(theta, phi);
+            const double hbed = heap.getBedDepth(theta, phi);
+            CHECK(std::isnan(mbed) == std::isnan(hbed));
+            if (!std::isnan(hbed))
+                CHECK(mbed == hbed);
+
+            CHECK(mapped.getIceMask(theta, phi) == heap.getIceMask(theta, phi));
+        }
+    }
+
+    // and the tiled layout must agree exactly with the planar one
+    const anita::readers::Bedmap tiled(anita::readers::BedmapStorage::MemoryMap,
+                                       anita::readers::BedmapLayout::Tiled);
+    for (double x = -3333; x <= 3333; x += 37.3) {
+        for (double y = -3333; y <= 3333; y += 41.7) {
+            const anita::readers::BedmapPoint expected = mapped.queryAtPoint(x, y);
+            const anita::readers::BedmapPoint point = tiled.queryAtPoint(x, y);
+
+            CHECK(std::isnan(point.surface) == std::isnan(expected.surface));
+            if (!std::isnan(expected.surface)) CHECK(point.surface == expected.surface);
+            CHECK(std::isnan(point.thickness) == std::isnan(expected.thickness));
+            if (!std::isnan(expected.thickness)) CHECK(point.thickness == expected.thickness);
+            CHECK(std::isnan(point.bed) == std::isnan(expected.bed));
+            if (!std::isnan(expected.bed)) CHECK(point.bed == expected.bed);
+            CHECK(point.mask == expected.mask);
+        }
+    }
+
+    // whole rows of cells must agree with single cells, in either layout
+    std::vector<anita::readers::BedmapPoint> planarrow(static_cast<std::size_t>(mapped.getNumColumns()));
+    std::vector<anita::readers::BedmapPoint> tiledrow(static_cast<std::size_t>(mapped.getNumColumns()));
+    for (int row = 0; row < mapped.getNumRows(); row += 997) {
+        mapped.queryRow(row, planarrow.data());
+        tiled.queryRow(row, tiledrow.data());
+        for (int col = 0; col < mapped.getNumColumns(); col += 7) {
+            const anita::readers::BedmapPoint expected = mapped.queryAtCell(col, row);
+            const anita::readers::BedmapPoint& planar = planarrow[static_cast<std::size_t>(col)];
+            const anita::readers::BedmapPoint& point = tiledrow[static_cast<std::size_t>(col)];
+
+            CHECK(planar.x == expected.x);
+            CHECK(planar.y == expected.y);
+            CHECK(std::isnan(planar.surface) == std::isnan(expected.surface));
+            if (!std::isnan(expected.surface)) CHECK(planar.surface == expected.surface);
+            CHECK(std::isnan(point.surface) == std::isnan(expected.surface));
+            if (!std::isnan(expected.surface)) CHECK(point.surface == expected.surface);
+            CHECK(std::isnan(point.bed) == std::isnan(expected.bed));
+            if (!std::isnan(expected.bed)) CHECK(point.bed == expected.bed);
+            CHECK(point.mask == expected.mask);
+        }
+    }
+
+    // copies of a Bedmap share the same mapping
+    const anita::readers::Bedmap copy = mapped;
+    CHECK(copy.getBedDepth(PI, 0) == mapped.getBedDepth(PI, 0));
+}
+
 // Perform some basic checking and validation at a single point
 TEST_CASE("BASIC BEDMAP QUERIES") {
 
@@ -39,6 +117,51 @@ TEST_CASE("BASIC BEDMAP QUERIES") {
     CHECK(std::isnan(bedmap.getBedDepth((PI/2.) - anita::degToRad(-90), 0)) == false);
     CHECK(std::isnan(static_cast<int>(bedmap.getIceMask((PI/2.) - anita::degToRad(-90), 0))) == false);
 
+    // the inverse projection must undo the forward projection
+    SUBCASE("INVERSE PROJECTION") {
+        for (double lat = -89.5; lat <= -60; lat += 2.5) {
+            for (double lon = -175; lon < 180; lon += 15) {
+                const double theta = (PI/2.) - anita::degToRad(lat);
+                const double phi = anita::degToRad(lon);
+                const anita::readers::BedmapPoint point = bedmap.query(theta, phi);
+                const std::pair<double, double> coord = bedmap.BEDMAPLocationToCoord(point.x, point.y);
+                CHECK(coord.first == doctest::Approx(theta).epsilon(1e-12));
+                CHECK(coord.second == doctest::Approx(phi).epsilon(1e-12));
+            }
+        }
+
+        // the scale factor is one at the true scale latitude, and the limit at the pole is ~0.97276
+        const anita::readers::BedmapPoint truescale = bedmap.query((PI/2.) - anita::readers::latc, 0);
+        CHECK(bedmap.getScaleFactor(truescale.x, truescale.y) == doctest::Approx(1).epsilon(1e-9));
+        CHECK(bedmap.getScaleFactor(0, 0) == doctest::Approx(bedmap.getScaleFactor(0, 1e-3)).epsilon(1e-6));
+    }
+
+    // the fused query must agree exactly with the individual getters
+    SUBCASE("FUSED QUERY") {
+        for (double lat = -89.5; lat <= -65; lat += 2.5) {
+            for (double lon = -180; lon < 180; lon += 15) {
+                const double theta = (PI/2.) - anita::degToRad(lat);
+                const double phi = anita::degToRad(lon);
+                const anita::readers::BedmapPoint point = bedmap.query(theta, phi);
+
+                // NaN's must match NaN's
+                const double surface = bedmap.getSurfaceElevation(theta, phi);
+                CHECK(std::isnan(point.surface) == std::isnan(surface));
+                if (!std::isnan(surface)) CHECK(point.surface == surface);
+
+                const double thickness = bedmap.getIceThickness(theta, phi);
+                CHECK(std::isnan(point.thickness) == std::isnan(thickness));
+                if (!std::isnan(thickness)) CHECK(point.thickness == thickness);
+
+                const double bed = bedmap.getBedDepth(theta, phi);
+                CHECK(std::isnan(point.bed) == std::isnan(bed));
+                if (!std::isnan(bed)) CHECK(point.bed == bed);
+
+                CHECK(point.mask == bedmap.getIceMask(theta, phi));
+            }
+        }
+    }
+
     // this is a simple test case that is used to debug internal indexing issues
     // with the Bedmap methods
     SUBCASE("INDEX CHECK") {
@@ -48,6 +171,88 @@ TEST_CASE("BASIC BEDMAP QUERIES") {
 
 }
 
+// Checks that walking a path across the grid agrees with querying every point along it
+TEST_CASE("BEDMAP WALKER") {
+
+    const anita::readers::Bedmap bedmap;
+
+    beginEvent(0);
+
+    // compare a segment's profile to a query at the same point. Exactly on the boundary
+    // of a cell next to a NaN, either side may be NaN so we only compare the values
+    auto check = [&bedmap](const anita::readers::BedmapProfile& profile, const double x, const double y) {
+        const anita::readers::BedmapPoint point = bedmap.queryAtPoint(x, y);
+        if (!std::isnan(point.surface) && !std::isnan(profile.surface))
+            CHECK(profile.surface == doctest::Approx(point.surface).epsilon(1e-9));
+        if (!std::isnan(point.bed) && !std::isnan(profile.bed))
+            CHECK(profile.bed == doctest::Approx(point.bed).epsilon(1e-9));
+        if (!std::isnan(point.thickness) && !std::isnan(profile.thickness))
+            CHECK(profile.thickness == doctest::Approx(point.thickness).epsilon(1e-9));
+    };
+
+    SUBCASE("RANDOM PATHS") {
+        std::vector<anita::readers::BedmapSegment> segments;
+        for (int i = 0; i < 200; i++) {
+
+            // a random path, including some along the rows, columns and diagonals through corners
+            double x = uniform(-3000, 3000);
+            double y = uniform(-3000, 3000);
+            const double angle = (i % 4 == 0) ? (PI/4.)*(i % 8) : uniform(0, 2*PI);
+            if (i % 4 == 0) { x = floor(x) + 0.5; y = floor(y) + 0.5; }
+            const double dx = cos(angle);
+            const double dy = sin(angle);
+            const double length = uniform(0, 300);
+
+            REQUIRE(bedmap.walk(x, y, dx, dy, length, segments) > 0);
+
+            // the segments must cover the whole path in order
+            CHECK(segments.front().start == 0);
+            CHECK(segments.back().end == doctest::Approx(length));
+            for (std::size_t j = 0; j < segments.size(); j++) {
+                const anita::readers::BedmapSegment& segment = segments[j];
+                CHECK(segment.end >= segment.start);
+                if (j > 0) CHECK(segment.start == segments[j - 1].end);
+
+                // agree with the queries at either end
+                check(segment.entry, x + segment.start*dx, y + segment.start*dy);
+                check(segment.exit, x + segment.end*dx, y + segment.end*dy);
+
+                // strictly within the cell, the fields are NaN exactly where the queries are
+                const double middle = 0.5*(segment.start + segment.end);
+                const anita::readers::BedmapPoint point = bedmap.queryAtPoint(x + middle*dx, y + middle*dy);
+                CHECK(std::isnan(segment.mean.surface) == std::isnan(point.surface));
+                CHECK(std::isnan(segment.mean.bed) == std::isnan(point.bed));
+
+                // and the average along the segment. The error of the midpoint rule for a
+                // quadratic goes exactly as 1/N^2, which Richardson extrapolation removes
+                if (!std::isnan(segment.mean.bed) && (segment.end - segment.start > 1e-3)) {
+                    double midpoint[2] = { 0, 0 };
+                    for (int n = 0; n < 2; n++) {
+                        const int N = 8 << n;
+                        for (int k = 0; k < N; k++) {
+                            const double s = segment.start + (k + 0.5)*(segment.end - segment.start)/N;
+                            midpoint[n] += bedmap.queryAtPoint(x + s*dx, y + s*dy).bed/N;
+                        }
+                    }
+                    CHECK(segment.mean.bed == doctest::Approx((4*midpoint[1] - midpoint[0])/3.).epsilon(1e-9));
+                }
+            }
+        }
+    }
+
+    SUBCASE("EDGE OF THE GRID") {
+        // a path along a row starts on a cell boundary, crosses 333 whole cells, and
+        // stops half way across the last one at the edge of the grid
+        std::vector<anita::readers::BedmapSegment> segments;
+        bedmap.walk(3000, 0.3, 1, 0, 1000, segments);
+        CHECK(segments.back().end == doctest::Approx(333.5));
+        CHECK(segments.size() == 334);
+
+        // and we have to start on the grid
+        CHECK_THROWS(bedmap.walk(4000, 0, -1, 0, 1000, segments));
+    }
+}
+
 // this test loads the test data file 'bedmap_test_data.csv' that is generated by
 // the generate_Bedmap_test_values.m Matlab script and verifies that this Bedmap
 // implementation agrees with the Matlab Antarctic Mapping Toolbox.
@@ -0,0 +1,120 @@
+#include <math.h>
+#include <limits>
+#include <algorithm>
+#include <vector>
+#include <doctest.h>
+#include <Random.hpp>
+#include <readers/Bilinear.hpp>
+
+TEST_SUITE_BEGIN("bilinear");
+
+TEST_CASE("BILINEAR GATHER KERNELS") {
+
+    // a small Bedmap-style grid centered on the origin
+    const anita::readers::BilinearGrid grid = { 101, 77, -50.5, -38.5 };
+    const std::size_t ncells = static_cast<std::size_t>(grid.ncols*grid.nrows);
+
+    // a raster that is linear in the column and row (which bilinear interpolation
+    // reproduces exactly), and a raster of noise with a few NaN's
+    std::vector<float> linear(ncells), noise(ncells);
+    beginEvent(0);
+    for (int row = 0; row < grid.nrows; row++) {
+        for (int col = 0; col < grid.ncols; col++) {
+            const std::size_t i = static_cast<std::size_t>(row*grid.ncols + col);
+            linear[i] = static_cast<float>(2*col - 3*row);
+            noise[i] = uniform() < 0.01 ? std::numeric_limits<float>::quiet_NaN() : static_cast<float>(gaussian());
+        }
+    }
+    const float* rasters[2] = { linear.data(), noise.data() };
+
+    // points over the whole grid, including the edges, which is not a multiple of the vector width
+    const std::size_t N = 10007;
+    std::vector<double> x(N), y(N);
+    for (std::size_t i = 0; i < N; i++) {
+        x[i] = uniform(grid.xllcorner, -grid.xllcorner);
+        y[i] = uniform(grid.yllcorner, -grid.yllcorner);
+    }
+    x[0] = grid.xllcorner; y[0] = grid.yllcorner;
+    x[1] = -grid.xllcorner; y[1] = -grid.yllcorner;
+    x[2] = std::numeric_limits<double>::quiet_NaN();
+
+    // evaluate with the dispatching kernel
+    std::vector<double> lin(N), noi(N);
+    double* out[2] = { lin.data(), noi.data() };
+    anita::readers::interpolateBilinear(grid, N, x.data(), y.data(), 2, rasters, out);
+
+    SUBCASE("Linear rasters are reproduced exactly") {
+        for (std::size_t i = 3; i < N; i++) {
+            // the column and row of this point, clamped onto the grid
+            const double col = std::min(std::max(x[i] - grid.xllcorner - 0.5, 0.), grid.ncols - 1.);
+            const double row = std::min(std::max(-(y[i] + grid.yllcorner) - 0.5, 0.), grid.nrows - 1.);
+            CHECK(lin[i] == doctest::Approx(2*col - 3*row).epsilon(1e-12));
+        }
+
+        // NaN positions give NaN values
+        CHECK(std::isnan(lin[2]));
+    }
+
+    SUBCASE("Every kernel gives identical results") {
+
+        // the scalar kernel always runs
+        std::vector<double> slin(N), snoi(N);
+        double* sout[2] = { slin.data(), snoi.data() };
+        anita::readers::interpolateBilinearScalar(grid, N, x.data(), y.data(), 2, rasters, sout);
+
+        // and the vector kernels if this CPU supports them
+        std::vector<double> vlin(N), vnoi(N);
+        double* vout[2] = { vlin.data(), vnoi.data() };
+
+        auto same = [](const double a, const double b) { return (std::isnan(a) && std::isnan(b)) || (a == b); };
+        auto compare = [&]() {
+            for (std::size_t i = 0; i < N; i++) {
+                CHECK(same(slin[i], vlin[i]));
+                CHECK(same(snoi[i], vnoi[i]));
+                CHECK(same(slin[i], lin[i]));
+                CHECK(same(snoi[i], noi[i]));
+            }
+        };
+
+        if (__builtin_cpu_supports("avx2")) {
+            anita::readers::interpolateBilinearAVX2(grid, N, x.data(), y.data(), 2, rasters, vout);
+            compare();
+        }
+        if (__builtin_cpu_supports("avx512f")) {
+            anita::readers::interpolateBilinearAVX512(grid, N, x.data(), y.data(), 2, rasters, vout);
+            compare();
+        }
+    }
+
+    SUBCASE("The vector kernels accept any number of rasters") {
+
+        // more rasters than fit in one pass, alternating the linear and noise rasters
+        const std::size_t M = 11;
+        std::vector<const float*> many(M);
+        std::vector<std::vector<double>> values(M, std::vector<double>(N));
+        std::vector<double*> mout(M);
+        for (std::size_t r = 0; r < M; r++) {
+            many[r] = rasters[r % 2];
+            mout[r] = values[r].data();
+        }
+
+        auto same = [](const double a, const double b) { return (std::isnan(a) && std::isnan(b)) || (a == b); };
+        auto compare = [&]() {
+            for (std::size_t r = 0; r < M; r++) {
+                const std::vector<double>& expected = r % 2 ? noi : lin;
+                for (std::size_t i = 0; i < N; i++) CHECK(same(values[r][i], expected[i]));
+            }
+        };
+
+        if (__builtin_cpu_supports("avx2")) {
+            anita::readers::interpolateBilinearAVX2(grid, N, x.data(), y.data(), M, many.data(), mout.data());
+            compare();
+        }
+        if (__builtin_cpu_supports("avx512f")) {
+            anita::readers::interpolateBilinearAVX512(grid, N, x.data(), y.data(), M, many.data(), mout.data());
+            compare();
+        }
+    }
+}
+
+TEST_SUITE_END();
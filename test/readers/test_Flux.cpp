@@ -1,6 +1,8 @@
 #include <string>
 #include <vector>
+#include <cmath>
 #include <iostream>
+#include <Random.hpp>
 #include <root/TFile.h>
 #include <root/TAxis.h>
 #include <root/TGraph.h>
@@ -116,4 +118,80 @@ TEST_CASE("GRAPH FLUX MODELS") {
 
 }
 
+///
+/// \brief Check that the inverse CDF samples energies in proportion to the flux
+///
+TEST_CASE("SAMPLE FLUX MODELS") {
+
+    const Flux flux(std::string("Kotera2010_mix_max"));
+
+    SUBCASE("CDF") {
+        // the CDF covers the whole flux file and only increases
+        CHECK(flux.getCDF(flux.min_energy) == 0.);
+        CHECK(flux.getCDF(flux.max_energy) == 1.);
+        CHECK(flux.getCDF(flux.min_energy - 1) == 0.);
+        CHECK(flux.getCDF(flux.max_energy + 1) == 1.);
+        for (double E = flux.min_energy; E < flux.max_energy; E += 0.01)
+            CHECK(flux.getCDF(E + 0.01) >= flux.getCDF(E));
+
+        // and matches the integral of the flux
+        const double middle = 0.5*(flux.min_energy + flux.max_energy);
+        double below = 0;
+        double total = 0;
+        const int N = 100000;
+        for (int i = 0; i < N; i++) {
+            const double E = flux.min_energy + (i + 0.5)*(flux.max_energy - flux.min_energy)/N;
+            total += pow(10., flux.getFlux(E));
+            if (E < middle) below += pow(10., flux.getFlux(E));
+        }
+        CHECK(flux.getCDF(middle) == doctest::Approx(below/total).epsilon(1e-3));
+    }
+
+    SUBCASE("INVERSE CDF") {
+        // the inverse CDF is the inverse of the CDF
+        CHECK(flux.getInverseCDF(0.) == doctest::Approx(flux.min_energy));
+        CHECK(flux.getInverseCDF(1.) <= flux.max_energy);
+        CHECK(flux.getCDF(flux.getInverseCDF(1.)) == doctest::Approx(1.));
+        for (double fraction = 0.01; fraction < 1.; fraction += 0.01)
+            CHECK(flux.getCDF(flux.getInverseCDF(fraction)) == doctest::Approx(fraction).epsilon(1e-12));
+
+        // including deep in the tails, where the CDF is steepest or flattest
+        for (double fraction = 1e-9; fraction < 1e-2; fraction *= 10) {
+            CHECK(flux.getCDF(flux.getInverseCDF(fraction)) == doctest::Approx(fraction).epsilon(1e-9));
+            CHECK(flux.getCDF(flux.getInverseCDF(1 - fraction)) == doctest::Approx(1 - fraction).epsilon(1e-12));
+        }
+    }
+
+    SUBCASE("DENSITY") {
+        // the tabulated density follows the spline, and is zero outside of the flux file
+        for (double E = flux.min_energy; E < flux.max_energy; E += 0.0137)
+            CHECK(flux.getDensity(E) == doctest::Approx(log(10.)*pow(10., flux.getFlux(E))).epsilon(1e-5));
+        CHECK(flux.getDensity(flux.max_energy) == doctest::Approx(log(10.)*pow(10., flux.getFlux(flux.max_energy))));
+        CHECK(flux.getDensity(flux.min_energy - 0.01) == 0.);
+        CHECK(flux.getDensity(flux.max_energy + 0.01) == 0.);
+    }
+
+    SUBCASE("SAMPLING") {
+        beginEvent(0);
+
+        // sample energies with uniform fractions
+        const int N = 100000;
+        const int nbins = 20;
+        std::vector<double> counts(nbins, 0.);
+        const double width = (flux.max_energy - flux.min_energy)/nbins;
+        for (int i = 0; i < N; i++) {
+            const double E = flux.getInverseCDF(uniform());
+            CHECK(E >= flux.min_energy);
+            CHECK(E <= flux.max_energy);
+            counts[std::min(static_cast<std::size_t>((E - flux.min_energy)/width), counts.size() - 1)] += 1./N;
+        }
+
+        // and the fraction in each bin follows the flux, within the statistical error
+        for (int j = 0; j < nbins; j++) {
+            const double expected = flux.getCDF(flux.min_energy + (j + 1)*width) - flux.getCDF(flux.min_energy + j*width);
+            CHECK(fabs(counts[static_cast<std::size_t>(j)] - expected) < 5*sqrt(expected/N) + 1e-4);
+        }
+    }
+}
+
 TEST_SUITE_END();
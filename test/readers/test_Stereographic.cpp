@@ -0,0 +1,89 @@
+#include <math.h>
+#include <vector>
+#include <limits>
+#include <doctest.h>
+#include <Random.hpp>
+#include <Constants.hpp>
+#include <readers/Bedmap.hpp>
+#include <readers/Stereographic.hpp>
+
+TEST_SUITE_BEGIN("stereographic");
+
+using anita::PI;
+
+// the Snyder formulas as evaluated by Bedmap::coordToBEDMAPLocation
+static void snyder(const double theta, const double phi, double& x, double& y) {
+    const double lat = (PI/2.) - theta;
+    const double t = tan(PI/4 + lat/2)/pow( (1 - anita::EARTH_E*sin(-lat))/(1 + anita::EARTH_E*sin(-lat)), anita::EARTH_E/2.);
+    const double p = t*anita::readers::AMTC;
+    x = -p*sin(-phi);
+    y = p*cos(-phi);
+}
+
+TEST_CASE("BATCH PROJECTION") {
+
+    // a set of points in the southern hemisphere, which is not a multiple of the vector width
+    const std::size_t N = 100003;
+    std::vector<double> theta(N), phi(N);
+    beginEvent(0);
+    for (std::size_t i = 0; i < N; i++) {
+        theta[i] = uniform(PI/2., PI);
+        phi[i] = uniform(-4*PI, 4*PI);
+    }
+
+    // and a few special cases - the south pole, the north pole, and NaN
+    theta[0] = PI;
+    theta[1] = 0;
+    theta[2] = std::numeric_limits<double>::quiet_NaN();
+
+    std::vector<double> x(N), y(N), xs(N), ys(N);
+    std::vector<std::uint8_t> inrange(N), inranges(N);
+    const std::size_t valid = anita::readers::projectStereographic(N, theta.data(), phi.data(),
+                                                                   x.data(), y.data(), inrange.data(), 3333.5);
+    const std::size_t valids = anita::readers::projectStereographicScalar(N, theta.data(), phi.data(),
+                                                                          xs.data(), ys.data(), inranges.data(), 3333.5);
+
+    SUBCASE("Vector and scalar kernels are identical") {
+        CHECK(valid == valids);
+        for (std::size_t i = 0; i < N; i++) {
+            CHECK(inrange[i] == inranges[i]);
+            if (inrange[i]) {
+                CHECK(x[i] == xs[i]);
+                CHECK(y[i] == ys[i]);
+            }
+        }
+    }
+
+    SUBCASE("Agrees with the Snyder formulas") {
+        std::size_t expected = 0;
+        for (std::size_t i = 3; i < N; i++) {
+            double sx, sy;
+            snyder(theta[i], phi[i], sx, sy);
+
+            // the status must agree with the bounds check in coordToBEDMAPLocation
+            const bool in = (fabs(sx) <= 3333.5) && (fabs(sy) <= 3333.5);
+            CHECK(static_cast<bool>(inrange[i]) == in);
+            expected += in;
+
+            // and the error is far below the size of a cell
+            if (in) {
+                CHECK(fabs(x[i] - sx) < 1e-11);
+                CHECK(fabs(y[i] - sy) < 1e-11);
+            }
+            else {
+                CHECK(std::isnan(x[i]));
+                CHECK(std::isnan(y[i]));
+            }
+        }
+
+        // the south pole is the center of the grid, and the rest are out of range
+        CHECK(inrange[0] == 1);
+        CHECK(fabs(x[0]) < 1e-11);
+        CHECK(fabs(y[0]) < 1e-11);
+        CHECK(inrange[1] == 0);
+        CHECK(inrange[2] == 0);
+        CHECK(valid == expected + 1);
+    }
+}
+
+TEST_SUITE_END();
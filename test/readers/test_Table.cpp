@@ -0,0 +1,63 @@
+#include <thread>
+#include <vector>
+#include <Random.hpp>
+#include <readers/Table.hpp>
+
+#include <doctest.h>
+
+using namespace anita::readers;
+
+TEST_SUITE_BEGIN("table");
+
+TEST_CASE("TABLE REGISTRY") {
+
+    // start loading every table in the background
+    TableRegistry::preload();
+
+    SUBCASE("Tables are only loaded once") {
+        const YTable& first = TableRegistry::getYTable("final_cteq5_cc_nu.data");
+        const YTable& second = TableRegistry::getYTable("final_cteq5_cc_nu.data");
+        CHECK(&first == &second);
+        CHECK(&first != &TableRegistry::getYTable("final_cteq5_nc_nu.data"));
+    }
+
+    SUBCASE("Concurrent requests share the same table") {
+
+        // request the decay table from several threads at once
+        std::vector<const YTable*> tables(8, nullptr);
+        std::vector<std::thread> threads;
+        for (unsigned int i = 0; i < tables.size(); i++) {
+            threads.emplace_back([&tables, i]() { tables[i] = &TableRegistry::getYTable("tau_decay_tauola.data"); });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        // and check that everybody got the same one
+        for (auto& table : tables) {
+            CHECK(table == tables[0]);
+        }
+    }
+
+    SUBCASE("Single values match the full final state") {
+        const YTable& table = TableRegistry::getYTable("final_cteq5_cc_nu.data");
+        for (unsigned int event = 0; event < 100; event++) {
+            const double energy = 15 + 0.06*event;
+
+            // the same random stream picks the same final state
+            beginEvent(event);
+            const std::vector<double> final = table.evaluate(energy);
+            beginEvent(event);
+            CHECK(table.evaluate(energy, 0) == final[0]);
+            beginEvent(event);
+            CHECK(table.evaluate(energy, 1) == final[1]);
+        }
+        CHECK_THROWS(table.evaluate(18, 2));
+    }
+
+    SUBCASE("Missing tables throw") {
+        CHECK_THROWS(TableRegistry::getYTable("does_not_exist.data"));
+    }
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,197 @@
+#include <cmath>
+#include <doctest.h>
+#include <Random.hpp>
+#include <Continent.hpp>
+#include <Acceptance.hpp>
+#include <Propagator.hpp>
+#include <readers/Flux.hpp>
+
+TEST_SUITE_BEGIN("acceptance");
+
+// an interaction of a neutrino at `depth` (km) below the ice at (theta, phi)
+static anita::Interaction interactionAt(const anita::Continent& continent, const double theta, const double phi,
+                                        const double depth, const double energy, const anita::Current current) {
+
+    const anita::ParticleState neutrino{anita::Flavor::Tau, true, energy};
+    return anita::Interaction(1, neutrino, anita::SphericalCoordinate(theta, phi, continent.getSurfaceRadius(theta, phi) - depth),
+                              anita::SphericalCoordinate(), current, 0);
+}
+
+TEST_CASE("ACCEPTANCE") {
+
+    const anita::Continent continent;
+    const double theta = 170*anita::PI/180.;
+    const double phi = 0.3;
+
+    SUBCASE("EVERY NEUTRINO INTERACTS") {
+        beginEvent(0);
+
+        // if every neutrino interacts at the surface, the acceptance is all of the generation acceptance
+        const anita::Propagator propagator(continent, anita::readers::REFERENCE_FLUX, 0, 14., 20.);
+        const anita::readers::Flux reference(anita::readers::REFERENCE_FLUX);
+        const int N = 20000;
+        anita::Acceptance acceptance(propagator, continent, 3, 10., 5);
+        acceptance.begin(2);
+
+        for (int i = 0; i < N; i++) {
+
+            // a neutrino drawn from the reference flux like the propagator does
+            const double energy = reference.getInverseCDF(reference.getCDF(14.) + (reference.getCDF(20.) - reference.getCDF(14.))*uniform());
+            anita::InteractionList interactions = { interactionAt(continent, theta, phi, 0.1, energy, anita::Current::Charged) };
+            interactions.back().weight = propagator.getGenerationWeight(energy);
+            acceptance.consume(static_cast<unsigned int>(i % 2), i, interactions);
+        }
+        acceptance.finish();
+
+        CHECK(acceptance.getNumEvents() == N);
+        CHECK(acceptance.getNumEnergyBins() == 3);
+        CHECK(acceptance.getEnergy(0) == doctest::Approx(15.));
+        CHECK(acceptance.getDepth(0) == doctest::Approx(1.));
+        for (std::size_t bin = 0; bin < acceptance.getNumEnergyBins(); bin++) {
+            const double expected = propagator.getGenerationAcceptance();
+            const double error = acceptance.getError(bin, anita::Flavor::Tau, anita::Current::Charged, 0);
+            CHECK(error > 0);
+            CHECK(fabs(acceptance.getAcceptance(bin, anita::Flavor::Tau, anita::Current::Charged) - expected) < 5*error);
+
+            // and every other bin is empty
+            CHECK(acceptance.getAcceptance(bin, anita::Flavor::Tau, anita::Current::Neutral) == 0);
+            CHECK(acceptance.getAcceptance(bin, anita::Flavor::Muon, anita::Current::Charged) == 0);
+            CHECK(acceptance.getAcceptance(bin, anita::Flavor::Tau, anita::Current::Charged, 1) == 0);
+
+            // the effective volume is the acceptance times the interaction length
+            CHECK(acceptance.getVolume(bin, anita::Flavor::Tau, anita::Current::Charged) > 0);
+
+            // and every interaction is in a single bin
+            CHECK(acceptance.getAcceptance(bin) == doctest::Approx(acceptance.getAcceptance(bin, anita::Flavor::Tau, anita::Current::Charged)));
+            CHECK(acceptance.getError(bin) == doctest::Approx(error));
+        }
+
+        // which is known to about 2% with this many events in each bin
+        CHECK(acceptance.isConverged(0.05));
+        CHECK(!acceptance.isConverged(0.001));
+    }
+
+    SUBCASE("FIXED ENERGY") {
+
+        // with a fixed energy there is a single bin and every event has the same weight
+        const anita::Propagator propagator(continent, anita::readers::REFERENCE_FLUX, 18., 14., 20.);
+        const int N = 100;
+        anita::Acceptance acceptance(propagator, continent, 10, 10., 2);
+        acceptance.begin(1);
+        for (int i = 0; i < N; i++) {
+            anita::InteractionList interactions;
+            if (i % 4 == 0) {
+                // a NC interaction followed by a CC interaction further down
+                interactions.push_back(interactionAt(continent, theta, phi, 1., 18., anita::Current::Neutral));
+                interactions.push_back(interactionAt(continent, theta, phi, 7., 17.5, anita::Current::Charged));
+            }
+            else if (i % 4 == 1) {
+                // an interaction that is too deep to count
+                interactions.push_back(interactionAt(continent, theta, phi, 20., 18., anita::Current::Charged));
+            }
+            acceptance.consume(0, i, interactions);
+        }
+        acceptance.finish();
+
+        const double each = propagator.getGenerationAcceptance()/N;
+        CHECK(acceptance.getNumEnergyBins() == 1);
+        CHECK(acceptance.getEnergy(0) == doctest::Approx(18.));
+        CHECK(acceptance.getAcceptance(0, anita::Flavor::Tau, anita::Current::Neutral, 0) == doctest::Approx(25*each));
+        CHECK(acceptance.getAcceptance(0, anita::Flavor::Tau, anita::Current::Charged, 1) == doctest::Approx(25*each));
+        CHECK(acceptance.getAcceptance(0, anita::Flavor::Tau, anita::Current::Charged, 0) == 0);
+
+        // and the two interactions of an event are a single sample of the energy bin
+        CHECK(acceptance.getError(0, anita::Flavor::Tau, anita::Current::Neutral, 0) == doctest::Approx(5*each));
+        CHECK(acceptance.getError(0) == doctest::Approx(10*each));
+    }
+
+    SUBCASE("DEPTH BELOW THE SURFACE") {
+
+        // an interaction at sea level is as deep as the ice surface is high
+        const anita::Propagator propagator(continent, anita::readers::REFERENCE_FLUX, 18., 14., 20.);
+        const double elevation = continent.getSurfaceRadius(theta, phi) - continent.getEarthRadius(theta);
+        REQUIRE(elevation > 1);
+        REQUIRE(elevation < 5);
+
+        // with 1 km depth bins
+        anita::Acceptance acceptance(propagator, continent, 1, 10., 10);
+        acceptance.begin(1);
+        const anita::ParticleState neutrino{anita::Flavor::Tau, true, 18.};
+        anita::InteractionList interactions = {
+            anita::Interaction(1, neutrino, anita::SphericalCoordinate(theta, phi, continent.getEarthRadius(theta)),
+                               anita::SphericalCoordinate(), anita::Current::Charged, 0) };
+        acceptance.consume(0, 0, interactions);
+        acceptance.finish();
+
+        const std::size_t bin = static_cast<std::size_t>(elevation);
+        CHECK(acceptance.getAcceptance(0, anita::Flavor::Tau, anita::Current::Charged, bin) > 0);
+        CHECK(acceptance.getAcceptance(0, anita::Flavor::Tau, anita::Current::Charged, 0) == 0);
+    }
+
+    SUBCASE("CONVERGENCE WITH REGENERATION") {
+
+        // half of the neutrinos regenerate twice, leaving three interactions in the same bin
+        const anita::Propagator propagator(continent, anita::readers::REFERENCE_FLUX, 18., 14., 20.);
+        const int N = 100;
+        anita::Acceptance acceptance(propagator, continent, 1, 10., 1);
+        acceptance.begin(2);
+        for (int i = 0; i < N; i++) {
+            anita::InteractionList interactions;
+            if (i % 2 == 0) {
+                for (const double depth : { 0.5, 1., 1.5 })
+                    interactions.push_back(interactionAt(continent, theta, phi, depth, 18., anita::Current::Neutral));
+            }
+            acceptance.consume(static_cast<unsigned int>(i % 2), i, interactions);
+        }
+        acceptance.finish();
+
+        // so the relative error is sqrt(50*3^2)/150, not sqrt(150)/150 as if the interactions were independent
+        const double each = propagator.getGenerationAcceptance()/N;
+        CHECK(acceptance.getAcceptance(0) == doctest::Approx(150*each));
+        CHECK(acceptance.getError(0) == doctest::Approx(sqrt(450.)*each));
+        CHECK(acceptance.getError(0, anita::Flavor::Tau, anita::Current::Neutral, 0) == doctest::Approx(sqrt(450.)*each));
+        CHECK(!acceptance.isConverged(0.1));
+        CHECK(acceptance.isConverged(0.15));
+    }
+
+    SUBCASE("ADAPTIVE STOPPING") {
+
+        const anita::Propagator propagator(continent, anita::readers::REFERENCE_FLUX, 0, 14., 20.);
+
+        // a precision that can never be reached runs every event
+        anita::StoppingCriteria criteria;
+        criteria.precision = 0;
+        criteria.max_events = 250;
+        criteria.batch_size = 100;
+        anita::Acceptance all(propagator, continent, 2, 10., 2);
+        CHECK(propagator.propagateUntilConverged(all, criteria, 2) == 250);
+        CHECK(all.getNumEvents() == 250);
+
+        // and runs out of time after the first batch
+        criteria.max_time = 1e-9;
+        anita::Acceptance timed(propagator, continent, 2, 10., 2);
+        CHECK(propagator.propagateUntilConverged(timed, criteria, 2) == 100);
+
+        // and a bin with any interactions has a relative error of at most one
+        criteria.precision = 1.;
+        criteria.max_time = 0;
+        anita::Acceptance converged(propagator, continent, 1, 1000., 1);
+        const int nevents = propagator.propagateUntilConverged(converged, criteria, 2);
+        CHECK(nevents <= 250);
+        CHECK(converged.getNumEvents() == nevents);
+        CHECK(converged.isConverged(1.) == (converged.getAcceptance(0) > 0));
+
+        criteria.batch_size = 0;
+        CHECK_THROWS(propagator.propagateUntilConverged(converged, criteria));
+    }
+
+    SUBCASE("INVALID") {
+        const anita::Propagator propagator(continent, anita::readers::REFERENCE_FLUX, 0, 14., 20.);
+        CHECK_THROWS(anita::Acceptance(propagator, continent, 0, 10., 2));
+        CHECK_THROWS(anita::Acceptance(propagator, continent, 10, 0., 2));
+        anita::Acceptance acceptance(propagator, continent, 10, 10., 2);
+        CHECK_THROWS(acceptance.getAcceptance(10, anita::Flavor::Tau, anita::Current::Charged, 0));
+    }
+}
+
+TEST_SUITE_END();
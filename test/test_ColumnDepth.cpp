@@ -0,0 +1,118 @@
+#include <cmath>
+#include <limits>
+#include <doctest.h>
+#include <Random.hpp>
+#include <Constants.hpp>
+#include <ColumnDepth.hpp>
+#include <readers/Earth.hpp>
+
+TEST_SUITE_BEGIN("columndepth");
+
+using anita::PI;
+using anita::Vector3;
+
+// the column depth (g/cm^2) between a and b along a chord by the midpoint rule
+static double integrate(const anita::readers::Earth& earth, const Vector3<double>& origin,
+                        const Vector3<double>& direction, const double a, const double b) {
+
+    const int N = 200000;
+    double depth = 0;
+    for (int i = 0; i < N; i++) {
+        const double s = a + (i + 0.5)*(b - a)/N;
+        const double r = (origin + direction*s).mag();
+        depth += r < earth.max_radius ? earth.getDensity(r) : 0.;
+    }
+
+    return 1e5*depth*(b - a)/N;
+}
+
+TEST_CASE("PREM CHORDS") {
+
+    const anita::readers::Earth earth;
+
+    SUBCASE("THROUGH THE CENTER") {
+        // straight through the Earth from pole to pole
+        const anita::ColumnDepth column(earth, Vector3<double>(0, 0, earth.max_radius), Vector3<double>(0, 0, -1),
+                                        2*earth.max_radius);
+        const double half = integrate(earth, Vector3<double>(0, 0, 0), Vector3<double>(0, 0, 1), 0, earth.max_radius);
+        CHECK(column.getTotal() == doctest::Approx(2*half).epsilon(1e-6));
+        CHECK(column.getColumnDepth(earth.max_radius) == doctest::Approx(half).epsilon(1e-6));
+
+        // the density is PREM itself
+        CHECK(column.getDensity(earth.max_radius) == doctest::Approx(earth.getDensity(0)));
+        CHECK(column.getDensity(1000) == doctest::Approx(earth.getDensity(earth.max_radius - 1000)));
+    }
+
+    SUBCASE("RANDOM CHORDS") {
+        beginEvent(0);
+
+        for (int i = 0; i < 20; i++) {
+
+            // a random point up to 100 km above the surface
+            const double r = earth.max_radius + 100*uniform();
+            const double theta = acos(2*uniform() - 1);
+            const double phi = 2*PI*uniform();
+            const Vector3<double> origin(r*sin(theta)*cos(phi), r*sin(theta)*sin(phi), r*cos(theta));
+
+            // and a random direction
+            const double dtheta = acos(2*uniform() - 1);
+            const double dphi = 2*PI*uniform();
+            const Vector3<double> direction(sin(dtheta)*cos(dphi), sin(dtheta)*sin(dphi), cos(dtheta));
+
+            const double length = 13000*uniform() + 1;
+            const anita::ColumnDepth column(earth, origin, direction, length);
+
+            // the cumulative column depth matches the direct integral, up to the error
+            // of the midpoint rule at the discontinuities of PREM
+            for (const double fraction : { 0.1, 0.5, 1. }) {
+                const double expected = integrate(earth, origin, direction, 0, fraction*length);
+                CHECK(column.getColumnDepth(fraction*length) == doctest::Approx(expected).epsilon(1e-4));
+            }
+
+            // and getDistance is its inverse
+            for (int j = 0; j < 10; j++) {
+                const double depth = uniform()*column.getTotal();
+                const double s = column.getDistance(depth);
+                CHECK(s >= 0);
+                CHECK(s <= length);
+                CHECK(column.getColumnDepth(s) == doctest::Approx(depth).epsilon(1e-9));
+            }
+            CHECK(column.getDistance(1.01*column.getTotal() + 1) == std::numeric_limits<double>::infinity());
+        }
+    }
+
+    SUBCASE("MISSING THE EARTH") {
+        // a chord that passes 10 km above the surface never sees any matter
+        const double r = earth.max_radius + 10;
+        const anita::ColumnDepth column(earth, Vector3<double>(-5000, 0, r), Vector3<double>(1, 0, 0), 10000);
+        CHECK(column.getTotal() == 0);
+        CHECK(column.getDistance(1) == std::numeric_limits<double>::infinity());
+    }
+
+    SUBCASE("SET DENSITY") {
+        // a chord of 100 km with a layer of ice in the middle
+        anita::ColumnDepth column(earth, Vector3<double>(0, 0, 6000), Vector3<double>(0, 1, 0), 100);
+        const double before = column.getTotal();
+        const double replaced = column.getColumnDepth(60) - column.getColumnDepth(20);
+        column.setDensity(20, 60, 0.917);
+        CHECK(column.getTotal() == doctest::Approx(before - replaced + 0.917*40*1e5).epsilon(1e-12));
+        CHECK(column.getDensity(40) == 0.917);
+        CHECK(column.getDistance(column.getColumnDepth(20) + 0.917*1e5) == doctest::Approx(21).epsilon(1e-12));
+
+        // ranges outside of the chord are ignored
+        column.setDensity(-10, 0, 5);
+        column.setDensity(100, 110, 5);
+        CHECK(column.getTotal() == doctest::Approx(before - replaced + 0.917*40*1e5).epsilon(1e-12));
+
+        // and a vacuum over the whole chord leaves a single piece
+        column.setDensity(0, 100, 0);
+        CHECK(column.getNumPieces() == 1);
+        CHECK(column.getTotal() == 0);
+    }
+
+    SUBCASE("INVALID CHORDS") {
+        CHECK_THROWS(anita::ColumnDepth(earth, Vector3<double>(0, 0, 6000), Vector3<double>(0, 1, 0), 0));
+    }
+}
+
+TEST_SUITE_END();
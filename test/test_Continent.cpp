@@ -78,10 +78,80 @@ TEST_CASE("BASIC METHODS") {
         CHECK(min_phi >= 0);
         CHECK(max_phi < 2*anita::PI);
 
-        // check that the mean is approximately pi
-        const double mean_phi = std::accumulate(phis.begin(), phis.end(), 0.)/static_cast<double>(N);
-        CHECK(mean_phi == doctest::Approx(anita::PI).epsilon(0.05));
+        // points are only drawn on the ice, which covers about 14 million km^2
+        // of the 34 million km^2 below -60 degrees
+        CHECK(continent.getSurfaceAcceptance() > 0.3);
+        CHECK(continent.getSurfaceAcceptance() < 0.5);
+
+        // and the surface at every point should be the ice rather than the ellipsoid. Points
+        // within half a cell of the coast can see the (conservative) mask as ocean
+        unsigned int ocean = 0;
+        for (unsigned int i = 0; i < N; i++) {
+            if (continent.getSurfaceElevation(thetas[i], phis[i]) == continent.getEarthRadius(thetas[i])) ocean++;
+        }
+        CHECK(ocean < N/100);
+
+    }
+
+    // rays from above the ice must find the surface before the bed
+    SUBCASE("RAY INTERSECTION") {
+
+        beginEvent(2);
+
+        for (int i = 0; i < 100; i++) {
+
+            // a random point on the ice, 20 km up
+            const anita::SphericalCoordinate point = continent.getRandomSurfacePoint();
+            const double r = anita::EARTH_B + 20.;
+            const anita::Vector3<double> origin(r*sin(point.theta)*cos(point.phi),
+                                                r*sin(point.theta)*sin(point.phi),
+                                                r*cos(point.theta));
+
+            // pointing straight down
+            const anita::Vector3<double> down = origin*(-1./r);
+
+            double surface = 0;
+            double bed = 0;
+            REQUIRE(continent.getSurfaceIntersection(origin, down, 100, surface));
+            REQUIRE(continent.getBedIntersection(origin, down, 100, bed));
+            CHECK(surface <= bed);
+            CHECK(surface > 10);
+        }
+    }
+
+    // the column depth of a chord straight down through the ice
+    SUBCASE("COLUMN DEPTH") {
+
+        beginEvent(3);
+
+        for (int i = 0; i < 20; i++) {
 
+            // a random point on the ice, 20 km up, looking straight down
+            const anita::SphericalCoordinate point = continent.getRandomSurfacePoint();
+            const double r = anita::EARTH_B + 20.;
+            const anita::Vector3<double> origin(r*sin(point.theta)*cos(point.phi),
+                                                r*sin(point.theta)*sin(point.phi),
+                                                r*cos(point.theta));
+            const anita::Vector3<double> down = origin*(-1./r);
+            const anita::ColumnDepth column = continent.getColumnDepth(origin, down, 100);
+
+            double surface = 0;
+            double bed = 0;
+            REQUIRE(continent.getSurfaceIntersection(origin, down, 100, surface));
+            REQUIRE(continent.getBedIntersection(origin, down, 100, bed));
+
+            // there is nothing above the surface
+            CHECK(column.getColumnDepth(surface) == 0);
+
+            // and ice (or ocean) down to the bed
+            const double depth = column.getColumnDepth(bed);
+            CHECK(depth >= 0.917e5*(bed - surface)*(1 - 1e-9));
+            CHECK(depth <= 1.02e5*(bed - surface)*(1 + 1e-9));
+
+            // and rock below that
+            CHECK(column.getDensity(bed + 1) > 2);
+            CHECK(column.getDistance(depth + 1e3) > bed);
+        }
     }
 
 }
@@ -0,0 +1,81 @@
+#include <vector>
+#include <doctest.h>
+#include <Random.hpp>
+#include <Constants.hpp>
+#include <CrossSectionTable.hpp>
+
+TEST_SUITE_BEGIN("crosssectiontable");
+
+using anita::Current;
+using anita::Material;
+using anita::CrossSectionModel;
+using anita::CrossSectionTable;
+
+TEST_CASE("CROSS SECTION TABLES") {
+
+    const std::vector<CrossSectionModel> models = { CrossSectionModel::ConnollyLower, CrossSectionModel::ConnollyMiddle,
+                                                    CrossSectionModel::ConnollyUpper, CrossSectionModel::ALLM,
+                                                    CrossSectionModel::ASW, CrossSectionModel::Sarkar,
+                                                    CrossSectionModel::CKMT };
+
+    SUBCASE("MATCHES THE PARAMETRIZATIONS") {
+        beginEvent(0);
+
+        for (const CrossSectionModel model : models) {
+            const CrossSectionTable& table = CrossSectionTable::getTable(model);
+            CHECK(table.getModel() == model);
+            CHECK(table.getMaxError() <= CrossSectionTable::TOLERANCE);
+
+            // at random energies, including outside of the table
+            for (int i = 0; i < 1000; i++) {
+                const double E = uniform(4., 26.);
+                const double cc = anita::getChargedCurrentCrossSection(E, model);
+                const double nc = anita::getNeutralCurrentCrossSection(E, model);
+                CHECK(table.getCrossSection(Current::Charged, E) == doctest::Approx(cc).epsilon(1e-4));
+                CHECK(table.getCrossSection(Current::Neutral, E) == doctest::Approx(nc).epsilon(1e-4));
+                CHECK(table.getInteractionDepth(E) == doctest::Approx(1./(anita::N_A*(cc + nc))).epsilon(1e-4));
+            }
+        }
+    }
+
+    SUBCASE("BATCHES") {
+        beginEvent(1);
+
+        const CrossSectionTable& table = CrossSectionTable::getTable(CrossSectionModel::ConnollyMiddle);
+
+        std::vector<double> energies(100);
+        for (double& E : energies) E = uniform(5., 25.);
+
+        // every batch matches the single lookups
+        std::vector<double> results(energies.size());
+        for (const Current current : { Current::Charged, Current::Neutral }) {
+            table.getCrossSections(current, energies.data(), results.data(), energies.size());
+            for (std::size_t i = 0; i < energies.size(); i++)
+                CHECK(results[i] == table.getCrossSection(current, energies[i]));
+        }
+
+        table.getInteractionLengths(Material::Ice, energies.data(), results.data(), energies.size());
+        for (std::size_t i = 0; i < energies.size(); i++)
+            CHECK(results[i] == doctest::Approx(table.getInteractionLength(energies[i], Material::Ice)));
+    }
+
+    SUBCASE("MATERIALS") {
+        const CrossSectionTable& table = CrossSectionTable::getTable(CrossSectionModel::ConnollyMiddle);
+
+        // the interaction length scales with the inverse of the density
+        const double depth = table.getInteractionDepth(18.);
+        CHECK(table.getInteractionLength(18., Material::Ice) == doctest::Approx(depth/(1e5*0.917)));
+        CHECK(table.getInteractionLength(18., Material::Rock) < table.getInteractionLength(18., Material::Ocean));
+        CHECK(table.getInteractionLength(18., Material::Air) > 500*table.getInteractionLength(18., Material::Ice));
+    }
+
+    SUBCASE("INVALID TABLES") {
+        CHECK_THROWS(CrossSectionTable(CrossSectionModel::ConnollyMiddle, 6., 24., 1));
+        CHECK_THROWS(CrossSectionTable(CrossSectionModel::ConnollyMiddle, 24., 6.));
+
+        // a table that is too coarse to meet the tolerance is rejected
+        CHECK_THROWS(CrossSectionTable(CrossSectionModel::ConnollyMiddle, 6., 24., 4));
+    }
+}
+
+TEST_SUITE_END();
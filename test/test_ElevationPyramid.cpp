@@ -0,0 +1,206 @@
+#include <cmath>
+#include <cstdint>
+#include <doctest.h>
+#include <Random.hpp>
+#include <Constants.hpp>
+#include <ElevationPyramid.hpp>
+#include <readers/Stereographic.hpp>
+
+TEST_SUITE_BEGIN("elevationpyramid");
+
+using anita::PI;
+using anita::Horizon;
+using anita::Vector3;
+
+// the pyramid takes a few seconds to build, so every test shares one
+static const anita::ElevationPyramid& getPyramid() {
+    static const anita::readers::Bedmap bedmap;
+    static const anita::ElevationPyramid pyramid(bedmap);
+    return pyramid;
+}
+
+// the height (km) of a point above a horizon, evaluated directly
+static double getClearance(const Horizon horizon, const double px, const double py, const double pz) {
+
+    const double r = sqrt(px*px + py*py + pz*pz);
+    const double theta = acos(pz/r);
+    const double phi = atan2(py, px);
+    const double ellipsoid = (anita::EARTH_A*anita::EARTH_B)/sqrt(pow(anita::EARTH_B*sin(theta), 2) +
+                                                                  pow(anita::EARTH_A*cos(theta), 2));
+
+    double x, y;
+    std::uint8_t inrange;
+    if (!anita::readers::projectStereographic(1, &theta, &phi, &x, &y, &inrange, 3333.5))
+        return r - ellipsoid;
+
+    return r - ellipsoid - getPyramid().getElevationAtPoint(horizon, x, y)/1000.;
+}
+
+// Checks that every node bounds the elevations beneath it
+TEST_CASE("PYRAMID BOUNDS") {
+
+    const anita::ElevationPyramid& pyramid = getPyramid();
+    const int top = pyramid.getNumLevels() - 1;
+    CHECK(pyramid.getLevelSize(top) == 1);
+
+    beginEvent(0);
+
+    for (const Horizon horizon : { Horizon::Surface, Horizon::Bed }) {
+        for (int i = 0; i < 100000; i++) {
+
+            // a random point on the grid, and the cell that it is in
+            const double x = 6666*uniform() - 3333;
+            const double y = 6666*uniform() - 3333;
+            const int col = static_cast<int>(floor(x + 3333));
+            const int row = static_cast<int>(floor(3333 - y));
+            const double elevation = pyramid.getElevationAtPoint(horizon, x, y);
+
+            // every level must contain this elevation
+            for (int level = 0; level <= top; level++) {
+                const std::pair<double, double> bounds = pyramid.getBounds(horizon, level, col >> (level + 1),
+                                                                           row >> (level + 1));
+                CHECK(elevation >= bounds.first);
+                CHECK(elevation <= bounds.second);
+            }
+        }
+    }
+
+    // and the grid is surrounded by the ellipsoid
+    CHECK(std::isnan(pyramid.getElevationAtPoint(Horizon::Surface, 3400, 0)));
+}
+
+// Checks that rays find the same crossings as marching along the ray in tiny steps
+TEST_CASE("RAY INTERSECTION") {
+
+    const anita::ElevationPyramid& pyramid = getPyramid();
+
+    SUBCASE("VERTICAL RAYS") {
+        // straight down onto the pole from 100 km up
+        const double start = anita::EARTH_B + 100.;
+        double s = 0;
+        REQUIRE(pyramid.intersect(Horizon::Surface, Vector3<double>(0, 0, -start), Vector3<double>(0, 0, 1),
+                                  0, 200, s));
+        CHECK(s == doctest::Approx(100. - pyramid.getElevationAtPoint(Horizon::Surface, 0, 0)/1000.).epsilon(1e-9));
+
+        // and straight back up again misses everything
+        CHECK(!pyramid.intersect(Horizon::Surface, Vector3<double>(0, 0, -start), Vector3<double>(0, 0, -1),
+                                 0, 10000, s));
+
+        // as does a ray that stops short of the surface
+        CHECK(!pyramid.intersect(Horizon::Bed, Vector3<double>(0, 0, -start), Vector3<double>(0, 0, 1),
+                                 0, 50, s));
+    }
+
+    SUBCASE("RANDOM RAYS") {
+        beginEvent(1);
+
+        int crossings = 0;
+        for (int i = 0; i < 20; i++) {
+
+            const Horizon horizon = i % 2 ? Horizon::Bed : Horizon::Surface;
+
+            // a point a few km above or below the ellipsoid within 2000 km of the pole
+            const double theta = PI - anita::degToRad(18*uniform());
+            const double phi = 2*PI*uniform();
+            const double r = anita::EARTH_B + 8*uniform() - 3;
+            const double ox = r*sin(theta)*cos(phi);
+            const double oy = r*sin(theta)*sin(phi);
+            const double oz = r*cos(theta);
+
+            // and a direction within ~6 degrees of the horizontal
+            const double up = 0.2*uniform() - 0.1;
+            const double az = 2*PI*uniform();
+            const double east[3] = { -sin(phi), cos(phi), 0 };
+            const double north[3] = { -cos(theta)*cos(phi), -cos(theta)*sin(phi), sin(theta) };
+            const double dx = up*ox/r + sqrt(1 - up*up)*(cos(az)*east[0] + sin(az)*north[0]);
+            const double dy = up*oy/r + sqrt(1 - up*up)*(cos(az)*east[1] + sin(az)*north[1]);
+            const double dz = up*oz/r + sqrt(1 - up*up)*(cos(az)*east[2] + sin(az)*north[2]);
+
+            // march along the ray to find the first crossing
+            const double length = 300;
+            const double step = 0.05;
+            double expected = -1;
+            double previous = getClearance(horizon, ox, oy, oz);
+            for (double s = step; s <= length; s += step) {
+                const double clearance = getClearance(horizon, ox + s*dx, oy + s*dy, oz + s*dz);
+                if (previous*clearance < 0) {
+                    expected = s;
+                    break;
+                }
+                previous = clearance;
+            }
+
+            // which must be within the final step of the crossing found through the pyramid
+            double s = 0;
+            const bool hit = pyramid.intersect(horizon, Vector3<double>(ox, oy, oz), Vector3<double>(dx, dy, dz),
+                                               0, length, s);
+            CHECK(hit == (expected > 0));
+            if (hit && (expected > 0)) {
+                CHECK(s <= expected);
+                CHECK(s >= expected - step);
+                CHECK(fabs(getClearance(horizon, ox + s*dx, oy + s*dy, oz + s*dz)) < 1e-6);
+                crossings++;
+            }
+        }
+
+        // make sure that we actually tested some crossings
+        CHECK(crossings > 5);
+    }
+
+    SUBCASE("EVERY CROSSING ONCE") {
+        beginEvent(2);
+
+        for (int i = 0; i < 200; i++) {
+
+            const Horizon horizon = i % 2 ? Horizon::Bed : Horizon::Surface;
+
+            // a point 20 km above the ellipsoid within 2000 km of the pole
+            const double theta = PI - anita::degToRad(18*uniform());
+            const double phi = 2*PI*uniform();
+            const double r = anita::EARTH_B + 20;
+            const double ox = r*sin(theta)*cos(phi);
+            const double oy = r*sin(theta)*sin(phi);
+            const double oz = r*cos(theta);
+
+            // and a direction within ~25 degrees of straight down, so the ray crosses each horizon once
+            const double down = 0.9 + 0.1*uniform();
+            const double az = 2*PI*uniform();
+            const double east[3] = { -sin(phi), cos(phi), 0 };
+            const double north[3] = { -cos(theta)*cos(phi), -cos(theta)*sin(phi), sin(theta) };
+            const double dx = -down*ox/r + sqrt(1 - down*down)*(cos(az)*east[0] + sin(az)*north[0]);
+            const double dy = -down*oy/r + sqrt(1 - down*down)*(cos(az)*east[1] + sin(az)*north[1]);
+            const double dz = -down*oz/r + sqrt(1 - down*down)*(cos(az)*east[2] + sin(az)*north[2]);
+
+            // every search starts from the previous crossing, like Continent::getColumnDepth
+            int crossings = 0;
+            double s = 0;
+            while ((crossings < 10) && pyramid.intersect(horizon, Vector3<double>(ox, oy, oz), Vector3<double>(dx, dy, dz),
+                                                         s, 50, s))
+                crossings++;
+            CHECK(crossings == 1);
+        }
+
+        // including the ellipsoid away from the grid
+        for (int i = 0; i < 200; i++) {
+            const double theta = PI/2 + 0.5*uniform();
+            const double phi = 2*PI*uniform();
+            const double r = anita::EARTH_A + 20;
+            const double ox = r*sin(theta)*cos(phi);
+            const double oy = r*sin(theta)*sin(phi);
+            const double oz = r*cos(theta);
+            const double down = 0.9 + 0.1*uniform();
+            const double dx = -down*ox/r + sqrt(1 - down*down)*(-sin(phi));
+            const double dy = -down*oy/r + sqrt(1 - down*down)*cos(phi);
+            const double dz = -down*oz/r;
+
+            int crossings = 0;
+            double s = 0;
+            while ((crossings < 10) && pyramid.intersect(Horizon::Surface, Vector3<double>(ox, oy, oz), Vector3<double>(dx, dy, dz),
+                                                         s, 50, s))
+                crossings++;
+            CHECK(crossings == 1);
+        }
+    }
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,110 @@
+#include <doctest.h>
+#include <Random.hpp>
+#include <InteractionSink.hpp>
+#include <InteractionBuffer.hpp>
+
+TEST_SUITE_BEGIN("interactionbuffer");
+
+// a random interaction of a random particle
+static anita::Interaction randomInteraction() {
+
+    const anita::ParticleState particle{static_cast<anita::Flavor>(uniformInt(0, 2)), uniform() < 0.5, 15 + 5*uniform()};
+    anita::Interaction interaction(uniformInt(1, 100), particle,
+                                   anita::SphericalCoordinate(uniform(), uniform(), 6357 + uniform()),
+                                   anita::SphericalCoordinate(uniform(), uniform(), 1),
+                                   uniform() < 0.5 ? anita::Current::Charged : anita::Current::Neutral,
+                                   1000*uniform());
+    interaction.weight = uniform();
+
+    return interaction;
+}
+
+TEST_CASE("INTERACTION BUFFER") {
+
+    beginEvent(0);
+
+    SUBCASE("ROUND TRIP") {
+
+        // events with zero, one or a few interactions
+        std::vector<anita::InteractionList> events;
+        anita::InteractionBuffer buffer;
+        buffer.reserve(100, 100);
+        for (int i = 0; i < 100; i++) {
+            anita::InteractionList interactions;
+            const int n = uniformInt(0, 3);
+            for (int j = 0; j < n; j++)
+                interactions.push_back(randomInteraction());
+            buffer.append(2*i, interactions);
+            events.push_back(interactions);
+        }
+
+        // every event comes back out exactly as it went in
+        CHECK(buffer.getNumEvents() == events.size());
+        std::size_t total = 0;
+        for (std::size_t i = 0; i < events.size(); i++) {
+            const anita::InteractionList interactions = buffer.getEvent(i);
+            CHECK(buffer.getNumInteractions(i) == events[i].size());
+            REQUIRE(interactions.size() == events[i].size());
+            for (std::size_t j = 0; j < interactions.size(); j++) {
+                const anita::Interaction& a = interactions[j];
+                const anita::Interaction& b = events[i][j];
+                CHECK(a.event == static_cast<int>(2*i));
+                CHECK(a.trials == b.trials);
+                CHECK(a.particle.flavor == b.particle.flavor);
+                CHECK(a.particle.neutrino == b.particle.neutrino);
+                CHECK(a.particle.energy == b.particle.energy);
+                CHECK(a.location.theta == b.location.theta);
+                CHECK(a.location.phi == b.location.phi);
+                CHECK(a.location.r == b.location.r);
+                CHECK(a.direction.theta == b.direction.theta);
+                CHECK(a.direction.phi == b.direction.phi);
+                CHECK(a.direction.r == b.direction.r);
+                CHECK(a.current == b.current);
+                CHECK(a.distance == b.distance);
+                CHECK(a.weight == b.weight);
+            }
+            total += events[i].size();
+        }
+
+        // and the columns are laid out by event
+        const anita::InteractionBuffer::Columns& columns = buffer.getColumns();
+        CHECK(buffer.getNumInteractions() == total);
+        CHECK(columns.offsets.size() == events.size() + 1);
+        CHECK(columns.offsets.front() == 0);
+        CHECK(columns.offsets.back() == total);
+        CHECK(columns.weight.size() == total);
+        CHECK(columns.current.size() == total);
+
+        // until the buffer is cleared
+        buffer.clear();
+        CHECK(buffer.getNumEvents() == 0);
+        CHECK(buffer.getNumInteractions() == 0);
+        CHECK(buffer.getColumns().offsets.size() == 1);
+    }
+
+    SUBCASE("BUFFER SINK") {
+
+        anita::BufferSink sink;
+        sink.begin(1);
+        anita::InteractionList interactions = { randomInteraction(), randomInteraction() };
+        anita::InteractionList empty;
+        sink.consume(0, 7, empty);
+        sink.consume(0, 3, interactions);
+        sink.finish();
+
+        const anita::InteractionBuffer buffer = sink.release();
+        CHECK(buffer.getNumEvents() == 2);
+        CHECK(buffer.getNumInteractions() == 2);
+        CHECK(buffer.getColumns().events[0] == 7);
+        CHECK(buffer.getInteraction(0).event == 3);
+        CHECK(buffer.getInteraction(1).distance == interactions[1].distance);
+    }
+
+    SUBCASE("OUT OF RANGE") {
+        anita::InteractionBuffer buffer;
+        CHECK_THROWS(buffer.getEvent(0));
+        CHECK_THROWS(buffer.getInteraction(0));
+    }
+}
+
+TEST_SUITE_END();
@@ -1,4 +1,6 @@
+#include <cmath>
 #include <doctest.h>
+#include <Random.hpp>
 #include <Particle.hpp>
 #include <Neutrino.hpp>
 
@@ -7,15 +9,25 @@ TEST_SUITE_BEGIN("neutrino");
 TEST_CASE("Creating a base neutrino") {
 
     SUBCASE("Electron Neutrino") {
-        anita::Neutrino neutrino = anita::Neutrino(18., anita::Flavor::Electron);
+        // Neutrino is abstract, so we go through the concrete flavor
+        const anita::ElectronNeutrino concrete(18.);
+        const anita::Neutrino& neutrino = concrete;
+        CHECK(neutrino.flavor == anita::Flavor::Electron);
+        CHECK(neutrino.isNeutrino());
     }
 
     SUBCASE("Muon Neutrino") {
-        anita::Neutrino neutrino = anita::Neutrino(18., anita::Flavor::Muon);
+        const anita::MuonNeutrino concrete(18.);
+        const anita::Neutrino& neutrino = concrete;
+        CHECK(neutrino.flavor == anita::Flavor::Muon);
+        CHECK(neutrino.isNeutrino());
     }
 
     SUBCASE("Tau Neutrino") {
-        anita::Neutrino neutrino = anita::Neutrino(18., anita::Flavor::Tau);
+        const anita::TauNeutrino concrete(18.);
+        const anita::Neutrino& neutrino = concrete;
+        CHECK(neutrino.flavor == anita::Flavor::Tau);
+        CHECK(neutrino.isNeutrino());
     }
 }
 
@@ -31,4 +43,51 @@ TEST_CASE("Creating an tau neutrino") {
     anita::TauNeutrino neutrino = anita::TauNeutrino(18.);
 }
 
+TEST_CASE("CROSS SECTIONS") {
+
+    anita::MuonNeutrino neutrino = anita::MuonNeutrino(18.);
+
+    SUBCASE("CHARGED AND NEUTRAL") {
+        // at 1 EeV, the CC cross section is ~1e-32 cm^2 and about twice the NC one
+        const double charged = neutrino.getCrossSection(anita::Current::Charged);
+        const double neutral = neutrino.getCrossSection(anita::Current::Neutral);
+        CHECK(charged > 5e-33);
+        CHECK(charged < 5e-32);
+        CHECK(neutral < charged);
+        CHECK(neutral > 0.2*charged);
+
+        // and they grow with energy
+        neutrino.setEnergy(20.);
+        CHECK(neutrino.getCrossSection(anita::Current::Charged) > charged);
+        CHECK(neutrino.getCrossSection(anita::Current::Neutral) > neutral);
+    }
+
+    SUBCASE("INTERACTION LENGTH") {
+        // the interaction depth is ~1e8 g/cm^2 at 1 EeV
+        const double depth = neutrino.getInteractionDepth();
+        CHECK(depth > 1e7);
+        CHECK(depth < 1e9);
+
+        // and the interaction length in km follows from the density
+        const auto length = neutrino.getInteractionLength(2.);
+        CHECK(length.first == doctest::Approx(depth/2e5));
+        CHECK(length.second == anita::InteractionType::Current);
+    }
+
+    SUBCASE("RANDOM CURRENT") {
+        beginEvent(0);
+
+        // the fraction of CC interactions is the fraction of the cross section
+        const int N = 100000;
+        int charged = 0;
+        for (int i = 0; i < N; i++) {
+            if (neutrino.getRandomCurrent() == anita::Current::Charged) charged++;
+        }
+
+        const double cc = neutrino.getCrossSection(anita::Current::Charged);
+        const double nc = neutrino.getCrossSection(anita::Current::Neutral);
+        CHECK(static_cast<double>(charged)/N == doctest::Approx(cc/(cc + nc)).epsilon(0.01));
+    }
+}
+
 TEST_SUITE_END();
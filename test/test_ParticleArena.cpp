@@ -0,0 +1,92 @@
+#include <thread>
+#include <vector>
+#include <doctest.h>
+#include <Random.hpp>
+#include <Lepton.hpp>
+#include <Neutrino.hpp>
+#include <ParticleArena.hpp>
+
+TEST_SUITE_BEGIN("particlearena");
+
+using anita::Particle;
+using anita::ParticlePtr;
+using anita::ParticleArena;
+
+TEST_CASE("PARTICLE ARENA") {
+
+    ParticleArena& arena = ParticleArena::local();
+
+    SUBCASE("EVENTS REUSE THE ARENA") {
+        beginEvent(0);
+
+        // a neutrino per event, as in the propagator
+        for (int i = 0; i < 1000; i++) {
+            auto neutrino = anita::Neutrino::generateRandomNeutrino(18.);
+            CHECK(arena.getNumLive() == 1);
+            CHECK(neutrino->getEnergy() == 18.);
+        }
+        CHECK(arena.getNumLive() == 0);
+        CHECK(arena.getNumBlocks() == 1);
+    }
+
+    SUBCASE("LONG CHAINS") {
+
+        // a long chain of interaction products that are all alive at once
+        const std::size_t before = arena.getNumBlocks();
+        for (int event = 0; event < 10; event++) {
+            std::vector<ParticlePtr<Particle>> chain;
+            chain.push_back(anita::makeParticle<anita::TauNeutrino>(19.));
+            for (int i = 0; i < 1000; i++) {
+                const anita::Neutrino& neutrino = dynamic_cast<const anita::Neutrino&>(*chain.back());
+                ParticlePtr<Particle> tau = neutrino.getInteractionProducts(anita::Current::Charged);
+                CHECK(tau->isLepton());
+                chain.push_back(dynamic_cast<const anita::Lepton&>(*tau).getInteractionProducts(anita::InteractionType::Decay));
+                chain.push_back(std::move(tau));
+                std::swap(chain[chain.size() - 1], chain[chain.size() - 2]);
+            }
+            CHECK(arena.getNumLive() == 2001);
+        }
+
+        // the arena grows for the first chain and is then reused for every other one
+        CHECK(arena.getNumLive() == 0);
+        CHECK(arena.getNumBlocks() > before);
+        const std::size_t blocks = arena.getNumBlocks();
+        {
+            auto neutrino = anita::makeParticle<anita::MuonNeutrino>(18.);
+        }
+        CHECK(arena.getNumBlocks() == blocks);
+    }
+
+    SUBCASE("FAILED CONSTRUCTION") {
+        // the energy is in the wrong units, so the constructor throws
+        CHECK_THROWS(anita::makeParticle<anita::MuonNeutrino>(30.));
+        CHECK(arena.getNumLive() == 0);
+    }
+
+    SUBCASE("HEAP PARTICLES") {
+        // particles without an arena are deleted
+        ParticlePtr<Particle> particle(new anita::ElectronNeutrino(18.));
+        CHECK(particle->isNeutrino());
+        particle.reset();
+        CHECK(arena.getNumLive() == 0);
+    }
+
+    SUBCASE("ONE ARENA PER THREAD") {
+        auto neutrino = anita::makeParticle<anita::MuonNeutrino>(18.);
+
+        ParticleArena* other = nullptr;
+        std::size_t live = 1;
+        std::thread thread([&other, &live]() {
+            auto tau = anita::makeParticle<anita::Tau>(18.);
+            other = &ParticleArena::local();
+            live = other->getNumLive();
+        });
+        thread.join();
+
+        CHECK(other != &arena);
+        CHECK(live == 1);
+        CHECK(arena.getNumLive() == 1);
+    }
+}
+
+TEST_SUITE_END();
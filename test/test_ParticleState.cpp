@@ -0,0 +1,60 @@
+#include <doctest.h>
+#include <Random.hpp>
+#include <Lepton.hpp>
+#include <Neutrino.hpp>
+#include <ParticleState.hpp>
+
+TEST_SUITE_BEGIN("particlestate");
+
+using anita::Flavor;
+using anita::Current;
+using anita::ParticleState;
+
+TEST_CASE("PARTICLE STATES") {
+
+    SUBCASE("ROUND TRIP") {
+        // every flavor of neutrino and lepton converts to a state and back
+        for (const Flavor flavor : { Flavor::Electron, Flavor::Muon, Flavor::Tau }) {
+            for (const bool neutrino : { true, false }) {
+                const ParticleState state{flavor, neutrino, 17.5};
+                auto particle = anita::createParticle(state);
+                CHECK(particle->isNeutrino() == neutrino);
+                CHECK(particle->getEnergy() == 17.5);
+
+                const ParticleState copy = anita::getState(*particle);
+                CHECK(copy.flavor == flavor);
+                CHECK(copy.neutrino == neutrino);
+                CHECK(copy.energy == 17.5);
+            }
+        }
+    }
+
+    SUBCASE("MATCHES THE CLASSES") {
+        beginEvent(0);
+
+        for (double energy = 15.; energy < 21.; energy += 0.5) {
+            anita::TauNeutrino neutrino(energy);
+            const ParticleState state = anita::getState(neutrino);
+
+            CHECK(anita::getEnergyLoss(state) == neutrino.getEnergyLoss());
+            CHECK(anita::getInteractionDepth(state) == neutrino.getInteractionDepth());
+            CHECK(anita::getCrossSection(state, Current::Charged) == neutrino.getCrossSection(Current::Charged));
+            CHECK(anita::getCrossSection(state, Current::Neutral) == neutrino.getCrossSection(Current::Neutral));
+            CHECK(anita::getInteractionLength(state, 0.917).first == neutrino.getInteractionLength(0.917).first);
+        }
+
+        // only tau neutrinos lose energy so far
+        CHECK(anita::getEnergyLoss(ParticleState{Flavor::Muon, true, 18.}) == 0);
+        CHECK(anita::getEnergyLoss(ParticleState{Flavor::Tau, false, 18.}) == 0);
+    }
+
+    SUBCASE("LEPTONS") {
+        // charged leptons decay, and have no cross sections
+        const ParticleState tau{Flavor::Tau, false, 18.};
+        CHECK(anita::getInteractionLength(tau, 1.).second == anita::InteractionType::Decay);
+        CHECK_THROWS(anita::getCrossSection(tau, Current::Charged));
+        CHECK_THROWS(anita::getInteractionDepth(tau));
+    }
+}
+
+TEST_SUITE_END();
@@ -1,5 +1,10 @@
+#include <cmath>
+#include <limits>
+#include <Random.hpp>
 #include <Continent.hpp>
 #include <Propagator.hpp>
+#include <ColumnDepth.hpp>
+#include <readers/Earth.hpp>
 
 #include <doctest.h>
 
@@ -35,3 +40,88 @@ TEST_CASE("Propagator propagating particles") {
         propagator.propagateParticles(10);
     }
 }
+
+TEST_CASE("GENERATION WEIGHTS") {
+
+    const anita::Continent continent = anita::Continent();
+
+    // energies from the reference flux are uniform between the energy cuts
+    const anita::Propagator reference(continent, anita::readers::REFERENCE_FLUX, -1., 14., 20.);
+    for (double E = 14.; E <= 20.; E += 0.5)
+        CHECK(reference.getGenerationWeight(E) == doctest::Approx(6.));
+
+    // and energies outside of the cuts are never generated
+    CHECK(reference.getGenerationWeight(13.9) == 0.);
+    CHECK(reference.getGenerationWeight(20.1) == 0.);
+
+    // for any flux, the density of the generated energies (1/W) integrates to one between the cuts
+    const anita::Propagator kotera(continent, std::string("Kotera2010_mix_max"), -1., 15., 20.);
+    const int N = 100000;
+    double total = 0;
+    for (int i = 0; i < N; i++)
+        total += (5./N)/kotera.getGenerationWeight(15. + 5.*(i + 0.5)/N);
+    CHECK(total == doctest::Approx(1.).epsilon(1e-6));
+
+    // and fixed energies cannot be reweighted
+    const anita::Propagator fixed(continent, anita::readers::REFERENCE_FLUX, 18., 14., 20.);
+    CHECK(fixed.getGenerationWeight(18.) == 1.);
+}
+
+TEST_CASE("INTERACTION SAMPLING") {
+
+    // a chord that grazes the core, and a mean depth between interactions
+    // that gives a good number of interactions along it
+    const anita::readers::Earth earth;
+    const double r = earth.max_radius;
+    const double nadir = 0.5;
+    const anita::Vector3<double> direction(sin(nadir), 0, -cos(nadir));
+    const anita::ColumnDepth column(earth, anita::Vector3<double>(0, 0, r), direction, 2*r*cos(nadir));
+    const double depth = 0.5*column.getTotal();
+
+    SUBCASE("STEPPING MATCHES INVERSION") {
+
+        // the fraction of particles that interact in each tenth of the chord
+        const int N = 50000;
+        const int nbins = 10;
+        std::vector<double> stepping(nbins + 1, 0.);
+        std::vector<double> inversion(nbins + 1, 0.);
+
+        beginEvent(0);
+        for (int i = 0; i < N; i++) {
+            for (const anita::PropagationMode mode : { anita::PropagationMode::Stepping, anita::PropagationMode::Inversion }) {
+                const double s = anita::sampleInteractionDistance(column, 0, depth, mode);
+                const std::size_t bin = s < column.getLength() ? static_cast<std::size_t>(nbins*s/column.getLength()) : nbins;
+                (mode == anita::PropagationMode::Stepping ? stepping : inversion)[bin] += 1./N;
+            }
+        }
+
+        // and both agree with the exact probability, within the statistical error
+        for (int j = 0; j <= nbins; j++) {
+            const double start = column.getColumnDepth(j*column.getLength()/nbins);
+            const double end = j < nbins ? column.getColumnDepth((j + 1)*column.getLength()/nbins)
+                                         : std::numeric_limits<double>::infinity();
+            const double expected = exp(-start/depth) - exp(-end/depth);
+            const double sigma = sqrt(expected*(1 - expected)/N);
+            CHECK(fabs(inversion[static_cast<std::size_t>(j)] - expected) < 5*sigma + 1e-3);
+            CHECK(fabs(stepping[static_cast<std::size_t>(j)] - expected) < 5*sigma + 1e-3);
+        }
+    }
+
+    SUBCASE("CONTINUING ALONG THE CHORD") {
+
+        beginEvent(1);
+
+        // interactions are always after the starting point
+        for (int i = 0; i < 1000; i++) {
+            const double start = column.getLength()*uniform();
+            const double s = anita::sampleInteractionDistance(column, start, depth);
+            CHECK(s >= start);
+        }
+
+        // and nothing interacts in a vacuum
+        const anita::ColumnDepth vacuum(earth, anita::Vector3<double>(0, 0, r + 10), anita::Vector3<double>(1, 0, 0), 100);
+        CHECK(anita::sampleInteractionDistance(vacuum, 0, depth) == std::numeric_limits<double>::infinity());
+        CHECK(anita::sampleInteractionDistance(vacuum, 0, depth, anita::PropagationMode::Stepping)
+              == std::numeric_limits<double>::infinity());
+    }
+}
@@ -0,0 +1,116 @@
+#include <vector>
+#include <thread>
+#include <math.h>
+#include <Random.hpp>
+
+#include <doctest.h>
+
+TEST_SUITE_BEGIN("random");
+
+// Known-answer tests from the Random123 distribution (kat_vectors, philox4x32 10)
+TEST_CASE("PHILOX KNOWN ANSWERS") {
+
+    SUBCASE("Zero counter and key") {
+        auto out = anita::Philox::generate({{0, 0, 0, 0}}, {{0, 0}});
+        CHECK(out[0] == 0x6627e8d5);
+        CHECK(out[1] == 0xe169c58d);
+        CHECK(out[2] == 0xbc57ac4c);
+        CHECK(out[3] == 0x9b00dbd8);
+    }
+
+    SUBCASE("Saturated counter and key") {
+        auto out = anita::Philox::generate({{0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}},
+                                           {{0xffffffff, 0xffffffff}});
+        CHECK(out[0] == 0x408f276d);
+        CHECK(out[1] == 0x41c83b0e);
+        CHECK(out[2] == 0xa20bc7c6);
+        CHECK(out[3] == 0x6d5451fd);
+    }
+
+    SUBCASE("Digits of pi") {
+        auto out = anita::Philox::generate({{0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}},
+                                           {{0xa4093822, 0x299f31d0}});
+        CHECK(out[0] == 0xd16cfe09);
+        CHECK(out[1] == 0x94fdcceb);
+        CHECK(out[2] == 0x5001e420);
+        CHECK(out[3] == 0x24126ea1);
+    }
+}
+
+TEST_CASE("REPRODUCIBLE EVENT STREAMS") {
+
+    setSeed(1234);
+
+    // draw a few numbers from an event on this thread
+    auto draw = [](const std::uint64_t event) -> std::vector<double> {
+        beginEvent(event);
+        std::vector<double> values;
+        for (int i = 0; i < 10; i++) {
+            values.push_back(uniform());
+            values.push_back(gaussian());
+            values.push_back(uniformInt(0, 2));
+        }
+        return values;
+    };
+
+    // the same event always gives the same numbers
+    const auto first = draw(42);
+    CHECK(draw(7) != first);
+    CHECK(draw(42) == first);
+
+    // even when drawn on a different thread
+    std::vector<double> threaded;
+    std::thread worker([&threaded, &draw]() { threaded = draw(42); });
+    worker.join();
+    CHECK(threaded == first);
+
+    // but not for a different seed
+    setSeed(4321);
+    CHECK(draw(42) != first);
+}
+
+TEST_CASE("DISTRIBUTIONS") {
+
+    setSeed(0);
+    beginEvent(0);
+
+    const int N = 100000;
+
+    // uniform should be in [min, max) with the right mean
+    double sum = 0;
+    for (int i = 0; i < N; i++) {
+        const double u = uniform(2, 4);
+        CHECK((u >= 2 && u < 4));
+        sum += u;
+    }
+    CHECK(sum/N == doctest::Approx(3).epsilon(0.01));
+
+    // uniformInt is inclusive of both ends
+    std::vector<int> counts(3, 0);
+    for (int i = 0; i < N; i++) {
+        counts[static_cast<unsigned int>(uniformInt(0, 2))]++;
+    }
+    for (auto& count : counts) {
+        CHECK(count/static_cast<double>(N) == doctest::Approx(1./3).epsilon(0.02));
+    }
+
+    // and check the means of the poisson for both algorithms
+    for (double mean : {3., 50.}) {
+        double total = 0;
+        for (int i = 0; i < N; i++) {
+            total += poisson(mean);
+        }
+        CHECK(total/N == doctest::Approx(mean).epsilon(0.02));
+    }
+
+    // and the first two moments of the gaussian
+    double gsum = 0; double gsum2 = 0;
+    for (int i = 0; i < N; i++) {
+        const double g = gaussian(1, 2);
+        gsum += g; gsum2 += g*g;
+    }
+    CHECK(gsum/N == doctest::Approx(1).epsilon(0.05));
+    CHECK(sqrt(gsum2/N - (gsum/N)*(gsum/N)) == doctest::Approx(2).epsilon(0.02));
+}
+
+TEST_SUITE_END();
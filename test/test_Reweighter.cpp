@@ -0,0 +1,73 @@
+#include <cmath>
+#include <string>
+#include <vector>
+#include <doctest.h>
+#include <Random.hpp>
+#include <Reweighter.hpp>
+#include <readers/Flux.hpp>
+
+TEST_SUITE_BEGIN("reweighter");
+
+using anita::readers::Flux;
+
+TEST_CASE("REWEIGHTING") {
+
+    // generate energies from the reference flux between the energy cuts
+    const double minE = 14.;
+    const double maxE = 20.;
+    const Flux reference(anita::readers::REFERENCE_FLUX);
+    const double low = reference.getCDF(minE);
+    const double high = reference.getCDF(maxE);
+
+    SUBCASE("REFERENCE FLUX") {
+        // which is flat in log10 eV
+        CHECK(reference.getDensity(15.) == doctest::Approx(log(10.)));
+        CHECK(reference.getIntegral(minE, maxE) == doctest::Approx(log(10.)*(maxE - minE)));
+        CHECK(reference.getInverseCDF(0.5*(low + high)) == doctest::Approx(0.5*(minE + maxE)));
+    }
+
+    SUBCASE("MATCHES EACH FLUX") {
+        beginEvent(0);
+
+        const std::vector<std::string> models = { "Kotera2010_mix_max", anita::readers::REFERENCE_FLUX };
+        const int N = 100000;
+        anita::Reweighter reweighter(models, N);
+        reweighter.begin(2);
+
+        for (int i = 0; i < N; i++) {
+
+            // a neutrino that interacts once at the energy it was generated with
+            const double energy = reference.getInverseCDF(low + (high - low)*uniform());
+            const anita::ParticleState neutrino{anita::Flavor::Muon, true, energy};
+            anita::InteractionList interactions;
+            interactions.push_back(anita::Interaction(1, neutrino, anita::SphericalCoordinate(), anita::SphericalCoordinate(),
+                                                      anita::Current::Charged, 0));
+            interactions.back().weight = reference.getIntegral(minE, maxE)/reference.getDensity(energy);
+
+            // spread over two workers
+            reweighter.consume(static_cast<unsigned int>(i % 2), i, interactions);
+
+            // and events without interactions don't count
+            anita::InteractionList empty;
+            reweighter.consume(0, i, empty);
+        }
+        reweighter.finish();
+
+        // since every event counts, each rate is the number of neutrinos in that flux between the cuts
+        for (std::size_t i = 0; i < models.size(); i++) {
+            const double expected = Flux(models[i]).getIntegral(minE, maxE);
+            CHECK(reweighter.getModels()[i] == models[i]);
+            CHECK(reweighter.getError(i) > 0);
+            CHECK(fabs(reweighter.getRate(i) - expected) < 5*reweighter.getError(i));
+        }
+
+        // the reference reweights to itself exactly
+        CHECK(reweighter.getRate(1) == doctest::Approx(reference.getIntegral(minE, maxE)));
+    }
+
+    SUBCASE("INVALID") {
+        CHECK_THROWS(anita::Reweighter(std::vector<std::string>{ "reference" }, 0));
+    }
+}
+
+TEST_SUITE_END();
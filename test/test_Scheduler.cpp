@@ -0,0 +1,56 @@
+#include <atomic>
+#include <vector>
+#include <Scheduler.hpp>
+
+#include <doctest.h>
+
+TEST_SUITE_BEGIN("scheduler");
+
+TEST_CASE("Scheduler visits every event exactly once") {
+
+    // the number of events to schedule
+    const int N = 10000;
+
+    SUBCASE("Single thread runs in order") {
+
+        // a single worker should process the events serially
+        const anita::Scheduler scheduler(1);
+        std::vector<int> order;
+        scheduler.run(N, [&order](const unsigned int worker, const int event) { order.push_back(event); });
+
+        // check that we saw every event in order
+        REQUIRE(order.size() == static_cast<unsigned int>(N));
+        for (int i = 0; i < N; i++) {
+            CHECK(order[static_cast<unsigned int>(i)] == i);
+        }
+    }
+
+    SUBCASE("Multiple threads with uneven work") {
+
+        // count how many times we see each event
+        const anita::Scheduler scheduler(4);
+        std::vector<std::atomic<int>> counts(N);
+        for (auto& count : counts) count = 0;
+
+        // make the first quarter of the events much more expensive so that
+        // the other workers have to steal them
+        scheduler.run(N, [&counts](const unsigned int worker, const int event) {
+                volatile double sum = 0;
+                for (int i = 0; i < (event < N/4 ? 2000 : 10); i++) sum += i;
+                counts[static_cast<unsigned int>(event)]++;
+            });
+
+        // and check that every event was run once
+        for (auto& count : counts) {
+            CHECK(count == 1);
+        }
+    }
+
+    SUBCASE("Exceptions are passed to the caller") {
+        const anita::Scheduler scheduler(4);
+        CHECK_THROWS(scheduler.run(N, [](const unsigned int worker, const int event) {
+                    if (event == N/2) throw std::exception(); }));
+    }
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,46 @@
+#include <vector>
+#include <doctest.h>
+#include <Random.hpp>
+#include <SurfaceSampler.hpp>
+
+TEST_SUITE_BEGIN("surfacesampler");
+
+TEST_CASE("ALIAS TABLE") {
+
+    beginEvent(0);
+
+    SUBCASE("Draws are proportional to the weights") {
+
+        // some uneven weights, including an empty entry
+        const std::vector<double> weights = { 1, 2, 0, 7, 0.5, 4.5 };
+        const anita::AliasTable table(weights);
+        CHECK(table.size() == weights.size());
+
+        // count the draws of each entry
+        const int N = 1000000;
+        std::vector<int> counts(weights.size(), 0);
+        for (int i = 0; i < N; i++) {
+            counts[table.sample()]++;
+        }
+
+        // and compare to the normalized weights
+        CHECK(counts[2] == 0);
+        for (std::size_t i = 0; i < weights.size(); i++) {
+            if (weights[i] > 0)
+                CHECK(counts[i]/static_cast<double>(N) == doctest::Approx(weights[i]/15.).epsilon(0.02));
+        }
+    }
+
+    SUBCASE("A single entry is always drawn") {
+        const anita::AliasTable table(std::vector<double>(1, 3.));
+        for (int i = 0; i < 100; i++) {
+            CHECK(table.sample() == 0);
+        }
+    }
+
+    SUBCASE("Empty tables are rejected") {
+        CHECK_THROWS(anita::AliasTable(std::vector<double>()));
+    }
+}
+
+TEST_SUITE_END();
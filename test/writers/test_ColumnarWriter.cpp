@@ -0,0 +1,131 @@
+#include <string>
+#include <cstdio>
+#include <vector>
+#include <doctest.h>
+#include <Random.hpp>
+#include <Version.hpp>
+#include <Scheduler.hpp>
+#include <readers/ColumnarReader.hpp>
+#include <writers/ColumnarWriter.hpp>
+
+TEST_SUITE_BEGIN("columnarwriter");
+
+using anita::readers::ColumnarReader;
+using anita::writers::ColumnarWriter;
+using anita::writers::ColumnarOptions;
+
+// write N events, where event i interacts (i % 3) times, from `nthreads` threads
+static void writeEvents(const std::string filename, const ColumnarOptions options,
+                        const int N, const unsigned int nthreads) {
+
+    ColumnarWriter writer(filename, options);
+    const anita::Scheduler scheduler(nthreads);
+    writer.begin(scheduler.getNumThreads());
+    scheduler.run(N, [&writer](const unsigned int worker, const int n) {
+        beginEvent(static_cast<std::uint64_t>(n));
+        anita::InteractionList interactions;
+        for (int j = 0; j < n % 3; j++) {
+            const anita::ParticleState particle{anita::Flavor::Electron, j == 0, 15 + 5*uniform()};
+            interactions.push_back(anita::Interaction(j + 1, particle, anita::SphericalCoordinate(0.1, 0.2, 6000 + n),
+                                                      anita::SphericalCoordinate(1, 2, 1), anita::Current::Charged, 0.5));
+            interactions.back().event = n;
+        }
+        writer.consume(worker, n, interactions);
+    });
+    writer.finish();
+}
+
+TEST_CASE("COLUMNAR FILES") {
+
+    const std::string filename = std::string(OUTPUT_DIR) + "/test_ColumnarWriter.numc";
+    const int N = 10000;
+
+    ColumnarOptions options;
+    options.batch_size = 1000;
+    options.queue_size = 2;
+
+    SUBCASE("ROUND TRIP") {
+
+        for (const int level : { 0, 1 }) {
+            options.compression_level = level;
+            writeEvents(filename, options, N, 4);
+
+            const ColumnarReader reader(filename);
+            CHECK(reader.getNumEvents() == N);
+            CHECK(reader.getNumRows() == N - 1);
+
+            // every worker writes full row groups and then its remainder, and which worker
+            // gets which events depends on the scheduling, so only the range is fixed
+            CHECK(reader.getNumRowGroups() >= N/options.batch_size);
+            CHECK(reader.getNumRowGroups() <= N/options.batch_size + 4);
+            CHECK(reader.getColumns().size() == anita::columnar::NCOLUMNS);
+            CHECK(reader.getColumns().front() == "event");
+            CHECK(reader.getCommit() == std::string(anita::GIT_COMMIT).substr(0, 16));
+
+            // every row matches the event that it came from
+            std::vector<int> counts(N, 0);
+            std::size_t nrows = 0;
+            for (std::size_t group = 0; group < reader.getNumRowGroups(); group++) {
+                const auto events = reader.getColumn<std::int32_t>("event", group);
+                const auto trials = reader.getColumn<std::int32_t>("trials", group);
+                const auto neutrino = reader.getColumn<std::uint8_t>("neutrino", group);
+                const auto r = reader.getColumn<double>("r", group);
+                const auto energy = reader.getColumn<double>("energy", group);
+                REQUIRE(events.size() == reader.getNumRows(group));
+                for (std::size_t i = 0; i < events.size(); i++) {
+                    counts[static_cast<std::size_t>(events[i])]++;
+                    CHECK(r[i] == 6000 + events[i]);
+                    CHECK(neutrino[i] == (trials[i] == 1));
+                    CHECK(energy[i] >= 15);
+                    CHECK(energy[i] < 20);
+                }
+                nrows += events.size();
+
+                // without compression, only the delta encoded integers have to be decoded
+                CHECK(reader.isMapped("energy", group) == (level == 0));
+                CHECK(reader.isMapped("event", group) == false);
+            }
+            CHECK(nrows == reader.getNumRows());
+            for (int i = 0; i < N; i++)
+                CHECK(counts[static_cast<std::size_t>(i)] == i % 3);
+        }
+    }
+
+    SUBCASE("PLAIN COLUMNS") {
+        options.delta = false;
+        options.compression_level = 0;
+        writeEvents(filename, options, N, 1);
+
+        // with one thread the events are in order, and every column is used in place
+        const ColumnarReader reader(filename);
+        const auto events = reader.getColumn<std::int32_t>("event", 0);
+        CHECK(reader.isMapped("event", 0));
+        CHECK(events[0] == 1);
+        CHECK(events[1] == 2);
+        CHECK(events[2] == 2);
+    }
+
+    SUBCASE("INVALID") {
+        writeEvents(filename, options, 100, 1);
+        const ColumnarReader reader(filename);
+        CHECK_THROWS(reader.getColumn<double>("event", 0));
+        CHECK_THROWS(reader.getColumn<double>("nothing", 0));
+        CHECK_THROWS(reader.getColumn<double>("energy", 1));
+
+        // truncated files are rejected
+        FILE* file = fopen(filename.c_str(), "r+b");
+        REQUIRE(file);
+        CHECK(fseek(file, -1, SEEK_END) == 0);
+        CHECK(fputc('X', file) == 'X');
+        fclose(file);
+        CHECK_THROWS(ColumnarReader{filename});
+        CHECK_THROWS(ColumnarReader(filename + ".missing"));
+
+        options.compression_level = 10;
+        CHECK_THROWS(ColumnarWriter(filename, options));
+    }
+
+    remove(filename.c_str());
+}
+
+TEST_SUITE_END();
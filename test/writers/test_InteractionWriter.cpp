@@ -0,0 +1,86 @@
+#include <string>
+#include <TFile.h>
+#include <TTree.h>
+#include <TNamed.h>
+#include <TParameter.h>
+#include <doctest.h>
+#include <Random.hpp>
+#include <Version.hpp>
+#include <writers/InteractionWriter.hpp>
+
+TEST_SUITE_BEGIN("interactionwriter");
+
+using anita::writers::WriterOptions;
+using anita::writers::InteractionWriter;
+
+TEST_CASE("INTERACTION WRITER") {
+
+    const std::string filename = std::string(OUTPUT_DIR) + "/test_InteractionWriter.root";
+
+    // small batches and a short queue so that workers have to wait on the writer
+    WriterOptions options;
+    options.batch_size = 7;
+    options.queue_size = 2;
+
+    SUBCASE("WRITE EVENTS") {
+        beginEvent(0);
+
+        // every event interacts (event % 3) times
+        const int N = 1000;
+        long ninteractions = 0;
+        {
+            InteractionWriter writer(filename, options);
+            writer.begin(2);
+            for (int i = 0; i < N; i++) {
+                anita::InteractionList interactions;
+                const anita::ParticleState particle{anita::Flavor::Tau, true, 18.};
+                for (int j = 0; j < i % 3; j++) {
+                    interactions.push_back(anita::Interaction(1, particle, anita::SphericalCoordinate(0.1, 0.2, 6000),
+                                                              anita::SphericalCoordinate(1, 2, 1), anita::Current::Neutral,
+                                                              uniform()));
+                    interactions.back().event = i;
+                }
+                ninteractions += i % 3;
+                writer.consume(static_cast<unsigned int>(i % 2), i, interactions);
+            }
+            writer.finish();
+            CHECK(writer.getNumEvents() == N);
+
+            // and a writer can only be used once
+            CHECK_THROWS(writer.begin(1));
+        }
+
+        // read the file back in
+        TFile file(filename.c_str());
+        REQUIRE(!file.IsZombie());
+        TTree* tree = file.Get<TTree>("interactions");
+        REQUIRE(tree);
+        CHECK(tree->GetEntries() == ninteractions);
+
+        // every interaction is in the event that it was consumed with
+        int event = -1;
+        unsigned char current = 0;
+        double energy = 0;
+        tree->SetBranchAddress("event", &event);
+        tree->SetBranchAddress("current", &current);
+        tree->SetBranchAddress("energy", &energy);
+        for (Long64_t i = 0; i < tree->GetEntries(); i++) {
+            tree->GetEntry(i);
+            CHECK(event % 3 != 0);
+            CHECK(current == static_cast<unsigned char>(anita::Current::Neutral));
+            CHECK(energy == 18.);
+        }
+
+        // and the metadata records every event and the code that produced it
+        CHECK(file.Get<TParameter<long>>("nevents")->GetVal() == N);
+        CHECK(std::string(file.Get<TNamed>("hash")->GetTitle()) == std::string(anita::SOURCE_HASH));
+        CHECK(std::string(file.Get<TNamed>("commit")->GetTitle()) == std::string(anita::GIT_COMMIT));
+    }
+
+    SUBCASE("INVALID OPTIONS") {
+        options.batch_size = 0;
+        CHECK_THROWS(InteractionWriter(filename, options));
+    }
+}
+
+TEST_SUITE_END();